@@ -0,0 +1,141 @@
+// atmosphere.glsl
+
+const float PI = 3.14159265;
+
+// Mirrors Atmosphere::Parameters, lengths in km, z up
+struct AtmosphereParameters {
+    vec3 rayleighScattering;
+    float groundRadius;
+    vec3 mieScattering;
+    float topRadius;
+    vec3 mieExtinction;
+    float rayleighScaleHeight;
+    vec3 ozoneAbsorption;
+    float mieScaleHeight;
+    vec3 sunDirection;          // Towards the sun
+    float miePhaseG;
+    vec3 sunIlluminance;
+    float viewRadius;           // Viewer's distance from the planet's centre
+    vec3 sunTransmittance;      // From the viewer to the sun
+    float exposure;
+    vec3 fogExtinction;         // Per km at the viewer
+    float kmPerUnit;
+};
+
+float rayleighDensity(AtmosphereParameters atmosphere, float altitude) {
+    return exp(-altitude / atmosphere.rayleighScaleHeight);
+}
+
+float mieDensity(AtmosphereParameters atmosphere, float altitude) {
+    return exp(-altitude / atmosphere.mieScaleHeight);
+}
+
+// Ozone sits in a layer around 25 km
+float ozoneDensity(float altitude) {
+    return max(0.0, 1.0 - abs(altitude - 25.0) / 15.0);
+}
+
+vec3 atmosphereExtinction(AtmosphereParameters atmosphere, float altitude) {
+    return atmosphere.rayleighScattering * rayleighDensity(atmosphere, altitude) +
+           atmosphere.mieExtinction * mieDensity(atmosphere, altitude) +
+           atmosphere.ozoneAbsorption * ozoneDensity(altitude);
+}
+
+// Distance to the nearest point ahead on a sphere around the planet's centre, negative if there is none
+float raySphere(vec3 origin, vec3 direction, float radius) {
+    float b = dot(origin, direction);
+    float c = dot(origin, origin) - radius * radius;
+    float discriminant = b * b - c;
+    if (discriminant < 0.0) return -1.0;
+
+    float root = sqrt(discriminant);
+    return -b - root > 0.0 ? -b - root : -b + root;
+}
+
+// Transmittance lut: u is the distance to the top of the atmosphere, v the altitude.
+// Only rays above the horizon are stored, the rest hit the ground.
+vec2 transmittanceUV(AtmosphereParameters atmosphere, float radius, float zenithCos) {
+    float Rg = atmosphere.groundRadius;
+    float Rt = atmosphere.topRadius;
+
+    float H = sqrt(Rt * Rt - Rg * Rg);
+    float rho = sqrt(max(radius * radius - Rg * Rg, 0.0));
+
+    float discriminant = radius * radius * (zenithCos * zenithCos - 1.0) + Rt * Rt;
+    float d = max(0.0, -radius * zenithCos + sqrt(max(discriminant, 0.0)));
+    float dMin = Rt - radius;
+    float dMax = rho + H;
+
+    return vec2((d - dMin) / (dMax - dMin), rho / H);
+}
+
+void transmittanceFromUV(AtmosphereParameters atmosphere, vec2 uv, out float radius, out float zenithCos) {
+    float Rg = atmosphere.groundRadius;
+    float Rt = atmosphere.topRadius;
+
+    float H = sqrt(Rt * Rt - Rg * Rg);
+    float rho = H * uv.y;
+    radius = sqrt(rho * rho + Rg * Rg);
+
+    float dMin = Rt - radius;
+    float dMax = rho + H;
+    float d = dMin + uv.x * (dMax - dMin);
+
+    zenithCos = d == 0.0 ? 1.0 : (H * H - rho * rho - d * d) / (2.0 * radius * d);
+    zenithCos = clamp(zenithCos, -1.0, 1.0);
+}
+
+// Sky view lut: u is the azimuth from the sun, v the zenith angle, packed densest at the horizon
+float horizonAngle(AtmosphereParameters atmosphere) {
+    float r = atmosphere.viewRadius;
+    float Rg = atmosphere.groundRadius;
+    return acos(clamp(sqrt(max(r * r - Rg * Rg, 0.0)) / r, -1.0, 1.0));
+}
+
+vec2 skyViewUV(AtmosphereParameters atmosphere, vec3 direction) {
+    float azimuth = atan(direction.y, direction.x) - atan(atmosphere.sunDirection.y, atmosphere.sunDirection.x);
+
+    float beta = horizonAngle(atmosphere);
+    float zenithHorizonAngle = PI - beta;
+    float viewZenithAngle = acos(clamp(direction.z, -1.0, 1.0));
+
+    float v = viewZenithAngle < zenithHorizonAngle
+        ? 0.5 * (1.0 - sqrt(1.0 - viewZenithAngle / zenithHorizonAngle))
+        : 0.5 + 0.5 * sqrt((viewZenithAngle - zenithHorizonAngle) / beta);
+
+    return vec2(fract(azimuth / (2.0 * PI)), v);
+}
+
+// In a frame where the sun has azimuth 0
+vec3 skyViewDirection(AtmosphereParameters atmosphere, vec2 uv) {
+    float beta = horizonAngle(atmosphere);
+    float zenithHorizonAngle = PI - beta;
+
+    float viewZenithAngle;
+    if (uv.y < 0.5) {
+        float coord = 1.0 - 2.0 * uv.y;
+        viewZenithAngle = zenithHorizonAngle * (1.0 - coord * coord);
+    } else {
+        float coord = 2.0 * uv.y - 1.0;
+        viewZenithAngle = zenithHorizonAngle + beta * coord * coord;
+    }
+
+    float azimuth = uv.x * 2.0 * PI;
+    return vec3(sin(viewZenithAngle) * cos(azimuth), sin(viewZenithAngle) * sin(azimuth), cos(viewZenithAngle));
+}
+
+float rayleighPhase(float cosTheta) {
+    return 3.0 / (16.0 * PI) * (1.0 + cosTheta * cosTheta);
+}
+
+// Cornette-Shanks
+float miePhase(float cosTheta, float g) {
+    float g2 = g * g;
+    float denominator = (2.0 + g2) * pow(1.0 + g2 - 2.0 * g * cosTheta, 1.5);
+    return 3.0 / (8.0 * PI) * (1.0 - g2) * (1.0 + cosTheta * cosTheta) / denominator;
+}
+
+// Same curve the Preetham sky was displayed with
+vec3 atmosphereDisplay(AtmosphereParameters atmosphere, vec3 luminance) {
+    return clamp(pow(luminance * atmosphere.exposure, vec3(1.0 / 2.2)), 0.0, 1.0);
+}
@@ -1,4 +1,5 @@
 #version 450
+#extension GL_EXT_buffer_reference : require
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
@@ -16,16 +17,20 @@ layout(set = 0, binding = 0) uniform GlobalUBO {
     float time;
 };
 
-// Descriptor Set 2: Object-specific data
-layout(set = 2, binding = 0) uniform ObjectUBO {
+// Push Constants: Object-specific data
+layout(buffer_reference, std430) readonly buffer ObjectData {
     mat4 model;
     vec4 colorTint;
 };
 
+layout(push_constant) uniform PushConstants {
+    ObjectData object;
+} pc;
+
 void main() {
-    vec4 worldPos = model * vec4(inPosition, 1.0);
+    vec4 worldPos = pc.object.model * vec4(inPosition, 1.0);
     fragPos = worldPos.xyz;
-    fragNormal = mat3(model) * inNormal;
+    fragNormal = mat3(pc.object.model) * inNormal;
     fragUV = inUV;
 
     gl_Position = proj * view * worldPos;
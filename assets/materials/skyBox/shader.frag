@@ -1,11 +1,28 @@
 #version 450
 
-layout(set = 0, binding = 0) uniform samplerCube u_Skybox;
+#include "../atmosphereTransmittance/atmosphere.glsl"
+
+layout(set = 0, binding = 3) uniform sampler2D u_SkyView;
+
+layout(set = 0, binding = 2) uniform AtmosphereUBO {
+    AtmosphereParameters atmosphere;
+};
 
 layout(location = 0) in vec3 v_Direction;
 layout(location = 0) out vec4 outColor;
 
+const float SUN_ANGULAR_RADIUS = radians(0.265);
+
 void main() {
-    outColor = texture(u_Skybox, normalize(v_Direction));
-}
+    vec3 direction = normalize(v_Direction);
+    vec3 luminance = texture(u_SkyView, skyViewUV(atmosphere, direction)).rgb;
+
+    // Sun disk, hidden below the horizon
+    vec3 origin = vec3(0.0, 0.0, atmosphere.viewRadius);
+    if (dot(direction, atmosphere.sunDirection) > cos(SUN_ANGULAR_RADIUS) &&
+            raySphere(origin, direction, atmosphere.groundRadius) < 0.0) {
+        luminance += atmosphere.sunIlluminance * atmosphere.sunTransmittance;
+    }
 
+    outColor = vec4(atmosphereDisplay(atmosphere, luminance), 1.0);
+}
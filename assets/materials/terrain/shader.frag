@@ -1,8 +1,12 @@
 #version 450
 
+#include "virtualTexture.glsl"
+#include "../atmosphereTransmittance/atmosphere.glsl"
+
 layout(location = 0) in vec3 fragPos;
 layout(location = 1) in vec3 fragNormal;
 layout(location = 2) in vec2 fragUV;
+layout(location = 3) in float fragLod;
 
 layout(location = 0) out vec4 outColor;
 
@@ -21,7 +25,25 @@ layout(set = 0, binding = 1) uniform LightUBO {
     float intensity;
 };
 
+layout(set = 0, binding = 2) uniform AtmosphereUBO {
+    AtmosphereParameters atmosphere;
+};
+
+layout(set = 0, binding = 3) uniform sampler2D skyViewLut;
+
+layout(push_constant) uniform PushConstants {
+    vec2 nodeOffset;
+    float nodeSize;
+    float gridSize;
+    vec2 morphRange;
+    VirtualTextureInfo vtInfo;
+    VirtualTextureFeedback vtFeedback;
+} pc;
+
 void main() {
+    // Only visible surface requests heightmap tiles
+    vtRequest(pc.vtInfo, pc.vtFeedback, fragUV, fragLod);
+
     const float stoneCoefficient = 0.55; // Lower = more grass?
 
     vec3 normal = normalize(fragNormal);
@@ -56,6 +78,13 @@ void main() {
     // Apply lighting
     vec3 finalColor = surfaceColor * lightColor;
 
+    // Aerial perspective, fading towards the sky at the horizon behind the fragment
+    vec3 toFragment = fragPos - cameraPosition;
+    vec3 fogTransmittance = exp(-atmosphere.fogExtinction * length(toFragment) * atmosphere.kmPerUnit);
+    vec3 horizonDirection = normalize(vec3(toFragment.xy, max(toFragment.z, 0.0)) + vec3(0.0, 0.0, 1e-4));
+    vec3 fogColor = atmosphereDisplay(atmosphere, texture(skyViewLut, skyViewUV(atmosphere, horizonDirection)).rgb);
+    finalColor = mix(fogColor, finalColor, fogTransmittance);
+
     outColor = vec4(finalColor, 1.0);
 
     // Visualize normals (in 0-1 range)
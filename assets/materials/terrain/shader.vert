@@ -1,12 +1,11 @@
 #version 450
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inNormal;
-layout(location = 2) in vec2 inUV;
+#include "virtualTexture.glsl"
 
 layout(location = 0) out vec3 fragPos;
 layout(location = 1) out vec3 fragNormal;
 layout(location = 2) out vec2 fragUV;
+layout(location = 3) out float fragLod;
 
 // Descriptor Set 0: Global Frame Data
 layout(set = 0, binding = 0) uniform GlobalUBO {
@@ -23,10 +22,17 @@ layout(set = 1, binding = 0) uniform TerrainUBO {
     float texelSize;
 };
 
-// Descriptor Set 2 / Push Constants: Chunk Data
-layout(set = 2, binding = 0) uniform sampler2D normalHeightMap;
+// Descriptor Set 2: World Heightmap (virtual texture)
+layout(set = 2, binding = 0) uniform sampler2D heightMap;
+
+// Push Constants: Quadtree Node
 layout(push_constant) uniform PushConstants {
-    vec2 chunkOffset;
+    vec2 nodeOffset;        // Minimum corner, in chunks
+    float nodeSize;         // In chunks
+    float gridSize;         // Quads per side
+    vec2 morphRange;        // Camera distance over which the node morphs into its parent
+    VirtualTextureInfo vtInfo;
+    VirtualTextureFeedback vtFeedback;
 } pc;
 
 mat4 scale(mat4 m, vec3 s) {
@@ -39,34 +45,61 @@ mat4 scale(mat4 m, vec3 s) {
     return m * scaleMatrix;
 }
 
+// fbm height, stored scaled down by HEIGHT_RANGE in an r16 unorm heightmap (see terrainGenerator/shader.comp)
+const float HEIGHT_RANGE = 2.0;
+
+float sampleHeight(vec2 uv, float fineLod, float coarseLod, float morph) {
+    return HEIGHT_RANGE * mix(
+        textureLod(heightMap, uv, fineLod).r,
+        textureLod(heightMap, uv, coarseLod).r,
+        morph
+    );
+}
+
 void main() {
-    // Sample normal and height from texture
-    vec4 packed = texture(normalHeightMap, inUV);
-    vec3 bakedNormal = normalize(packed.rgb * 2.0 - 1.0); // unpack normal
-    float height = packed.a;
+    float spacing = pc.nodeSize / pc.gridSize;      // Chunks per quad
+    float nodeLod = log2(spacing / texelSize);      // Mip with one texel per quad
+
+    // No vertex buffer, index i is vertex (i % (gridSize + 1), i / (gridSize + 1))
+    uint pitch = uint(pc.gridSize) + 1u;
+    vec2 gridPosition = vec2(uint(gl_VertexIndex) % pitch, uint(gl_VertexIndex) / pitch);
+    vec2 chunkPosition = pc.nodeOffset + gridPosition * spacing;
+
+    // Slide odd vertices onto their even neighbours, matching the parent's grid by the end of the range
+    float cameraDistance = distance(vec3(chunkPosition * terrainScale, 0.0), cameraPosition);
+    float morph = clamp((cameraDistance - pc.morphRange.x) / (pc.morphRange.y - pc.morphRange.x), 0.0, 1.0);
+    chunkPosition -= fract(gridPosition * 0.5) * 2.0 * spacing * morph;
 
-    // Displace vertex position along input normal (or bakedNormal if preferred)
+    // The heightmap wraps around the camera, one texel per vertex at mip 0.
+    // Left unwrapped so edge vertices stay continuous, the sampler repeats.
+    float worldChunks = float(pc.vtInfo.size) * texelSize;
+    vec2 worldUV = (chunkPosition + 0.5 + texelSize * 0.5) / worldChunks;   // texel centres
+
+    // Blend towards the parent's mip along with the morph so levels meet without cracks
+    float fineLod = vtResidentLod(pc.vtInfo, worldUV, nodeLod);
+    float coarseLod = vtResidentLod(pc.vtInfo, worldUV, nodeLod + 1.0);
+    float height = sampleHeight(worldUV, fineLod, coarseLod, morph);
+
+    // Normal from the neighbouring quads' heights, the heightmap only stores height
     float verticalScale = heightScale * terrainScale;
+    vec2 step = vec2(spacing / worldChunks, 0.0);
+    float slopeX = sampleHeight(worldUV + step.xy, fineLod, coarseLod, morph) - sampleHeight(worldUV - step.xy, fineLod, coarseLod, morph);
+    float slopeY = sampleHeight(worldUV + step.yx, fineLod, coarseLod, morph) - sampleHeight(worldUV - step.yx, fineLod, coarseLod, morph);
+    vec2 gradient = vec2(slopeX, slopeY) * verticalScale / (2.0 * spacing * terrainScale);
+
+    // Displace the flat grid straight up
     float offset = verticalScale * (height - 0.5f);
 
-    vec2 adjustedOffset = pc.chunkOffset * (1.0f - texelSize);
-    vec3 displacedPosition = (inPosition + vec3(adjustedOffset, 0.0f)) + inNormal * offset;
+    vec3 displacedPosition = vec3(chunkPosition, offset);
 
     mat4 model = scale(mat4(1.0), vec3(terrainScale, terrainScale, 1.0));
 
     // Output
     vec4 worldPos = model * vec4(displacedPosition, 1.0);
     fragPos = worldPos.xyz;
-    fragUV = inUV;
-
-    mat3 normalMatrix = mat3(
-        1.0 / terrainScale, 0.0, 0.0,
-        0.0, 1.0 / terrainScale, 0.0,
-        0.0, 0.0, 1.0 / verticalScale
-    );
-
-    // Transform baked normal by normalMatrix and normalize
-    fragNormal = normalize(normalMatrix * bakedNormal);
+    fragUV = worldUV;
+    fragLod = nodeLod + morph;
+    fragNormal = normalize(vec3(-gradient, 1.0));
 
     gl_Position = proj * view * worldPos;
 }
@@ -0,0 +1,49 @@
+// virtualTexture.glsl
+
+#extension GL_EXT_buffer_reference : require
+
+// Mirrors VirtualTexture::InfoHeader, one per frame in flight
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer VirtualTextureInfo {
+    uint size;
+    uint tileWidth;
+    uint tileHeight;
+    uint mipTailFirstLod;
+    uint mipLevels;
+    uint tilesX;
+    uint tilesY;
+    uint _pad0;
+    uint feedbackOffsets[16];
+    uint minResidentMip[];     // Per mip 0 tile
+};
+
+layout(buffer_reference, std430, buffer_reference_align = 16) buffer VirtualTextureFeedback {
+    uint requested[];
+};
+
+// The texture wraps, so uv may lie outside 0..1
+uvec2 vtTile(VirtualTextureInfo info, vec2 uv, uint mip) {
+    uvec2 mipSize = max(uvec2(info.size >> mip), uvec2(1));
+    uvec2 texel = min(uvec2(fract(uv) * vec2(mipSize)), mipSize - 1);
+    return texel / uvec2(info.tileWidth, info.tileHeight);
+}
+
+// Clamp a lod to what is resident at uv, the mip tail is always there
+float vtResidentLod(VirtualTextureInfo info, vec2 uv, float lod) {
+    uvec2 tile = vtTile(info, uv, 0);
+    return max(lod, float(info.minResidentMip[tile.y * info.tilesX + tile.x]));
+}
+
+// Ask the page manager to stream in the tile covering uv at lod
+void vtRequest(VirtualTextureInfo info, VirtualTextureFeedback feedback, vec2 uv, float lod) {
+    uint mip = min(uint(max(lod, 0.0)), info.mipLevels - 1);
+    if (mip >= info.mipTailFirstLod) return;
+
+    uvec2 tile = vtTile(info, uv, mip);
+    uint tilesX = ((info.size >> mip) + info.tileWidth - 1) / info.tileWidth;
+    uint index = info.feedbackOffsets[mip] + tile.y * tilesX + tile.x;
+
+    // Skip the store when already flagged to keep the write traffic down
+    if (feedback.requested[index] == 0) {
+        feedback.requested[index] = 1;
+    }
+}
@@ -11,15 +11,30 @@ float grad(int hash, vec2 p) {
     }
 }
 
-// Hash function with seed
-float hash2D(vec2 p, float seed) {
-    return fract(sin(dot(p + seed, vec2(127.1, 311.7))) * 43758.5453123);
+// PCG hash, integer only so TerrainNoise.cpp reproduces it exactly
+uint pcgHash(uint v) {
+    uint state = v * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
 }
 
-// Generate a random gradient vector from grid point p + seed
+// Hash of lattice point p with seed
+uint hash2D(vec2 p, float seed) {
+    uvec2 cell = uvec2(ivec2(p));
+    return pcgHash(cell.x ^ pcgHash(cell.y ^ pcgHash(floatBitsToUint(seed))));
+}
+
+// Unit vectors every 22.5 degrees, the same literals as GRADIENT_X/Y in TerrainNoise.cpp
+const vec2 GRADIENTS[16] = vec2[](
+    vec2( 1.0,         0.0        ), vec2( 0.92387953,  0.38268343), vec2( 0.70710677,  0.70710677), vec2( 0.38268343,  0.92387953),
+    vec2( 0.0,         1.0        ), vec2(-0.38268343,  0.92387953), vec2(-0.70710677,  0.70710677), vec2(-0.92387953,  0.38268343),
+    vec2(-1.0,         0.0        ), vec2(-0.92387953, -0.38268343), vec2(-0.70710677, -0.70710677), vec2(-0.38268343, -0.92387953),
+    vec2( 0.0,        -1.0        ), vec2( 0.38268343, -0.92387953), vec2( 0.70710677, -0.70710677), vec2( 0.92387953, -0.38268343)
+);
+
+// Random gradient for grid point p + seed, the top 4 hash bits pick it
 vec2 randomGradient(vec2 p, float seed) {
-    float angle = hash2D(p, seed) * 6.2831853; // 2π
-    return vec2(cos(angle), sin(angle));
+    return GRADIENTS[hash2D(p, seed) >> 28u];
 }
 
 // Smoothstep / fade function for interpolation
@@ -1,4 +1,5 @@
 #version 450
+#extension GL_EXT_buffer_reference : require
 
 layout(location = 0) in vec3 fragPos;
 layout(location = 1) in vec3 fragNormal;
@@ -26,12 +27,16 @@ layout(set = 1, binding = 0) uniform sampler2D albedoMap;
 layout(set = 1, binding = 1) uniform sampler2D normalMap;
 layout(set = 1, binding = 2) uniform sampler2D metallicRoughnessMap;
 
-// Object
-layout(set = 2, binding = 0) uniform ObjectUBO {
+// Object (device address)
+layout(buffer_reference, std430) readonly buffer ObjectData {
     mat4 model;
     vec4 colorTint;
 };
 
+layout(push_constant) uniform PushConstants {
+    ObjectData object;
+} pc;
+
 // Converts normal from [0,1] → [-1,1]
 vec3 decodeNormal(vec3 n) {
     return normalize(n * 2.0 - 1.0);
@@ -67,7 +72,7 @@ void main() {
     color += directionalLightColor * (diff + specularStrength * spec);
 
     // Final color tinting
-    color *= albedo * colorTint.rgb;
+    color *= albedo * pc.object.colorTint.rgb;
     outColor = vec4(color, 1.0);
 }
 
@@ -2,7 +2,17 @@
 
 #include "CubeGenerator.hpp"
 #include "spdlog/spdlog.h"
-#include <cstring>
+
+ProvidedVertexLayout cubeVertexLayout() {
+    return {
+        .semantics = {"POSITION", "NORMAL", "TEXCOORD"},
+        .formats = {
+            {"POSITION", VK_FORMAT_R32G32B32_SFLOAT},
+            {"NORMAL",   VK_FORMAT_R32G32B32_SFLOAT},
+            {"TEXCOORD", VK_FORMAT_R32G32_SFLOAT},
+        }
+    };
+}
 
 void createCube(
     ResourceManager* resourceManager,
@@ -73,31 +83,16 @@ void createCube(
        20,21,22,22,23,20
     };
 
-    output->vertexLayout = {
-        .semantics = {"POSITION", "NORMAL", "TEXCOORD"},
-        .formats = {
-            {"POSITION", VK_FORMAT_R32G32B32_SFLOAT},
-            {"NORMAL",   VK_FORMAT_R32G32B32_SFLOAT},
-            {"TEXCOORD", VK_FORMAT_R32G32_SFLOAT},
-        }
-    };
-
-    Size vertexSize = sizeof(Vertex) * vertices.size();
-    Size indexSize  = sizeof(U32) * indices.size();
-
-    output->vertexBuffer = resourceManager->createVertexBuffer(vertexSize, "Cube Vertex Buffer").value();
-    output->indexBuffer  = resourceManager->createIndexBuffer(indexSize, "Cube Index Buffer").value();
-
-    Buffer vertexStaging = resourceManager->createStagingBuffer(vertexSize, "Cube Vertex Staging Buffer").value();
-    Buffer indexStaging  = resourceManager->createStagingBuffer(indexSize, "Cube Index Stagin Buffer").value();
-
-    std::memcpy(vertexStaging.info.pMappedData, vertices.data(), vertexSize);
-    std::memcpy(indexStaging.info.pMappedData, indices.data(), indexSize);
-    resourceManager->copyToBuffer(vertexStaging, output->vertexBuffer, vertexSize);
-    resourceManager->copyToBuffer(indexStaging, output->indexBuffer, indexSize);
+    output->vertexLayout = cubeVertexLayout();
 
-    vertexStaging.shutdown();
-    indexStaging.shutdown();
+    output->geometryPool = resourceManager->getGeometryPool();
+    output->geometry = output->geometryPool->allocate(
+        vertices.data(),
+        sizeof(Vertex) * vertices.size(),
+        sizeof(Vertex),
+        indices.data(),
+        static_cast<U32>(indices.size())
+    ).value();
 
     output->surfaces = {{
         .indexStart = 0,
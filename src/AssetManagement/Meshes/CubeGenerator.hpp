@@ -6,6 +6,9 @@
 #include "ResourceManagement/RenderResources/DescriptorPool.hpp"
 #include "ResourceManagement/ResourceManager.hpp"
 
+// Layout of the vertices createCube writes, for preloading its materials
+ProvidedVertexLayout cubeVertexLayout();
+
 void createCube(
     ResourceManager* resourceManager,
     std::string materialPath,
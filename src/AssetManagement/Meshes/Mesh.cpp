@@ -9,16 +9,18 @@ void Mesh::destroyMesh() {
 
     materials.clear();  // TODO: Doesn't actually unload materials
 
-    indexBuffer.shutdown();
-    vertexBuffer.shutdown();
+    geometryPool->free(geometry);
 }
 
 std::vector<RenderObject> Mesh::draw() {
+    GeometryRange range = geometryPool->getRange(geometry);
+
     RenderObject obj = {
         .indexCount = 0,
         .startIndex = 0,
-        .indexBuffer = &indexBuffer,
-        .vertexBuffer = &vertexBuffer,
+        .vertexOffset = range.vertexOffset,
+        .indexBuffer = geometryPool->getIndexBuffer(),
+        .vertexBuffer = geometryPool->getVertexBuffer(),
         .material = nullptr,
         .pushConstantData = nullptr,
     };
@@ -27,7 +29,7 @@ std::vector<RenderObject> Mesh::draw() {
     output.reserve(surfaces.size());
 
     for (Size i = 0; i < surfaces.size(); i ++) {
-        obj.startIndex = surfaces[i].indexStart;
+        obj.startIndex = range.firstIndex + surfaces[i].indexStart;
         obj.indexCount = surfaces[i].indexCount;
         obj.material = &materials[surfaces[i].materialIndex];
         obj.pushConstantData = pushConstantData[surfaces[i].materialIndex];
@@ -4,7 +4,7 @@
 
 #include "RenderEngine/RenderObjects/Materials.hpp"
 #include "RenderEngine/RenderObjects/RenderObject.hpp"
-#include "ResourceManagement/RenderResources/Buffer.hpp"
+#include "ResourceManagement/GeometryPool.hpp"
 #include "ResourceManagement/RenderResources/DescriptorPool.hpp"
 #include "ResourceManagement/RenderResources/VertexAttribute.hpp"
 
@@ -21,8 +21,8 @@ struct Surface {
 struct Mesh {
     DescriptorPool* descriptor;
 
-    Buffer indexBuffer;
-    Buffer vertexBuffer;
+    GeometryPool* geometryPool;
+    U32 geometry;
     std::vector<Surface> surfaces;
     ProvidedVertexLayout vertexLayout;
 
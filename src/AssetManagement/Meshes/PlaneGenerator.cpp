@@ -4,10 +4,11 @@
 #include "AssetManagement/Meshes/Mesh.hpp"
 #include "ResourceManagement/RenderResources/VertexAttribute.hpp"
 
+#include <algorithm>
+
 void createPlaneBuffers(
     ResourceManager* resourceManager,
-    Buffer* vertexBuffer,
-    Buffer* indexBuffer,
+    U32* geometry,
     ProvidedVertexLayout* layout,
     U32* numIndices,
     U32 resolution
@@ -23,7 +24,7 @@ void createPlaneBuffers(
     std::vector<Vertex> vertices;
     std::vector<U32> indices;
 
-    float step = 1.0f / resolution; // normalize to unit size (1.0)
+    float step = 1.0f / (resolution - 1); // normalize to unit size (1.0), edges included
 
     for (U32 y = 0; y < resolution; ++y) {
         for (U32 x = 0; x < resolution; ++x) {
@@ -96,23 +97,57 @@ void createPlaneBuffers(
         }
     };
 
-    Size vertexSize = sizeof(Vertex) * vertices.size();
-    Size indexSize  = sizeof(U32) * indices.size();
-
-    *vertexBuffer = resourceManager->createVertexBuffer(vertexSize, "Plane Vertex Buffer").value();
-    *indexBuffer  = resourceManager->createIndexBuffer(indexSize, "Plane Index Buffer").value();
+    *geometry = resourceManager->getGeometryPool()->allocate(
+        vertices.data(),
+        sizeof(Vertex) * vertices.size(),
+        sizeof(Vertex),
+        indices.data(),
+        static_cast<U32>(indices.size())
+    ).value();
 
-    Buffer vertexStaging = resourceManager->createStagingBuffer(vertexSize, "Plane Vertex Staging Buffer").value();
-    Buffer indexStaging  = resourceManager->createStagingBuffer(indexSize, "Plane Index Staging Buffer").value();
+    *numIndices = indices.size();
+}
 
-    std::memcpy(vertexStaging.info.pMappedData, vertices.data(), vertexSize);
-    std::memcpy(indexStaging.info.pMappedData, indices.data(), indexSize);
+void createGridIndices(
+    ResourceManager* resourceManager,
+    U32* geometry,
+    U32* numIndices,
+    U32 gridSize
+) {
+    // Columns of quads walked row by row, so the row above is still in the post transform cache
+    constexpr U32 BLOCK_WIDTH = 16;
 
-    resourceManager->copyToBuffer(vertexStaging, *vertexBuffer, vertexSize);
-    resourceManager->copyToBuffer(indexStaging, *indexBuffer, indexSize);
+    U32 pitch = gridSize + 1;
+    std::vector<U32> indices;
+    indices.reserve(gridSize * gridSize * 6);
+
+    for (U32 blockX = 0; blockX < gridSize; blockX += BLOCK_WIDTH) {
+        U32 blockEnd = std::min(blockX + BLOCK_WIDTH, gridSize);
+
+        for (U32 y = 0; y < gridSize; ++y) {
+            for (U32 x = blockX; x < blockEnd; ++x) {
+                U32 topLeft     = y * pitch + x;
+                U32 topRight    = topLeft + 1;
+                U32 bottomLeft  = (y + 1) * pitch + x;
+                U32 bottomRight = bottomLeft + 1;
+
+                // Same winding as createPlaneBuffers
+                indices.push_back(topLeft);
+                indices.push_back(topRight);
+                indices.push_back(bottomLeft);
+
+                indices.push_back(topRight);
+                indices.push_back(bottomRight);
+                indices.push_back(bottomLeft);
+            }
+        }
+    }
 
-    vertexStaging.shutdown();
-    indexStaging.shutdown();
+    *geometry = resourceManager->getGeometryPool()->allocate(
+        nullptr, 0, 0,
+        indices.data(),
+        static_cast<U32>(indices.size())
+    ).value();
 
     *numIndices = indices.size();
 }
@@ -129,10 +164,10 @@ void createPlane(
     (void)output->vertexLayout;
 
     U32 numIndices = 0;
+    output->geometryPool = resourceManager->getGeometryPool();
     createPlaneBuffers(
         resourceManager,
-        &output->vertexBuffer,
-        &output->indexBuffer,
+        &output->geometry,
         &output->vertexLayout,
         &numIndices,
         resolution
@@ -9,13 +9,20 @@
 
 void createPlaneBuffers(
     ResourceManager* resourceManager,
-    Buffer* vertexBuffer,
-    Buffer* indexBuffer,
+    U32* geometry,
     ProvidedVertexLayout* layout,
     U32* numIndices,
     U32 resolution
 );
 
+// Index only grid of gridSize quads per side, vertex i sits at (i % (gridSize + 1), i / (gridSize + 1))
+void createGridIndices(
+    ResourceManager* resourceManager,
+    U32* geometry,
+    U32* numIndices,
+    U32 gridSize
+);
+
 void createPlane(
     ResourceManager* resourceManager,
     assets::Mesh* output,
@@ -0,0 +1,272 @@
+// src/AssetManagement/Terrain/TerrainNoise.cpp
+
+#include "TerrainNoise.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TERRAIN_NOISE_X86 1
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+#endif
+
+namespace {
+    // Constants from noiseFunctions.glsl
+    constexpr U32 PCG_MULTIPLIER = 747796405u;
+    constexpr U32 PCG_INCREMENT = 2891336453u;
+    constexpr U32 PCG_WORD = 277803737u;
+    constexpr U32 GRADIENT_SHIFT = 28;      // Top 4 hash bits pick one of 16 gradients
+    constexpr F32 OCTAVE_SEED_STEP = 237.0f;
+    constexpr F32 PERSISTENCE = 0.5f;
+
+    // Unit vectors every 22.5 degrees, the same literals as GRADIENTS in noiseFunctions.glsl
+    constexpr F32 GRADIENT_X[16] = {
+        1.0f, 0.92387953f, 0.70710677f, 0.38268343f, 0.0f, -0.38268343f, -0.70710677f, -0.92387953f,
+        -1.0f, -0.92387953f, -0.70710677f, -0.38268343f, 0.0f, 0.38268343f, 0.70710677f, 0.92387953f,
+    };
+    constexpr F32 GRADIENT_Y[16] = {
+        0.0f, 0.38268343f, 0.70710677f, 0.92387953f, 1.0f, 0.92387953f, 0.70710677f, 0.38268343f,
+        0.0f, -0.38268343f, -0.70710677f, -0.92387953f, -1.0f, -0.92387953f, -0.70710677f, -0.38268343f,
+    };
+
+    constexpr U32 LANES = 8;
+    constexpr U32 MIN_ROWS_PER_THREAD = 16;
+
+    U32 pcgHash(U32 v) {
+        U32 state = v * PCG_MULTIPLIER + PCG_INCREMENT;
+        U32 word = ((state >> ((state >> 28u) + 4u)) ^ state) * PCG_WORD;
+        return (word >> 22u) ^ word;
+    }
+
+    // GLSL mix
+    F32 mix(F32 a, F32 b, F32 t) {
+        return std::fma(b, t, a * (1.0f - t));
+    }
+
+    F32 fade(F32 t) {
+        return t * t * t * std::fma(t, std::fma(t, 6.0f, -15.0f), 10.0f);
+    }
+
+    // randomGradient dotted with the offset from its corner, rowHash is the corner row's hash with the seed
+    F32 cornerValue(I32 cornerX, U32 rowHash, F32 dx, F32 dy) {
+        U32 index = pcgHash(static_cast<U32>(cornerX) ^ rowHash) >> GRADIENT_SHIFT;
+        return std::fma(GRADIENT_X[index], dx, GRADIENT_Y[index] * dy);
+    }
+
+#ifdef TERRAIN_NOISE_X86
+    AVX2_TARGET inline __m256 splat(F32 value) {
+        return _mm256_set1_ps(value);
+    }
+
+    AVX2_TARGET inline __m256 floor8(__m256 x) {
+        return _mm256_round_ps(x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    }
+
+    AVX2_TARGET inline __m256i pcgHash8(__m256i v) {
+        __m256i state = _mm256_add_epi32(
+                _mm256_mullo_epi32(v, _mm256_set1_epi32(static_cast<I32>(PCG_MULTIPLIER))),
+                _mm256_set1_epi32(static_cast<I32>(PCG_INCREMENT)));
+        __m256i shift = _mm256_add_epi32(_mm256_srli_epi32(state, 28), _mm256_set1_epi32(4));
+        __m256i word = _mm256_mullo_epi32(
+                _mm256_xor_si256(_mm256_srlv_epi32(state, shift), state),
+                _mm256_set1_epi32(static_cast<I32>(PCG_WORD)));
+        return _mm256_xor_si256(_mm256_srli_epi32(word, 22), word);
+    }
+
+    AVX2_TARGET inline __m256 mix8(__m256 a, __m256 b, __m256 t) {
+        return _mm256_fmadd_ps(b, t, _mm256_mul_ps(a, _mm256_sub_ps(splat(1.0f), t)));
+    }
+
+    AVX2_TARGET inline __m256 fade8(__m256 t) {
+        __m256 inner = _mm256_fmadd_ps(t, _mm256_fmsub_ps(t, splat(6.0f), splat(15.0f)), splat(10.0f));
+        return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), inner);
+    }
+
+    // Both halves of the table in registers, permutes pick by the low 3 bits and bit 3 picks the half
+    struct Gradients8 {
+        __m256 xLow, xHigh, yLow, yHigh;
+    };
+
+    AVX2_TARGET inline Gradients8 loadGradients8() {
+        return {
+            _mm256_loadu_ps(GRADIENT_X), _mm256_loadu_ps(GRADIENT_X + LANES),
+            _mm256_loadu_ps(GRADIENT_Y), _mm256_loadu_ps(GRADIENT_Y + LANES),
+        };
+    }
+
+    AVX2_TARGET inline __m256 cornerValue8(
+            __m256i cornerX, __m256i rowHash, __m256 dx, __m256 dy, const Gradients8& gradients) {
+        __m256i index = _mm256_srli_epi32(pcgHash8(_mm256_xor_si256(cornerX, rowHash)), GRADIENT_SHIFT);
+        __m256 high = _mm256_castsi256_ps(_mm256_slli_epi32(index, 28));
+
+        __m256 gx = _mm256_blendv_ps(
+                _mm256_permutevar8x32_ps(gradients.xLow, index), _mm256_permutevar8x32_ps(gradients.xHigh, index), high);
+        __m256 gy = _mm256_blendv_ps(
+                _mm256_permutevar8x32_ps(gradients.yLow, index), _mm256_permutevar8x32_ps(gradients.yHigh, index), high);
+
+        return _mm256_fmadd_ps(gx, dx, _mm256_mul_ps(gy, dy));
+    }
+
+    AVX2_TARGET inline __m256 perlin8(__m256 x, __m256 y, __m256i seed, const Gradients8& gradients) {
+        __m256 cellX = floor8(x);
+        __m256 cellY = floor8(y);
+        __m256 fx = _mm256_sub_ps(x, cellX);
+        __m256 fy = _mm256_sub_ps(y, cellY);
+        __m256 one = splat(1.0f);
+
+        // Corners on the same row share the inner hash
+        __m256i x0 = _mm256_cvttps_epi32(cellX);
+        __m256i y0 = _mm256_cvttps_epi32(cellY);
+        __m256i x1 = _mm256_add_epi32(x0, _mm256_set1_epi32(1));
+        __m256i y1 = _mm256_add_epi32(y0, _mm256_set1_epi32(1));
+        __m256i row0 = pcgHash8(_mm256_xor_si256(y0, seed));
+        __m256i row1 = pcgHash8(_mm256_xor_si256(y1, seed));
+
+        __m256 fx1 = _mm256_sub_ps(fx, one);
+        __m256 fy1 = _mm256_sub_ps(fy, one);
+        __m256 v00 = cornerValue8(x0, row0, fx, fy, gradients);
+        __m256 v10 = cornerValue8(x1, row0, fx1, fy, gradients);
+        __m256 v01 = cornerValue8(x0, row1, fx, fy1, gradients);
+        __m256 v11 = cornerValue8(x1, row1, fx1, fy1, gradients);
+
+        __m256 tx = fade8(fx);
+        __m256 i1 = mix8(v00, v10, tx);
+        __m256 i2 = mix8(v01, v11, tx);
+
+        return _mm256_fmadd_ps(splat(0.5f), mix8(i1, i2, fade8(fy)), splat(0.5f));
+    }
+
+    AVX2_TARGET void heightBatchAvx2(const F32* cellX, const F32* cellY, F32* out, Size count, const TerrainNoise::Settings& settings) {
+        Gradients8 gradients = loadGradients8();
+
+        Size i = 0;
+        for (; i + LANES <= count; i += LANES) {
+            __m256 x = _mm256_mul_ps(_mm256_loadu_ps(cellX + i), splat(settings.scale));
+            __m256 y = _mm256_mul_ps(_mm256_loadu_ps(cellY + i), splat(settings.scale));
+
+            __m256 total = _mm256_setzero_ps();
+            F32 amplitude = 1.0f;
+            F32 frequency = 1.0f;
+            for (I32 octave = 0; octave < settings.octaves; octave++) {
+                __m256 value = perlin8(
+                        _mm256_mul_ps(x, splat(frequency)),
+                        _mm256_mul_ps(y, splat(frequency)),
+                        _mm256_set1_epi32(static_cast<I32>(pcgHash(std::bit_cast<U32>(
+                                settings.seed + static_cast<F32>(octave) * OCTAVE_SEED_STEP)))),
+                        gradients);
+                total = _mm256_fmadd_ps(splat(amplitude), value, total);
+                amplitude *= PERSISTENCE;
+                frequency *= 2.0f;
+            }
+
+            _mm256_storeu_ps(out + i, total);
+        }
+
+        for (; i < count; i++) {
+            out[i] = TerrainNoise::height(cellX[i], cellY[i], settings);
+        }
+    }
+#endif
+}
+
+namespace TerrainNoise {
+
+    F32 perlin(F32 x, F32 y, F32 seed) {
+        F32 cellX = std::floor(x);
+        F32 cellY = std::floor(y);
+        F32 fx = x - cellX;
+        F32 fy = y - cellY;
+
+        I32 x0 = static_cast<I32>(cellX);
+        I32 y0 = static_cast<I32>(cellY);
+        U32 seedHash = pcgHash(std::bit_cast<U32>(seed));
+        U32 row0 = pcgHash(static_cast<U32>(y0) ^ seedHash);
+        U32 row1 = pcgHash(static_cast<U32>(y0 + 1) ^ seedHash);
+
+        F32 v00 = cornerValue(x0, row0, fx, fy);
+        F32 v10 = cornerValue(x0 + 1, row0, fx - 1.0f, fy);
+        F32 v01 = cornerValue(x0, row1, fx, fy - 1.0f);
+        F32 v11 = cornerValue(x0 + 1, row1, fx - 1.0f, fy - 1.0f);
+
+        F32 i1 = mix(v00, v10, fade(fx));
+        F32 i2 = mix(v01, v11, fade(fx));
+        return std::fma(0.5f, mix(i1, i2, fade(fy)), 0.5f);
+    }
+
+    F32 fbm(F32 x, F32 y, F32 seed, I32 octaves) {
+        F32 total = 0.0f;
+        F32 amplitude = 1.0f;
+        F32 frequency = 1.0f;
+
+        for (I32 octave = 0; octave < octaves; octave++) {
+            total = std::fma(amplitude, perlin(x * frequency, y * frequency, seed + static_cast<F32>(octave) * OCTAVE_SEED_STEP), total);
+            amplitude *= PERSISTENCE;
+            frequency *= 2.0f;
+        }
+
+        return total;
+    }
+
+    F32 height(F32 cellX, F32 cellY, const Settings& settings) {
+        return fbm(cellX * settings.scale, cellY * settings.scale, settings.seed, settings.octaves);
+    }
+
+    bool usesAvx2() {
+#ifdef TERRAIN_NOISE_X86
+        static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+    void heightBatch(const F32* cellX, const F32* cellY, F32* out, Size count, const Settings& settings) {
+#ifdef TERRAIN_NOISE_X86
+        if (usesAvx2()) {
+            heightBatchAvx2(cellX, cellY, out, count, settings);
+            return;
+        }
+#endif
+
+        for (Size i = 0; i < count; i++) {
+            out[i] = height(cellX[i], cellY[i], settings);
+        }
+    }
+
+    void heightGrid(const Grid& grid, const Settings& settings, std::span<F32> out) {
+        assert(out.size() >= static_cast<Size>(grid.width) * grid.height && "Height grid output too small!");
+
+        auto generateRows = [&](U32 firstRow, U32 lastRow) {
+            std::vector<F32> xs(grid.width);
+            std::vector<F32> ys(grid.width);
+            for (U32 x = 0; x < grid.width; x++) {
+                xs[x] = grid.originX + static_cast<F32>(x) * grid.step;
+            }
+
+            for (U32 y = firstRow; y < lastRow; y++) {
+                std::fill(ys.begin(), ys.end(), grid.originY + static_cast<F32>(y) * grid.step);
+                heightBatch(xs.data(), ys.data(), out.data() + static_cast<Size>(y) * grid.width, grid.width, settings);
+            }
+        };
+
+        U32 threadCount = std::clamp(grid.height / MIN_ROWS_PER_THREAD, 1u, std::max(std::thread::hardware_concurrency(), 1u));
+        if (threadCount == 1) {
+            generateRows(0, grid.height);
+            return;
+        }
+
+        // Contiguous row bands, the calling thread takes the last one
+        U32 rowsPerThread = (grid.height + threadCount - 1) / threadCount;
+        std::vector<std::jthread> workers;
+        for (U32 first = 0; first + rowsPerThread < grid.height; first += rowsPerThread) {
+            workers.emplace_back(generateRows, first, first + rowsPerThread);
+        }
+        generateRows(static_cast<U32>(workers.size()) * rowsPerThread, grid.height);
+    }
+
+}
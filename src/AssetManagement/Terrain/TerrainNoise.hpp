@@ -0,0 +1,55 @@
+// src/AssetManagement/Terrain/TerrainNoise.hpp
+
+#pragma once
+
+#include "Core/Types.hpp"
+
+#include <span>
+
+// CPU port of terrainGenerator/noiseFunctions.glsl and the fbm in its shader.comp.
+//
+// Lattice hashing and the 16 entry gradient table are integer and table lookups only, so heights
+// match the generated heightmap's texels up to float rounding and 16 bit storage. Batches run
+// 8 lanes at a time on AVX2 + FMA, checked at runtime, and through the scalar path elsewhere;
+// both give identical results. Grids are split into row bands across threads.
+//
+// Throughput is bound by the PCG hash's integer multiplies, six per sample and octave.
+// tests/TerrainNoiseTest.cpp fails optimized AVX2 builds below its per thread floor.
+namespace TerrainNoise {
+
+    // Largest difference to a generated heightmap texel: 16 bit storage is 1.5e-5 of that,
+    // the rest covers the GPU contracting or reordering the fbm's float math.
+    // tests/TerrainGeneratorParityTest.cpp holds every texel of generated tiles to it.
+    constexpr F32 GPU_TOLERANCE = 1e-3f;
+
+    // Mirrors PerlinGeneratorPushConstants
+    struct Settings {
+        F32 scale;
+        F32 seed;
+        I32 octaves;
+    };
+
+    // Cells in chunk units, chunk c covers [c, c + 1)
+    struct Grid {
+        F32 originX;
+        F32 originY;
+        F32 step;
+        U32 width;
+        U32 height;
+    };
+
+    F32 perlin(F32 x, F32 y, F32 seed);
+    F32 fbm(F32 x, F32 y, F32 seed, I32 octaves);
+
+    // Unscaled height at a world cell, heightScale * terrainScale is applied when drawing
+    F32 height(F32 cellX, F32 cellY, const Settings& settings);
+
+    // Single threaded, any count
+    void heightBatch(const F32* cellX, const F32* cellY, F32* out, Size count, const Settings& settings);
+
+    // Row major width * height samples
+    void heightGrid(const Grid& grid, const Settings& settings, std::span<F32> out);
+
+    bool usesAvx2();
+
+}
@@ -34,8 +34,12 @@ void Game::run() {
     m_input->update();
 
     TestScene scene;
+    Duration::TimePoint setupStart = Duration::now();
     scene.Setup(&m_resources, m_input, &m_graphics);
 
+    // Pipeline totals are logged by MaterialManager::update once background compiles finish
+    spdlog::info("Scene setup took {:.1f} ms", Duration::since(setupStart).asMilliseconds());
+
     Duration::TimePoint start = Duration::now();
     while (!m_input->shouldClose()) {
         m_input->update();
@@ -60,6 +64,9 @@ void Game::run() {
         scene.Run(m_input);
         scene.Draw(&m_graphics);
 
+        // Stream Resources
+        m_resources.update();
+
         // End Render and Submit
         ImGui::Render();
         m_graphics.renderFrame();
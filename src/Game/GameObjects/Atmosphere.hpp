@@ -0,0 +1,286 @@
+// src/Game/GameObjects/Atmosphere.hpp
+
+#pragma once
+
+#include "RenderEngine/RenderEngine.hpp"
+#include "RenderEngine/RenderObjects/ComputeRenderObject.hpp"
+#include "ResourceManagement/RenderResources/Image.hpp"
+#include "ResourceManagement/ResourceManager.hpp"
+#include "imgui.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+// Physically based sky from two lookup tables, both compute dispatches.
+//
+// The transmittance lut only depends on the atmosphere and is rebuilt when its
+// settings change. The small sky view lut follows the sun and the viewer's altitude,
+// the skybox and the terrain's aerial perspective sample it instead of raymarching.
+class Atmosphere {
+public:
+    // Mirrors AtmosphereParameters in atmosphereTransmittance/atmosphere.glsl, lengths in km
+    struct Parameters {
+        glm::vec3 rayleighScattering;
+        F32 groundRadius;
+        glm::vec3 mieScattering;
+        F32 topRadius;
+        glm::vec3 mieExtinction;
+        F32 rayleighScaleHeight;
+        glm::vec3 ozoneAbsorption;
+        F32 mieScaleHeight;
+        glm::vec3 sunDirection;
+        F32 miePhaseG;
+        glm::vec3 sunIlluminance;
+        F32 viewRadius;
+        glm::vec3 sunTransmittance;
+        F32 exposure;
+        glm::vec3 fogExtinction;
+        F32 kmPerUnit;
+    };
+
+    static constexpr U32 TRANSMITTANCE_WIDTH = 256;
+    static constexpr U32 TRANSMITTANCE_HEIGHT = 64;
+    static constexpr U32 SKY_VIEW_WIDTH = 192;
+    static constexpr U32 SKY_VIEW_HEIGHT = 108;
+    static constexpr U32 GROUP_SIZE = 8;
+    static constexpr U32 TRANSMITTANCE_STEPS = 40;     // Matches atmosphereTransmittance/shader.comp
+    static constexpr F32 MIN_ALTITUDE = 0.001f;         // km, keeps the viewer above the ground sphere
+    static constexpr F32 ALTITUDE_EPSILON = 0.01f;      // km the viewer moves before the sky view is redrawn
+
+    Image transmittanceLut;
+    Image skyViewLut;
+    Sampler sampler;
+
+    Buffer parametersBuffer;
+    DescriptorPool pool;
+    MaterialData transmittanceMaterial;
+    MaterialData skyViewMaterial;
+
+    // Earth, from Hillaire 2020
+    Parameters parameters = {
+        .rayleighScattering = {5.802e-3f, 13.558e-3f, 33.1e-3f},
+        .groundRadius = 6360.0f,
+        .mieScattering = glm::vec3(3.996e-3f),
+        .topRadius = 6460.0f,
+        .mieExtinction = glm::vec3(4.40e-3f),
+        .rayleighScaleHeight = 8.0f,
+        .ozoneAbsorption = {0.650e-3f, 1.881e-3f, 0.085e-3f},
+        .mieScaleHeight = 1.2f,
+        .sunDirection = {0.0f, 0.0f, 1.0f},
+        .miePhaseG = 0.8f,
+        .sunIlluminance = glm::vec3(10.0f),
+        .viewRadius = 6360.0f,
+        .sunTransmittance = glm::vec3(1.0f),
+        .exposure = 0.6f,
+        .fogExtinction = glm::vec3(0.0f),
+        .kmPerUnit = 0.01f,
+    };
+
+    float sunAzimuth = 0.0f;
+    float sunElevation = 45.0f;
+    float haze = 1.0f;              // Mie density multiplier
+
+    // Time of day, the sun rises at azimuth 0 and sets at 180
+    bool animateSun = false;
+    float dayLength = 120.0f;       // Seconds
+
+    bool transmittanceInvalid = true;
+    bool skyViewInvalid = true;
+    F32 drawnAltitude = -1.0f;
+
+    void Setup(ResourceManager* resources) {
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        transmittanceLut = resources->createImage(
+            {TRANSMITTANCE_WIDTH, TRANSMITTANCE_HEIGHT},
+            VK_FORMAT_R16G16B16A16_SFLOAT,
+            usage,
+            ImageType::Texture2D,
+            "Transmittance LUT"
+        ).value();
+
+        skyViewLut = resources->createImage(
+            {SKY_VIEW_WIDTH, SKY_VIEW_HEIGHT},
+            VK_FORMAT_R16G16B16A16_SFLOAT,
+            usage,
+            ImageType::Texture2D,
+            "Sky View LUT"
+        ).value();
+
+        // Azimuth wraps, zenith angle doesn't
+        sampler = resources->getSamplerBuilder()
+            .setFilter(VkFilter::VK_FILTER_LINEAR, VkFilter::VK_FILTER_LINEAR)
+            .setAddressMode(
+                VkSamplerAddressMode::VK_SAMPLER_ADDRESS_MODE_REPEAT,
+                VkSamplerAddressMode::VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                VkSamplerAddressMode::VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
+            )
+            .build().value();
+
+        parametersBuffer = resources->createUniformBuffer(sizeof(Parameters), "Atmosphere Buffer").value();
+
+        std::array<DescriptorPool::PoolSizeRatio, 2> poolRatios = {{
+            {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.5f},
+            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1.0f},
+        }};
+        pool = resources->createDescriptorPool(2, poolRatios).value();
+
+        transmittanceMaterial = resources->getMaterialManager()->getData("atmosphereTransmittance", &pool, nullptr);
+        transmittanceMaterial.descriptorSets[0].set.writeStorageImage(0, transmittanceLut.view);
+        transmittanceMaterial.descriptorSets[0].set.writeUniformBuffer(1, &parametersBuffer, sizeof(Parameters), 0);
+
+        skyViewMaterial = resources->getMaterialManager()->getData("atmosphereSkyView", &pool, nullptr);
+        skyViewMaterial.descriptorSets[0].set.writeStorageImage(0, skyViewLut.view);
+        skyViewMaterial.descriptorSets[0].set.writeStorageImage(1, transmittanceLut.view);
+        skyViewMaterial.descriptorSets[0].set.writeUniformBuffer(2, &parametersBuffer, sizeof(Parameters), 0);
+    }
+
+    Image* getSkyView() { return &skyViewLut; }
+    Buffer* getParametersBuffer() { return &parametersBuffer; }
+
+    void Run(F32 deltaTime, glm::vec3 cameraPosition) {
+        ImGui::Begin("Sky Settings");
+        skyViewInvalid |= ImGui::SliderFloat("Sun Elevation", &sunElevation, -10.0f, 90.0f);
+        skyViewInvalid |= ImGui::SliderFloat("Sun Azimuth", &sunAzimuth, 0.0f, 360.0f);
+        ImGui::Checkbox("Animate Sun", &animateSun);
+        ImGui::SliderFloat("Day Length (s)", &dayLength, 10.0f, 600.0f);
+
+        ImGui::Separator();
+        transmittanceInvalid |= ImGui::SliderFloat("Haze", &haze, 0.0f, 10.0f);
+        skyViewInvalid |= ImGui::SliderFloat("Sun Illuminance", &parameters.sunIlluminance.x, 0.0f, 50.0f);
+        ImGui::SliderFloat("Exposure", &parameters.exposure, 0.0f, 5.0f);
+        ImGui::SliderFloat("Km / Unit", &parameters.kmPerUnit, 0.0f, 0.1f, "%.4f");
+
+        if (animateSun) {
+            sunAzimuth = std::fmod(sunAzimuth + 360.0f * deltaTime / dayLength, 360.0f);
+            sunElevation = std::max(90.0f * std::sin(glm::radians(sunAzimuth)), -10.0f);
+            skyViewInvalid = true;
+        }
+
+        parameters.sunIlluminance = glm::vec3(parameters.sunIlluminance.x);
+        parameters.mieScattering = glm::vec3(3.996e-3f * haze);
+        parameters.mieExtinction = glm::vec3(4.40e-3f * haze);
+        parameters.sunDirection = getSunDirection(true);
+
+        // Only the viewer's altitude matters, the sky doesn't move with it horizontally
+        F32 altitude = std::max(cameraPosition.z * parameters.kmPerUnit, MIN_ALTITUDE);
+        parameters.viewRadius = parameters.groundRadius + altitude;
+        if (std::abs(altitude - drawnAltitude) > ALTITUDE_EPSILON) {
+            skyViewInvalid = true;
+        }
+
+        parameters.sunTransmittance = transmittance(parameters.viewRadius, parameters.sunDirection.z);
+        parameters.fogExtinction = extinction(altitude);
+
+        std::memcpy(parametersBuffer.info.pMappedData, &parameters, sizeof(Parameters));
+
+        ImGui::Text("Sun Dir (toSun): (%.3f, %.3f, %.3f)",
+                parameters.sunDirection.x,
+                parameters.sunDirection.y,
+                parameters.sunDirection.z);
+        ImGui::Text("Sun Color: (%.3f, %.3f, %.3f)",
+                parameters.sunTransmittance.r,
+                parameters.sunTransmittance.g,
+                parameters.sunTransmittance.b);
+        ImGui::End();
+    }
+
+    glm::vec3 getSunDirection(bool toSun) {
+        float azimuthRad = glm::radians(sunAzimuth);
+        float elevationRad = glm::radians(sunElevation);
+
+        glm::vec3 dir = glm::normalize(glm::vec3(
+            cos(elevationRad) * cos(azimuthRad),
+            cos(elevationRad) * sin(azimuthRad),
+            sin(elevationRad)
+        ));
+
+        return toSun ? dir : -dir;
+    }
+
+    // Sunlight reaching the viewer, for the directional light
+    glm::vec3 getSunColor() const {
+        return parameters.sunTransmittance;
+    }
+
+    glm::vec3 extinction(F32 altitude) const {
+        F32 rayleigh = std::exp(-altitude / parameters.rayleighScaleHeight);
+        F32 mie = std::exp(-altitude / parameters.mieScaleHeight);
+        F32 ozone = std::max(0.0f, 1.0f - std::abs(altitude - 25.0f) / 15.0f);
+
+        return parameters.rayleighScattering * rayleigh +
+               parameters.mieExtinction * mie +
+               parameters.ozoneAbsorption * ozone;
+    }
+
+    // What the transmittance lut holds, evaluated on the CPU for the sun
+    glm::vec3 transmittance(F32 radius, F32 zenithCos) const {
+        F32 groundRadius = parameters.groundRadius;
+        F32 topRadius = parameters.topRadius;
+
+        // Below the horizon
+        if (zenithCos < 0.0f && radius * radius * (zenithCos * zenithCos - 1.0f) + groundRadius * groundRadius >= 0.0f) {
+            return glm::vec3(0.0f);
+        }
+
+        F32 discriminant = radius * radius * (zenithCos * zenithCos - 1.0f) + topRadius * topRadius;
+        F32 rayLength = std::max(-radius * zenithCos + std::sqrt(std::max(discriminant, 0.0f)), 0.0f);
+        F32 stepLength = rayLength / TRANSMITTANCE_STEPS;
+
+        glm::vec3 origin = {0.0f, 0.0f, radius};
+        glm::vec3 direction = {std::sqrt(std::max(1.0f - zenithCos * zenithCos, 0.0f)), 0.0f, zenithCos};
+
+        glm::vec3 depth(0.0f);
+        for (U32 i = 0; i < TRANSMITTANCE_STEPS; i++) {
+            glm::vec3 position = origin + direction * ((static_cast<F32>(i) + 0.5f) * stepLength);
+            depth += extinction(glm::length(position) - groundRadius) * stepLength;
+        }
+
+        return glm::exp(-depth);
+    }
+
+    void Draw(RenderEngine* graphics) {
+        std::vector<ComputeRenderObject> objects;
+
+        if (transmittanceInvalid) {
+            objects.push_back({
+                .material = &transmittanceMaterial,
+                .pushConstantData = nullptr,
+                .groupCountX = (TRANSMITTANCE_WIDTH + GROUP_SIZE - 1) / GROUP_SIZE,
+                .groupCountY = (TRANSMITTANCE_HEIGHT + GROUP_SIZE - 1) / GROUP_SIZE,
+                .groupCountZ = 1,
+                .storageImages = {&transmittanceLut},
+            });
+        }
+
+        if (transmittanceInvalid || skyViewInvalid) {
+            objects.push_back({
+                .material = &skyViewMaterial,
+                .pushConstantData = nullptr,
+                .groupCountX = (SKY_VIEW_WIDTH + GROUP_SIZE - 1) / GROUP_SIZE,
+                .groupCountY = (SKY_VIEW_HEIGHT + GROUP_SIZE - 1) / GROUP_SIZE,
+                .groupCountZ = 1,
+                .storageImages = {&skyViewLut, &transmittanceLut},
+                .dependsOnPrevious = transmittanceInvalid,
+            });
+
+            drawnAltitude = parameters.viewRadius - parameters.groundRadius;
+        }
+
+        transmittanceInvalid = false;
+        skyViewInvalid = false;
+
+        if (!objects.empty()) {
+            graphics->dispatchComputeObjects(objects);
+        }
+    }
+
+    void Cleanup() {
+        transmittanceLut.shutdown();
+        skyViewLut.shutdown();
+        sampler.shutdown();
+        parametersBuffer.shutdown();
+        pool.destroyPools();
+    }
+};
@@ -6,6 +6,7 @@
 #include "AssetManagement/Meshes/PlaneGenerator.hpp"
 #include "GameObject.hpp"
 #include "ResourceManagement/RenderResources/Image.hpp"
+#include "ResourceManagement/RenderResources/ObjectBuffer.hpp"
 #include "ResourceManagement/ResourceManager.hpp"
 #include "glm/ext/matrix_transform.hpp"
 #include "imgui.h"
@@ -16,7 +17,8 @@ public:
     DescriptorPool pool;
     assets::Mesh plane;
 
-    Buffer objectBuffer;
+    ObjectBuffer objectBuffer;
+    U32 objectSlot;
 
     Image* diffuse;
     Image* normal;
@@ -25,17 +27,21 @@ public:
     Sampler sampler;
     glm::vec3 offset = glm::vec3(0.0f);
     glm::vec3 scale = glm::vec3(1.0f);
+    bool wireframe = false;
+    bool wireframeSupported = false;
+
+    struct ObjectData {
+        glm::mat4 model;
+        glm::vec4 colorTint;
+    };
 
     struct PushData {
-        glm::vec4 highlightColor;
-        float outlineWidth;
-        float pad[3];   // 16-byte alignment
+        VkDeviceAddress objectData;
     } pushData;
 
-    void Setup(ResourceManager* resources, BufferRegistry* buffers, Input* input) {
+    void Setup(ResourceManager* resources, Input* input) {
         // Descriptor Pool
-        std::array<DescriptorPool::PoolSizeRatio, 2> poolRatios = {{
-            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 3.0f},
+        std::array<DescriptorPool::PoolSizeRatio, 1> poolRatios = {{
             {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 3.0f}
         }};
         pool = resources->createDescriptorPool(1, poolRatios).value();
@@ -43,11 +49,18 @@ public:
         // Create Mesh
         createPlane(resources, &plane, &pool, 128);
         plane.materials.push_back(resources->getMaterialManager()->getData("meshDemo", &pool, &plane.vertexLayout));
-        plane.materials.push_back(resources->getMaterialManager()->getData("wireframe", &pool, &plane.vertexLayout));
+
+        // Without dynamic polygon mode the wireframe needs a pipeline, and so a material, of its own
+        wireframeSupported = resources->getMaterialManager()->supportsWireframe();
+        if (wireframeSupported && !resources->getMaterialManager()->usesDynamicPolygonMode()) {
+            plane.materials.push_back(resources->getMaterialManager()->getData("wireframe", &pool, &plane.vertexLayout));
+        }
         plane.surfaces[0].materialIndex = 0;
 
         // Buffers
-        objectBuffer = resources->createUniformBuffer(800, "Plane Uniform Buffer").value();  // model + tint
+        objectBuffer = resources->createObjectBuffer(sizeof(ObjectData), 16, "Plane Object Buffer").value();
+        objectSlot = objectBuffer.allocate().value();
+        pushData.objectData = objectBuffer.getAddress(objectSlot);
 
         // Textures
         LoadImageConfig imageConfig = {
@@ -62,23 +75,14 @@ public:
 
         sampler = resources->getSamplerBuilder().build().value();
 
-        // Set 0: Global UBOs
-        Buffer* globalBuffer = buffers->getBuffer("Global Buffer");
-        for (Size i = 0; i < 2; i++) {
-            plane.materials[i].descriptorSets[0].set.writeUniformBuffer(0, globalBuffer, 192, 0);     // camera
-            plane.materials[i].descriptorSets[0].set.writeUniformBuffer(1, globalBuffer, 320, 192);   // lights
-
+        // Set 0 is the global set, bound by the render graph
+        for (Size i = 0; i < plane.materials.size(); i++) {
             // Set 1: Material Textures
-            plane.materials[i].descriptorSets[1].set.writeImageSampler(0, diffuse, sampler); // albedo
-            plane.materials[i].descriptorSets[1].set.writeImageSampler(1, normal, sampler); // normal (placeholder)
-            plane.materials[i].descriptorSets[1].set.writeImageSampler(2, rough, sampler); // roughness (placeholder)
-
-            // Set 2: Object Data
-            plane.materials[i].descriptorSets[2].set.writeUniformBuffer(0, &objectBuffer, 80, 0);
+            plane.materials[i].descriptorSets[0].set.writeImageSampler(0, diffuse, sampler); // albedo
+            plane.materials[i].descriptorSets[0].set.writeImageSampler(1, normal, sampler); // normal (placeholder)
+            plane.materials[i].descriptorSets[0].set.writeImageSampler(2, rough, sampler); // roughness (placeholder)
 
-            // Push Constants
-            pushData.highlightColor = glm::vec4(1.0f, 0.0f, 0.0f, 0.25f); // red tint, 25% blend
-            pushData.outlineWidth = 0.01f;
+            // Push Constants: Object Data address
             plane.pushConstantData.push_back(&pushData);
         }
 
@@ -90,13 +94,11 @@ public:
     }
 
     void SetImage(Image* newAlbedo) {
-        plane.materials[0].descriptorSets[1].set.writeImageSampler(0, newAlbedo, sampler);
+        plane.materials[0].descriptorSets[0].set.writeImageSampler(0, newAlbedo, sampler);
     }
 
     void Run(Input* input) {
         // Update Buffer
-        uint8_t* objectPtr = reinterpret_cast<uint8_t*>(objectBuffer.info.pMappedData);
-
         glm::mat4 model = glm::mat4(1.0f);
 
         float move = 0.0f;
@@ -119,25 +121,41 @@ public:
         ImGui::Text("Off: (%.1f, %.1f, %.1f)", offset.x, offset.y, offset.z);
         ImGui::Text("Scale: (%.1f, %.1f, %.1f)", scale.x, scale.y, scale.z);
 
-        U32 currentMaterialIndex = plane.surfaces[0].materialIndex;
-        if (ImGui::Button("Toggle Material")) {
-            currentMaterialIndex = (currentMaterialIndex + 1) % 2;
-            plane.surfaces[0].materialIndex = currentMaterialIndex;
+        if (wireframeSupported && ImGui::Button("Toggle Material")) {
+            wireframe = !wireframe;
+            if (plane.materials.size() > 1) {
+                plane.surfaces[0].materialIndex = wireframe ? 1 : 0;
+            }
         }
 
-        ImGui::Text("Current Material: %d", currentMaterialIndex);
+        ImGui::Text("Current Material: %s", wireframe ? "Wireframe" : "Mesh");
         ImGui::End();
 
-        memcpy(objectPtr, &model, sizeof(glm::mat4));
-        memcpy(objectPtr + sizeof(glm::mat4), &tint, sizeof(glm::vec4));
+        ObjectData* object = static_cast<ObjectData*>(objectBuffer.getData(objectSlot));
+        object->model = model;
+        object->colorTint = tint;
     }
 
     void Draw(RenderEngine* graphics) {
-        graphics->renderObjects(0, plane.draw());
+        std::vector<RenderObject> objects = plane.draw();
+
+        // Same material and pipeline, only the per draw raster state changes
+        if (wireframe && plane.materials.size() == 1) {
+            RasterState raster = plane.materials[0].pipeline->raster;
+            raster.polygonMode = VK_POLYGON_MODE_LINE;
+            raster.cullMode = VK_CULL_MODE_NONE;
+
+            for (RenderObject& object : objects) {
+                object.raster = raster;
+            }
+        }
+
+        graphics->renderObjects(0, objects);
     }
 
     void Cleanup(ResourceManager* resources) {
         pool.destroyPools();
+        objectBuffer.free(objectSlot);
         objectBuffer.shutdown();
         sampler.shutdown();
         resources->dropImage(diffuse);
@@ -14,34 +14,24 @@ public:
     DescriptorPool pool;
     assets::Mesh skybox;
 
-    Image* cubemap = nullptr;
-    Sampler sampler;
-
     struct PushData {
         glm::mat4 viewProj;
     } pushData;
 
     void Setup(ResourceManager* resources) {
 
-        // Descriptor Pool
+        // Descriptor Pool, the sky view lut and atmosphere come from the global set so it stays empty
         std::array<DescriptorPool::PoolSizeRatio, 1> poolRatios = {{
-            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1.0f}
+            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1.0f},
         }};
         pool = resources->createDescriptorPool(1, poolRatios).value();
 
         createCube(resources, "skyBox", &skybox, &pool);
 
-        sampler = resources->getSamplerBuilder().build().value();
-
         // Camera Data
         skybox.pushConstantData.push_back(&pushData);
     }
 
-    void SetImage(Image* generatedCubemap) {
-        cubemap = generatedCubemap;
-        skybox.materials[0].descriptorSets[0].set.writeImageSampler(0, cubemap, sampler);
-    }
-
     void SetViewProj(glm::mat4 viewProj) {
         pushData.viewProj = viewProj;
     }
@@ -52,7 +42,6 @@ public:
 
     void Cleanup() {
         pool.destroyPools();
-        sampler.shutdown();
         skybox.destroyMesh();
     }
 };
@@ -3,208 +3,330 @@
 #pragma once
 
 #include "AssetManagement/Meshes/PlaneGenerator.hpp"
+#include "AssetManagement/Terrain/TerrainNoise.hpp"
+#include "RenderEngine/Config.hpp"
 #include "RenderEngine/RenderEngine.hpp"
+#include "RenderEngine/RenderObjects/ComputeRenderObject.hpp"
+#include "RenderEngine/RenderObjects/ImageCopyObject.hpp"
 #include "RenderEngine/RenderObjects/Materials.hpp"
 #include "RenderEngine/RenderObjects/RenderObject.hpp"
-#include "RenderEngine/RenderObjects/TextureRenderObject.hpp"
-#include "ResourceManagement/BufferRegistry.hpp"
-#include "ResourceManagement/RenderResources/Image.hpp"
-#include "ResourceManagement/RenderResources/VertexAttribute.hpp"
+#include "ResourceManagement/RenderResources/VirtualTexture.hpp"
 #include "ResourceManagement/ResourceManager.hpp"
+#include "ResourceManagement/TileCache.hpp"
 #include "imgui.h"
 
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
 static const U32 RESOLUTION = 128;
 
-class TerrainChunk {
+// A quadtree node picked for drawing this frame, heights come from the shared world heightmap
+struct TerrainNode {
+    struct TerrainNodePushConstants {
+        glm::vec2 offset;           // Minimum corner, in chunks
+        float size;                 // In chunks
+        float gridSize;             // Quads per side of the mesh it is drawn with
+        glm::vec2 morphRange;       // Camera distance over which it morphs into its parent
+        VkDeviceAddress heightmapInfo;
+        VkDeviceAddress heightmapFeedback;
+    } terrainNodePC;
+
+    bool quadrant;                  // Parent level over a child's area, drawn with the half grid
+};
+
+class TerrainManager {
 public:
+    // Descriptors
+    DescriptorPool pool;
+    Sampler sampler;
+
+    // Index only grids, one full and one over a single quadrant at the same spacing.
+    // The vertex shader places vertices from gl_VertexIndex.
+    GeometryPool* geometryPool = nullptr;
+    U32 nodeGeometry = 0;
+    U32 quadrantGeometry = 0;
+    U32 nodeIndexCount = 0;
+    U32 quadrantIndexCount = 0;
+
+    // Terrain Data
+    Buffer terrainBuffer;
+    MaterialData terrainMaterial;
+
+    float terrainScale = 128.0f;
+    float heightScale = 0.50f;
+
+    // World Heightmap, a window of chunks that wraps around the camera
+    static constexpr U32 HEIGHTMAP_SIZE = 16384;        // 128x128 chunks
+    static constexpr I32 WINDOW_CHUNKS = HEIGHTMAP_SIZE / RESOLUTION;
+    static constexpr VkFormat HEIGHTMAP_FORMAT = VK_FORMAT_R16_UNORM;  // Height only, see terrainGenerator/shader.comp
+    static constexpr U32 MAX_RESIDENT_TILES = 1024;     // 64 MiB of 256x128 R16 tiles
+    static constexpr U32 TILES_PER_FRAME = 32;
+    static constexpr I32 MAX_REFILLS_PER_FRAME = MAX_RESIDENT_TILES - TILES_PER_FRAME;
+
+    // Invalidated tiles keep their old heights until refilled, a few per frame
+    I32 refillBudget = 64;
+    VkOffset2D cameraTexel = {0, 0};
 
-    // Terrain Image
-    Image terrainInfo;
+    VirtualTexture heightmap;
     MaterialData perlinGenerator;
+    MaterialData fixedOctaveGenerator;      // Specialized with its fbm loop unrolled, used at DEFAULT_OCTAVES
 
     struct PerlinGeneratorPushConstants {
         float scale;
         float seed;
-        glm::vec2 offset;
-        float texelSize;
+        glm::vec2 origin;
+        float worldChunks;
         U32 octaves;
+        VkDeviceAddress tiles;
     } perlinGeneratorPC;
 
-    bool imageInvalid = true;
+    // Every tile filled this frame, mirrors GeneratorTile in terrainGenerator/shader.comp
+    struct GeneratorTile {
+        U32 mipLevel;
+        U32 _pad0;
+        I32 offsetX, offsetY;
+        U32 width, height;
+        U32 mipWidth, mipHeight;
+    };
 
-    // Terrain Mesh
-    MaterialData terrainMaterial;
+    // A frame never fills more than every resident tile plus the mip tail
+    static constexpr U32 MAX_FILLS_PER_FRAME = MAX_RESIDENT_TILES + VirtualTexture::MAX_MIP_LEVELS;
+    static constexpr U32 GENERATOR_GROUP_SIZE = 8;
+    static constexpr I32 DEFAULT_OCTAVES = 4;
+    static constexpr Size FILL_SLOTS = Config::framesInFlight + 1;  // Written before the frame's fence is waited on
 
-    struct TerrainChunkPushConstants {
-        glm::vec2 offset;
-    } terrainChunkPC;
+    Buffer fillBuffer;
+    Size fillSlot = 0;
 
-    void setOffset(glm::vec2 offset) {
-        terrainChunkPC.offset = offset;
-        perlinGeneratorPC.offset = offset;
-    }
+    // Generated tiles are read back into an archive on disk, revisits and restarts upload them instead
+    static constexpr U32 CACHE_CAPACITY = 4096;             // 256 MiB of 64 KiB tiles
+    static constexpr U32 CACHE_COPIES_PER_FRAME = 64;       // Each way, the rest is generated or not kept
+    static constexpr Size TEXEL_BYTES = 2;                  // R16 height
+    static constexpr F32 HEIGHT_RANGE = 2.0f;               // Mirrors terrainGenerator/shader.comp
 
-    TextureRenderObject getTarget() {
-        return {
-            .texture = &terrainInfo,
-            .view = terrainInfo.getImageView(),
-            .material = &perlinGenerator,
-            .pushConstantData = &perlinGeneratorPC,
-        };
+    struct PendingReadback {
+        TileKey key;
+        Size offset;
     };
 
-    void Setup(
-        ResourceManager* resources,
-        DescriptorPool* pool,
-        ProvidedVertexLayout* vertexLayout,
-        Buffer* globalBuffer,
-        Buffer* terrainBuffer,
-        Sampler* sampler
-    ) {
-        // Set Generator Material
-        perlinGenerator = resources->getMaterialManager()->getData("terrainGenerator", pool, nullptr);
-
-        // Create Chunk Image
-        terrainInfo = resources->createImage(
-            {RESOLUTION, RESOLUTION},
-            VkFormat::VK_FORMAT_R16G16B16A16_SFLOAT,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
-            VK_IMAGE_USAGE_SAMPLED_BIT |
-            VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
-            VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-            ImageType::Texture2D,
-            "Generated Heightmap"
-        ).value();
-
-        perlinGeneratorPC = {};
-        perlinGeneratorPC.scale = 1;
-        perlinGeneratorPC.texelSize = 1.0f/RESOLUTION;
-        perlinGeneratorPC.octaves = 4;
+    TileCache tileCache;
+    Size tileBytes = 0;
+    Buffer uploadBuffer;
+    Buffer readbackBuffer;
+    std::array<std::vector<PendingReadback>, FILL_SLOTS> pendingReadbacks;
+    U32 cachedUploads = 0;
+
+    // Height queries: the tile cache answers at once, resident texels are read back a few
+    // frames later and anything outside the resident heightmap comes from TerrainNoise
+    static constexpr U32 HEIGHT_READBACKS_PER_FRAME = 4096;         // Points, the rest wait for the next frame
+    static constexpr Size HEIGHT_READBACK_BYTES = 4 * TEXEL_BYTES;  // The 2x2 texels around a point
+
+    struct HeightQuery {
+        std::vector<glm::vec2> texels;      // Mip 0 texel coordinates, texel i is centred on i
+        std::vector<F32> heights;           // As generated, scaled once taken
+        Size unresolved;
+    };
 
-        terrainChunkPC = {};
-        terrainChunkPC.offset = {0,0};
+    struct QueuedHeight {
+        U64 query;
+        U32 index;
+    };
 
+    struct PendingHeight {
+        U64 query;
+        U32 index;
+        Size offset;
+    };
 
-        // Get Terrain Material
-        terrainMaterial = resources->getMaterialManager()->getData("terrain", pool, vertexLayout);
+    Buffer heightReadbackBuffer;
+    std::unordered_map<U64, HeightQuery> heightQueries;
+    std::vector<QueuedHeight> queuedHeights;
+    std::array<std::vector<PendingHeight>, FILL_SLOTS> pendingHeights;
+    U64 nextHeightQuery = 1;
 
-        // Global Data
-        terrainMaterial.descriptorSets[0].set.writeUniformBuffer(0, globalBuffer, 192, 0);     // camera
-        terrainMaterial.descriptorSets[0].set.writeUniformBuffer(1, globalBuffer, 320, 192);   // lights
+    glm::ivec2 windowOrigin = {0, 0};
 
-        // Terrain Data
-        terrainMaterial.descriptorSets[1].set.writeUniformBuffer(0, terrainBuffer, 12, 0);   // lights
+    // Quadtree LOD, nodes of NODE_GRID quads from LEAF_SIZE chunks up to roots of ROOT_SIZE.
+    // Node corners are in chunk cells, chunk c covers cell [c, c + 1).
+    static constexpr U32 NODE_GRID = 64;
+    static constexpr I32 MAX_LEVEL = 5;
+    static constexpr F32 LEAF_SIZE = static_cast<F32>(NODE_GRID) / RESOLUTION;    // One heightmap texel per quad
+    static constexpr I32 ROOT_SIZE = static_cast<I32>(LEAF_SIZE * (1 << MAX_LEVEL));
+    static constexpr F32 MORPH_START = 0.7f;            // Fraction of a level's range before it starts morphing
+    static constexpr F32 NO_MORPH = 1e30f;
 
-        // Chunk Texture
-        terrainMaterial.descriptorSets[2].set.writeImageSampler(0, &terrainInfo, *sampler);
-    };
+    static constexpr I32 MAX_RADIUS = WINDOW_CHUNKS / 2 - ROOT_SIZE - 2;   // Every node stays inside the window
 
-    void SetTerrainGenInfo(float scale, float seed, float octaves) {
-        perlinGeneratorPC.scale = scale;
-        perlinGeneratorPC.seed = seed;
-        perlinGeneratorPC.octaves = octaves;
+    I32 radius = 32;
+    F32 pixelError = 2.0f;
+    glm::ivec2 cameraChunk = {0, 0};
 
-        imageInvalid = true;
-    }
+    std::array<F32, MAX_LEVEL + 1> lodRanges = {};
 
-    void Run() {
-    }
+    // Generated height range under every node of a root, from a TerrainNoise grid. Peaks between
+    // samples only get the margin, the bounds pick LODs and never cull anything.
+    static constexpr U32 LEAF_BOUNDS_SAMPLES = 8;       // Grid cells per leaf side
+    static constexpr F32 BOUNDS_MARGIN = 0.05f;         // Unscaled, like the heightmap's texels
 
-    void Draw(RenderEngine* graphics, RenderObject obj) {
-        if (imageInvalid) {
-            graphics->renderTextureObjects({getTarget()});
-            imageInvalid = false;
-        }
+    struct RootBounds {
+        std::array<std::vector<glm::vec2>, MAX_LEVEL + 1> levels;     // Min and max per node, row major
+        bool used;
+    };
 
-        obj.material = &terrainMaterial;
-        obj.pushConstantData = &terrainChunkPC;
+    std::unordered_map<U64, RootBounds> rootBounds;
 
-        graphics->renderObjects(0, {obj});
+    std::vector<TerrainNode> nodes;
+    std::vector<RenderObject> nodeObjects;
 
+    static I32 wrap(I32 value, I32 size) {
+        return ((value % size) + size) % size;
     }
 
-    void Cleanup() {
-        terrainInfo.shutdown();
+    // The heightmap is a toroidal ring of WINDOW_CHUNKS chunk slots per axis following the camera,
+    // world chunk c is always generated into slot c mod WINDOW_CHUNKS
+    static I32 ringSlot(I32 chunk) {
+        return wrap(chunk, WINDOW_CHUNKS);
     }
-};
-
-class TerrainManager {
-public:
-    // Descriptors
-    DescriptorPool pool;
-    Sampler sampler;
-
-    // Mesh Data
-    Buffer vertexBuffer;
-    Buffer indexBuffer;
-    ProvidedVertexLayout vertexLayout;
-    U32 indexStart = 0;
-    U32 indexCount = 0;
 
-    // Terrain Data
-    Buffer terrainBuffer;
-
-    // Chunks
-    static constexpr I32 GRID_SIZE = 3;
+    // The world chunk a slot holds while the window starts at origin
+    static I32 slotChunk(I32 slot, I32 origin) {
+        return origin + wrap(slot - origin, WINDOW_CHUNKS);
+    }
 
-    std::array<std::array<TerrainChunk, GRID_SIZE>, GRID_SIZE> chunks;
+    static F32 nodeSize(I32 level) {
+        return LEAF_SIZE * static_cast<F32>(1 << level);
+    }
 
-    void Setup(ResourceManager* resources, BufferRegistry* buffers) {
+    void Setup(ResourceManager* resources) {
         // Descriptor Pool
-        std::array<DescriptorPool::PoolSizeRatio, 2> poolRatios = {{
-            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 3.0f},
-            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1.0f}
+        std::array<DescriptorPool::PoolSizeRatio, 3> poolRatios = {{
+            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1.0f},
+            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1.0f},
+            {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, static_cast<float>(VirtualTexture::MAX_MIP_LEVELS)},
         }};
         pool = resources->createDescriptorPool(1, poolRatios).value();
 
         // Create Mesh
-        createPlaneBuffers(resources, &vertexBuffer, &indexBuffer, &vertexLayout, &indexCount, RESOLUTION);
+        geometryPool = resources->getGeometryPool();
+        createGridIndices(resources, &nodeGeometry, &nodeIndexCount, NODE_GRID);
+        createGridIndices(resources, &quadrantGeometry, &quadrantIndexCount, NODE_GRID / 2);
 
         // Buffers
         terrainBuffer = resources->createUniformBuffer(12, "Terrain Buffer").value();
 
         // Set resolution in terrainBuffer
         float* objectPtr = reinterpret_cast<float*>(terrainBuffer.info.pMappedData);
-        objectPtr[0] = 128.0f;    // initial terrainScale
-        objectPtr[1] = 0.50f;     // initial heightScale
+        objectPtr[0] = terrainScale;
+        objectPtr[1] = heightScale;
         objectPtr[2] = 1.0f/RESOLUTION;    // resolution
 
+        // Repeat, the heightmap wraps around the camera
         sampler = resources->getSamplerBuilder()
             .setFilter(VkFilter::VK_FILTER_NEAREST, VkFilter::VK_FILTER_NEAREST)
             .setAddressMode(
-                VkSamplerAddressMode::VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-                VkSamplerAddressMode::VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-                VkSamplerAddressMode::VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
+                VkSamplerAddressMode::VK_SAMPLER_ADDRESS_MODE_REPEAT,
+                VkSamplerAddressMode::VK_SAMPLER_ADDRESS_MODE_REPEAT,
+                VkSamplerAddressMode::VK_SAMPLER_ADDRESS_MODE_REPEAT
             )
             .build().value();
 
-        for (I32 y = 0; y < GRID_SIZE; y++) {
-            for (I32 x = 0; x < GRID_SIZE; x++) {
-                chunks[y][x].Setup(
-                    resources,
-                    &pool,
-                    &vertexLayout,
-                    buffers->getBuffer("Global Buffer"),
-                    &terrainBuffer,
-                    &sampler
-                );
-
-                I32 startOffset = GRID_SIZE / 2.0f;
-                glm::vec2 offset = glm::vec2(
-                    (x-startOffset),
-                    (y-startOffset)
-                );
-                chunks[y][x].setOffset(offset);
-            }
+        // Heightmap
+        heightmap = resources->createVirtualTexture(
+            HEIGHTMAP_SIZE,
+            HEIGHTMAP_FORMAT,
+            VK_IMAGE_USAGE_STORAGE_BIT |
+            VK_IMAGE_USAGE_SAMPLED_BIT |
+            VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+            MAX_RESIDENT_TILES,
+            "World Heightmap"
+        ).value();
+
+        // Set Generator Material, a compute shader filling every requested tile in one dispatch
+        perlinGenerator = resources->getMaterialManager()->getData("terrainGenerator", &pool, nullptr);
+
+        // The unrolled variant compiles in the background, the generic generator fills tiles until then
+        resources->getMaterialManager()->registerFallback("terrainGenerator", nullptr);
+        fixedOctaveGenerator = resources->getMaterialManager()->getDataAsync(
+            "terrainGenerator", &pool, nullptr, "terrainGenerator", {{"FIXED_OCTAVES", DEFAULT_OCTAVES}}
+        );
+
+        for (U32 mip = 0; mip < VirtualTexture::MAX_MIP_LEVELS; mip++) {
+            // Unused array elements still need a valid view
+            U32 viewMip = std::min(mip, heightmap.getMipLevels() - 1);
+            perlinGenerator.descriptorSets[0].set.writeStorageImage(0, heightmap.getMipView(viewMip).get(), mip);
+            fixedOctaveGenerator.descriptorSets[0].set.writeStorageImage(0, heightmap.getMipView(viewMip).get(), mip);
         }
+
+        fillBuffer = resources->createBuffer(
+            sizeof(GeneratorTile) * MAX_FILLS_PER_FRAME * FILL_SLOTS,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU,
+            VMA_ALLOCATION_CREATE_MAPPED_BIT,
+            "Terrain Fill Tiles"
+        ).value();
+
+        // Tile Cache
+        VkExtent2D tileExtent = heightmap.getTileExtent();
+        tileBytes = tileExtent.width * tileExtent.height * TEXEL_BYTES;
+        if (!tileCache.init(fs::path("cache") / "terrainTiles.bin", tileBytes, CACHE_CAPACITY)) {
+            spdlog::warn("Terrain tiles will not be cached");
+        }
+
+        uploadBuffer = resources->createBuffer(
+            tileBytes * CACHE_COPIES_PER_FRAME * FILL_SLOTS,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU,
+            VMA_ALLOCATION_CREATE_MAPPED_BIT,
+            "Terrain Cache Uploads"
+        ).value();
+
+        readbackBuffer = resources->createBuffer(
+            tileBytes * CACHE_COPIES_PER_FRAME * FILL_SLOTS,
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VMA_MEMORY_USAGE_GPU_TO_CPU,
+            VMA_ALLOCATION_CREATE_MAPPED_BIT,
+            "Terrain Cache Readbacks"
+        ).value();
+
+        heightReadbackBuffer = resources->createBuffer(
+            HEIGHT_READBACK_BYTES * HEIGHT_READBACKS_PER_FRAME * FILL_SLOTS,
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VMA_MEMORY_USAGE_GPU_TO_CPU,
+            VMA_ALLOCATION_CREATE_MAPPED_BIT,
+            "Terrain Height Readbacks"
+        ).value();
+
+        windowOrigin = glm::ivec2(-WINDOW_CHUNKS / 2);
+        perlinGeneratorPC = {};
+        perlinGeneratorPC.scale = 1;
+        perlinGeneratorPC.origin = glm::vec2(windowOrigin);
+        perlinGeneratorPC.worldChunks = static_cast<F32>(WINDOW_CHUNKS);
+        perlinGeneratorPC.octaves = DEFAULT_OCTAVES;
+
+        // Get Terrain Material, shared by every node. Camera, lights and the atmosphere for
+        // aerial perspective come from the global set.
+        terrainMaterial = resources->getMaterialManager()->getData("terrain", &pool, nullptr);
+
+        // Set 1: Terrain Data
+        terrainMaterial.descriptorSets[0].set.writeUniformBuffer(0, &terrainBuffer, 12, 0);
+
+        // Set 2: World Heightmap
+        terrainMaterial.descriptorSets[1].set.writeImageSampler(0, heightmap.getImage(), sampler);
     }
 
-    void Run() {
+    // projectionScale is pixels per unit of view space slope, half the screen height times proj[1][1]
+    void Run(glm::vec3 cameraPosition, F32 projectionScale) {
         ImGui::Begin("Terrain Settings");
 
         // Terrain scale & height scale controls
-        static float terrainScale = 128.0f;
-        static float heightScale = 0.50f;
         if (ImGui::SliderFloat("Terrain Scale", &terrainScale, 1.0f, 128.0f)) {
             // Update terrainScale in uniform buffer
             float* objectPtr = reinterpret_cast<float*>(terrainBuffer.info.pMappedData);
@@ -217,18 +339,35 @@ public:
 
         static float generationScale = 1.0f;
         static float generationSeed = 0.0f;
-        static int generationOctaves = 4.0f;
+        static int generationOctaves = DEFAULT_OCTAVES;
         if (ImGui::SliderFloat("Generation Scale", &generationScale, 0.0f, 20.0f, "%.1f") ||
             ImGui::SliderFloat("Generation Seed", &generationSeed, 0.0f, 1000.0f, "%.1f") ||
             ImGui::SliderInt("Generation Octaves", &generationOctaves, 0.0f, 10.0f)) {
 
-            for (int y = 0; y < GRID_SIZE; y++) {
-                for (int x = 0; x < GRID_SIZE; x++) {
-                    chunks[y][x].SetTerrainGenInfo(generationScale, generationSeed, generationOctaves);
-                }
-            }
+            perlinGeneratorPC.scale = generationScale;
+            perlinGeneratorPC.seed = generationSeed;
+            perlinGeneratorPC.octaves = generationOctaves;
+
+            heightmap.invalidate();
+            rootBounds.clear();
+        }
+
+        ImGui::SliderInt("Refills / Frame", &refillBudget, 1, MAX_REFILLS_PER_FRAME);
+        ImGui::SliderInt("View Radius", &radius, 1, MAX_RADIUS);
+        ImGui::SliderFloat("Max Pixel Error", &pixelError, 0.5f, 16.0f, "%.1f");
+
+        U32 triangles = 0;
+        for (const TerrainNode& node : nodes) {
+            triangles += (node.quadrant ? quadrantIndexCount : nodeIndexCount) / 3;
         }
 
+        ImGui::Text("Camera Chunk: %d, %d", cameraChunk.x, cameraChunk.y);
+        ImGui::Text("Nodes: %zu, Triangles: %u", nodes.size(), triangles);
+        ImGui::Text("Resident Tiles: %zu / %u", heightmap.getResidentTiles(), MAX_RESIDENT_TILES);
+        ImGui::Text("Pending Fills: %zu", heightmap.getPendingFills());
+        ImGui::Text("Cached Tiles: %zu / %u, Uploaded: %u", tileCache.getCachedTiles(), CACHE_CAPACITY, cachedUploads);
+        ImGui::Text("Height Queries: %zu, Queued Points: %zu", heightQueries.size(), queuedHeights.size());
+
         ImGui::End();
 
         // Update the terrain buffer manually (in case sliders didn't trigger)
@@ -236,47 +375,618 @@ public:
         objectPtr[0] = terrainScale;
         objectPtr[1] = heightScale;
 
-        for (int y = 0; y < GRID_SIZE; y++) {
-            for (int x = 0; x < GRID_SIZE; x++) {
-                ImGui::PushID(y * GRID_SIZE + x);
-                chunks[y][x].Run();
-                ImGui::PopID();
+        // Chunks are centred on their coordinate
+        glm::vec2 cameraCell = glm::vec2(cameraPosition) / terrainScale + 0.5f;
+        cameraChunk = glm::ivec2(glm::floor(cameraCell));
+        moveWindow(cameraChunk - glm::ivec2(WINDOW_CHUNKS / 2));
+
+        // Chunk c lives at texel ringSlot(c) * RESOLUTION, refills start around it
+        glm::ivec2 texel = glm::ivec2(glm::mod(cameraCell, F32(WINDOW_CHUNKS)) * F32(RESOLUTION));
+        cameraTexel = {texel.x, texel.y};
+
+        selectNodes(cameraPosition, projectionScale);
+    }
+
+    void selectNodes(glm::vec3 cameraPosition, F32 projectionScale) {
+        // Distance where a level's quads shrink under pixelError on screen, kept wide enough to morph across a node
+        F32 previous = 0.0f;
+        for (I32 level = 0; level <= MAX_LEVEL; level++) {
+            F32 worldSize = nodeSize(level) * terrainScale;
+            F32 range = worldSize / NODE_GRID * projectionScale / pixelError;
+            lodRanges[level] = std::max({range, worldSize * 2.0f, previous * 2.0f});
+            previous = lodRanges[level];
+        }
+
+        nodes.clear();
+        for (auto& [key, bounds] : rootBounds) {
+            bounds.used = false;
+        }
+
+        glm::vec2 cameraCell = glm::vec2(cameraPosition) / terrainScale + 0.5f;
+        glm::ivec2 first = glm::ivec2(glm::floor((cameraCell - F32(radius)) / F32(ROOT_SIZE)));
+        glm::ivec2 last = glm::ivec2(glm::floor((cameraCell + F32(radius)) / F32(ROOT_SIZE)));
+
+        for (I32 y = first.y; y <= last.y; y++) {
+            for (I32 x = first.x; x <= last.x; x++) {
+                glm::vec2 corner = glm::vec2(x, y) * F32(ROOT_SIZE);
+                glm::vec2 closest = glm::clamp(cameraCell, corner, corner + F32(ROOT_SIZE));
+                if (glm::distance(closest, cameraCell) > F32(radius)) continue;
+
+                // Roots past every range are still drawn, at the coarsest level
+                if (!selectNode(corner, MAX_LEVEL, cameraPosition)) {
+                    addNode(corner, MAX_LEVEL, false);
+                }
+            }
+        }
+
+        std::erase_if(rootBounds, [](const auto& entry) { return !entry.second.used; });
+    }
+
+    bool selectNode(glm::vec2 corner, I32 level, glm::vec3 cameraPosition) {
+        F32 size = nodeSize(level);
+        if (!nodeInRange(corner, level, lodRanges[level], cameraPosition)) return false;
+
+        if (level == 0 || !nodeInRange(corner, level, lodRanges[level - 1], cameraPosition)) {
+            addNode(corner, level, false);
+            return true;
+        }
+
+        // Children out of their own range keep this level over their quadrant
+        F32 half = size * 0.5f;
+        for (I32 child = 0; child < 4; child++) {
+            glm::vec2 childCorner = corner + glm::vec2(child & 1, child >> 1) * half;
+            if (!selectNode(childCorner, level - 1, cameraPosition)) {
+                addNode(childCorner, level, true);
+            }
+        }
+
+        return true;
+    }
+
+    bool nodeInRange(glm::vec2 corner, I32 level, F32 range, glm::vec3 cameraPosition) {
+        // Same displacement as the terrain vertex shader
+        F32 size = nodeSize(level);
+        F32 verticalScale = heightScale * terrainScale;
+        glm::vec2 heights = nodeHeights(corner, level);
+        glm::vec3 minimum = glm::vec3((corner - 0.5f) * terrainScale, verticalScale * (heights.x - 0.5f));
+        glm::vec3 maximum = glm::vec3((corner + size - 0.5f) * terrainScale, verticalScale * (heights.y - 0.5f));
+
+        glm::vec3 closest = glm::clamp(cameraPosition, minimum, maximum);
+        return glm::distance(closest, cameraPosition) <= range;
+    }
+
+    // Unscaled min and max height under a node, its root's bounds are generated on first use
+    glm::vec2 nodeHeights(glm::vec2 corner, I32 level) {
+        glm::ivec2 root = glm::ivec2(glm::floor(corner / F32(ROOT_SIZE)));
+        const RootBounds& bounds = getRootBounds(root);
+
+        I32 nodesPerSide = 1 << (MAX_LEVEL - level);
+        glm::ivec2 index = glm::ivec2((corner - glm::vec2(root * ROOT_SIZE)) / nodeSize(level));
+        index = glm::clamp(index, glm::ivec2(0), glm::ivec2(nodesPerSide - 1));
+        return bounds.levels[level][index.y * nodesPerSide + index.x];
+    }
+
+    const RootBounds& getRootBounds(glm::ivec2 root) {
+        U64 key = (static_cast<U64>(static_cast<U32>(root.x)) << 32) | static_cast<U32>(root.y);
+        auto it = rootBounds.find(key);
+        if (it != rootBounds.end()) {
+            it->second.used = true;
+            return it->second;
+        }
+
+        constexpr U32 LEAVES = 1u << MAX_LEVEL;
+        constexpr U32 SAMPLES = LEAVES * LEAF_BOUNDS_SAMPLES + 1;
+        std::vector<F32> heights(SAMPLES * SAMPLES);
+        TerrainNoise::heightGrid({
+            .originX = F32(root.x * ROOT_SIZE),
+            .originY = F32(root.y * ROOT_SIZE),
+            .step = LEAF_SIZE / LEAF_BOUNDS_SAMPLES,
+            .width = SAMPLES,
+            .height = SAMPLES,
+        }, noiseSettings(), heights);
+
+        RootBounds bounds = {.levels = {}, .used = true};
+
+        // Leaves share their edge samples with their neighbours
+        bounds.levels[0].resize(LEAVES * LEAVES);
+        for (U32 leafY = 0; leafY < LEAVES; leafY++) {
+            for (U32 leafX = 0; leafX < LEAVES; leafX++) {
+                glm::vec2 range = glm::vec2(1e30f, -1e30f);
+                for (U32 y = leafY * LEAF_BOUNDS_SAMPLES; y <= (leafY + 1) * LEAF_BOUNDS_SAMPLES; y++) {
+                    for (U32 x = leafX * LEAF_BOUNDS_SAMPLES; x <= (leafX + 1) * LEAF_BOUNDS_SAMPLES; x++) {
+                        F32 height = heights[y * SAMPLES + x];
+                        range = {std::min(range.x, height), std::max(range.y, height)};
+                    }
+                }
+                bounds.levels[0][leafY * LEAVES + leafX] = range + glm::vec2(-BOUNDS_MARGIN, BOUNDS_MARGIN);
             }
         }
+
+        for (I32 level = 1; level <= MAX_LEVEL; level++) {
+            U32 side = 1u << (MAX_LEVEL - level);
+            const std::vector<glm::vec2>& children = bounds.levels[level - 1];
+            bounds.levels[level].resize(side * side);
+
+            for (U32 y = 0; y < side; y++) {
+                for (U32 x = 0; x < side; x++) {
+                    glm::vec2 range = children[(2 * y) * (2 * side) + 2 * x];
+                    for (U32 child = 1; child < 4; child++) {
+                        glm::vec2 other = children[(2 * y + (child >> 1)) * (2 * side) + 2 * x + (child & 1)];
+                        range = {std::min(range.x, other.x), std::max(range.y, other.y)};
+                    }
+                    bounds.levels[level][y * side + x] = range;
+                }
+            }
+        }
+
+        return rootBounds[key] = std::move(bounds);
+    }
+
+    void addNode(glm::vec2 corner, I32 level, bool quadrant) {
+        F32 previous = level > 0 ? lodRanges[level - 1] : 0.0f;
+        glm::vec2 morphRange = level == MAX_LEVEL
+            ? glm::vec2(NO_MORPH)
+            : glm::vec2(previous + (lodRanges[level] - previous) * MORPH_START, lodRanges[level]);
+
+        nodes.push_back({
+            .terrainNodePC = {
+                .offset = corner - 0.5f,
+                .size = quadrant ? nodeSize(level - 1) : nodeSize(level),
+                .gridSize = static_cast<F32>(quadrant ? NODE_GRID / 2 : NODE_GRID),
+                .morphRange = morphRange,
+                .heightmapInfo = 0,
+                .heightmapFeedback = 0,
+            },
+            .quadrant = quadrant,
+        });
+    }
+
+    // Ring slots of the chunks leaving the window are regenerated for the chunks entering it
+    void moveWindow(glm::ivec2 origin) {
+        glm::ivec2 shift = origin - windowOrigin;
+        if (shift == glm::ivec2(0)) return;
+
+        invalidateSlots(std::min(origin.x, windowOrigin.x), std::abs(shift.x), true);
+        invalidateSlots(std::min(origin.y, windowOrigin.y), std::abs(shift.y), false);
+
+        windowOrigin = origin;
+        perlinGeneratorPC.origin = glm::vec2(windowOrigin);
+    }
+
+    void invalidateSlots(I32 first, I32 count, bool columns) {
+        if (count >= WINDOW_CHUNKS) {
+            heightmap.invalidate();
+            return;
+        }
+
+        for (I32 i = 0; i < count; i++) {
+            I32 slot = ringSlot(first + i) * RESOLUTION;
+            VkRect2D region = columns
+                ? VkRect2D{.offset = {slot, 0}, .extent = {RESOLUTION, HEIGHTMAP_SIZE}}
+                : VkRect2D{.offset = {0, slot}, .extent = {HEIGHTMAP_SIZE, RESOLUTION}};
+            heightmap.invalidateRegion(region);
+        }
     }
 
-    RenderObject getRenderObject() {
+    RenderObject getRenderObject(U32 geometry, U32 indexCount) {
+        GeometryRange range = geometryPool->getRange(geometry);
+
         return {
             .indexCount = indexCount,
-            .startIndex = indexStart,
-            .indexBuffer = &indexBuffer,
-            .vertexBuffer = &vertexBuffer,
+            .startIndex = range.firstIndex,
+            .vertexOffset = range.vertexOffset,
+            .indexBuffer = geometryPool->getIndexBuffer(),
+            .vertexBuffer = nullptr,
             .material = nullptr,
             .pushConstantData = nullptr,
         };
     }
 
     void Draw(RenderEngine* graphics) {
-        for (int y = 0; y < GRID_SIZE; y++) {
-            for (int x = 0; x < GRID_SIZE; x++) {
-                RenderObject obj = getRenderObject();
-                chunks[y][x].Draw(graphics, obj);
+        // Stream heightmap tiles from last frames' feedback and generate the new ones
+        heightmap.update(TILES_PER_FRAME);
+
+        // Every slot was last used FILL_SLOTS frames ago, so its readbacks have landed
+        Size slot = fillSlot;
+        fillSlot = (fillSlot + 1) % FILL_SLOTS;
+        storeReadbacks(slot);
+        resolveHeightReadbacks(slot);
+
+        std::vector<VirtualTile> tiles = heightmap.takeFillRequests(static_cast<U32>(refillBudget), cameraTexel);
+        std::vector<VirtualTile> misses = uploadCachedTiles(graphics, slot, tiles);
+        if (!misses.empty()) {
+            dispatchFills(graphics, slot, misses);
+        }
+
+        // After the fills, so freshly generated tiles can already be read
+        scheduleHeights(graphics, slot);
+
+        RenderObject nodeObject = getRenderObject(nodeGeometry, nodeIndexCount);
+        RenderObject quadrantObject = getRenderObject(quadrantGeometry, quadrantIndexCount);
+        nodeObject.material = &terrainMaterial;
+        quadrantObject.material = &terrainMaterial;
+
+        nodeObjects.clear();
+        for (TerrainNode& node : nodes) {
+            node.terrainNodePC.heightmapInfo = heightmap.getInfoAddress();
+            node.terrainNodePC.heightmapFeedback = heightmap.getFeedbackAddress();
+
+            RenderObject obj = node.quadrant ? quadrantObject : nodeObject;
+            obj.pushConstantData = &node.terrainNodePC;
+            nodeObjects.push_back(obj);
+        }
+
+        graphics->renderObjects(0, nodeObjects);
+    }
+
+    // Everything a cached tile depends on, none for tiles the window's seam runs through
+    Option<TileKey> cacheKey(const VirtualTile& tile) const {
+        VkExtent2D tileExtent = heightmap.getTileExtent();
+        if (tile.mipLevel >= heightmap.getMipTailFirstLod() ||
+                tile.region.extent.width != tileExtent.width ||
+                tile.region.extent.height != tileExtent.height) {
+            return std::nullopt;
+        }
+
+        // Mip 0 texels and the chunk slots they fall in
+        glm::ivec2 texel = glm::ivec2(tile.region.offset.x, tile.region.offset.y) << I32(tile.mipLevel);
+        glm::ivec2 extent = glm::ivec2(tileExtent.width, tileExtent.height) << I32(tile.mipLevel);
+        glm::ivec2 first = texel / I32(RESOLUTION);
+        glm::ivec2 last = (texel + extent - 1) / I32(RESOLUTION);
+
+        // Slots past the seam hold the far side of the window
+        glm::ivec2 seam = {ringSlot(windowOrigin.x), ringSlot(windowOrigin.y)};
+        if ((seam.x > first.x && seam.x <= last.x) || (seam.y > first.y && seam.y <= last.y)) {
+            return std::nullopt;
+        }
+
+        glm::ivec2 chunk = {slotChunk(first.x, windowOrigin.x), slotChunk(first.y, windowOrigin.y)};
+        glm::ivec2 world = chunk * I32(RESOLUTION) + texel % I32(RESOLUTION);
+
+        return tileKey(world, tile.mipLevel);
+    }
+
+    // world is the tile's first texel, in mip 0 texels
+    TileKey tileKey(glm::ivec2 world, U32 mipLevel) const {
+        return {
+            .seed = perlinGeneratorPC.seed,
+            .scale = perlinGeneratorPC.scale,
+            .octaves = static_cast<I32>(perlinGeneratorPC.octaves),
+            .resolution = RESOLUTION,
+            .x = world.x,
+            .y = world.y,
+            .mipLevel = mipLevel,
+            .format = HEIGHTMAP_FORMAT,
+        };
+    }
+
+    static VkBufferImageCopy tileCopy(const VirtualTile& tile, Size bufferOffset) {
+        return {
+            .bufferOffset = bufferOffset,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = tile.mipLevel,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+            .imageOffset = {tile.region.offset.x, tile.region.offset.y, 0},
+            .imageExtent = {tile.region.extent.width, tile.region.extent.height, 1},
+        };
+    }
+
+    void storeReadbacks(Size slot) {
+        if (pendingReadbacks[slot].empty()) return;
+
+        readbackBuffer.invalidate();
+        const U8* data = static_cast<const U8*>(readbackBuffer.info.pMappedData);
+        for (const PendingReadback& readback : pendingReadbacks[slot]) {
+            tileCache.insert(readback.key, data + readback.offset);
+        }
+
+        pendingReadbacks[slot].clear();
+    }
+
+    // Returns the tiles that still need generating
+    std::vector<VirtualTile> uploadCachedTiles(RenderEngine* graphics, Size slot, const std::vector<VirtualTile>& tiles) {
+        Size slotOffset = slot * tileBytes * CACHE_COPIES_PER_FRAME;
+        ImageCopyObject upload = {.image = heightmap.getImage(), .buffer = &uploadBuffer, .regions = {}};
+
+        std::vector<VirtualTile> misses;
+        for (const VirtualTile& tile : tiles) {
+            const U8* cached = nullptr;
+            if (upload.regions.size() < CACHE_COPIES_PER_FRAME) {
+                Option<TileKey> key = cacheKey(tile);
+                if (key.has_value()) cached = tileCache.find(key.value());
+            }
+
+            if (cached == nullptr) {
+                misses.push_back(tile);
+                continue;
+            }
+
+            Size offset = slotOffset + upload.regions.size() * tileBytes;
+            std::memcpy(static_cast<U8*>(uploadBuffer.info.pMappedData) + offset, cached, tileBytes);
+            upload.regions.push_back(tileCopy(tile, offset));
+        }
+
+        if (!upload.regions.empty()) {
+            cachedUploads += static_cast<U32>(upload.regions.size());
+            graphics->uploadImageRegions({upload});
+        }
+
+        return misses;
+    }
+
+    void dispatchFills(RenderEngine* graphics, Size slot, const std::vector<VirtualTile>& tiles) {
+        Size slotOffset = slot * sizeof(GeneratorTile) * MAX_FILLS_PER_FRAME;
+
+        GeneratorTile* fills = reinterpret_cast<GeneratorTile*>(
+            static_cast<U8*>(fillBuffer.info.pMappedData) + slotOffset);
+
+        U32 count = std::min(static_cast<U32>(tiles.size()), MAX_FILLS_PER_FRAME);
+        U32 maxWidth = 0, maxHeight = 0;
+        for (U32 i = 0; i < count; i++) {
+            const VirtualTile& tile = tiles[i];
+            fills[i] = {
+                .mipLevel = tile.mipLevel,
+                ._pad0 = 0,
+                .offsetX = tile.region.offset.x,
+                .offsetY = tile.region.offset.y,
+                .width = tile.region.extent.width,
+                .height = tile.region.extent.height,
+                .mipWidth = std::max(HEIGHTMAP_SIZE >> tile.mipLevel, 1u),
+                .mipHeight = std::max(HEIGHTMAP_SIZE >> tile.mipLevel, 1u),
+            };
+
+            maxWidth = std::max(maxWidth, tile.region.extent.width);
+            maxHeight = std::max(maxHeight, tile.region.extent.height);
+        }
+
+        perlinGeneratorPC.tiles = fillBuffer.getAddress() + slotOffset;
+
+        // Read back what the cache can take, stored once this slot comes around again
+        Size readbackOffset = slot * tileBytes * CACHE_COPIES_PER_FRAME;
+        ImageCopyObject readback = {.image = heightmap.getImage(), .buffer = &readbackBuffer, .regions = {}};
+        for (U32 i = 0; i < count && readback.regions.size() < CACHE_COPIES_PER_FRAME; i++) {
+            Option<TileKey> key = cacheKey(tiles[i]);
+            if (!key.has_value()) continue;
+
+            Size offset = readbackOffset + readback.regions.size() * tileBytes;
+            readback.regions.push_back(tileCopy(tiles[i], offset));
+            pendingReadbacks[slot].push_back({key.value(), offset});
+        }
+
+        if (!readback.regions.empty()) {
+            graphics->readbackImageRegions({readback});
+        }
+
+        // Tiles along z, workgroups past a smaller tile's extent exit early
+        graphics->dispatchComputeObjects({{
+            .material = static_cast<I32>(perlinGeneratorPC.octaves) == DEFAULT_OCTAVES ? &fixedOctaveGenerator : &perlinGenerator,
+            .pushConstantData = &perlinGeneratorPC,
+            .groupCountX = (maxWidth + GENERATOR_GROUP_SIZE - 1) / GENERATOR_GROUP_SIZE,
+            .groupCountY = (maxHeight + GENERATOR_GROUP_SIZE - 1) / GENERATOR_GROUP_SIZE,
+            .groupCountZ = count,
+            .storageImages = {heightmap.getImage()},
+        }});
+    }
+
+    // Terrain heights under world positions, in world units once takeHeights returns them.
+    // Never waits on the GPU, points the tile cache can't answer resolve over the next frames.
+    U64 queryHeights(std::span<const glm::vec2> positions) {
+        U64 query = nextHeightQuery++;
+        HeightQuery& batch = heightQueries[query];
+        batch.texels.reserve(positions.size());
+        batch.heights.assign(positions.size(), 0.0f);
+        batch.unresolved = 0;
+
+        for (U32 i = 0; i < positions.size(); i++) {
+            // Chunks are centred on their coordinate, chunk c starts at texel c * RESOLUTION
+            glm::vec2 texel = (positions[i] / terrainScale + 0.5f) * F32(RESOLUTION);
+            batch.texels.push_back(texel);
+
+            Option<F32> cached = cachedHeight(texel);
+            if (cached.has_value()) {
+                batch.heights[i] = cached.value();
+            } else {
+                queuedHeights.push_back({query, i});
+                batch.unresolved++;
             }
         }
+
+        return query;
+    }
+
+    // None until every point of the query has resolved, heights are in query order
+    Option<std::vector<F32>> takeHeights(U64 query) {
+        auto it = heightQueries.find(query);
+        if (it == heightQueries.end() || it->second.unresolved > 0) return std::nullopt;
+
+        // Same displacement as the terrain vertex shader
+        F32 verticalScale = heightScale * terrainScale;
+        std::vector<F32> heights = std::move(it->second.heights);
+        for (F32& height : heights) {
+            height = verticalScale * (height - 0.5f);
+        }
+
+        heightQueries.erase(it);
+        return heights;
+    }
+
+    static F32 unpackHeight(U16 value) {
+        return static_cast<F32>(value) / 65535.0f * HEIGHT_RANGE;
+    }
+
+    // Linear across the texels around a point, like the terrain mesh between its vertices
+    static F32 bilinear(glm::vec2 texel, const std::array<F32, 4>& corners) {
+        glm::vec2 f = texel - glm::floor(texel);
+        return glm::mix(glm::mix(corners[0], corners[1], f.x), glm::mix(corners[2], corners[3], f.x), f.y);
+    }
+
+    void resolveHeight(U64 query, U32 index, F32 height) {
+        HeightQuery& batch = heightQueries[query];
+        batch.heights[index] = height;
+        batch.unresolved--;
+    }
+
+    // Cached mip 0 tiles are aligned to the tile extent in world texels
+    Option<F32> cachedHeight(glm::vec2 texel) const {
+        VkExtent2D tileExtent = heightmap.getTileExtent();
+        glm::ivec2 extent = glm::ivec2(tileExtent.width, tileExtent.height);
+        glm::ivec2 first = glm::ivec2(glm::floor(texel));
+
+        std::array<F32, 4> corners;
+        for (U32 corner = 0; corner < 4; corner++) {
+            glm::ivec2 world = first + glm::ivec2(corner & 1, corner >> 1);
+            glm::ivec2 local = {wrap(world.x, extent.x), wrap(world.y, extent.y)};
+
+            const U8* tile = tileCache.find(tileKey(world - local, 0));
+            if (tile == nullptr) return std::nullopt;
+
+            U16 value;
+            std::memcpy(&value, tile + (local.y * extent.x + local.x) * TEXEL_BYTES, sizeof(U16));
+            corners[corner] = unpackHeight(value);
+        }
+
+        return bilinear(texel, corners);
+    }
+
+    // The point's first heightmap texel when all four around it are inside the window and filled
+    Option<glm::ivec2> residentTexel(glm::vec2 texel) const {
+        VkExtent2D tileExtent = heightmap.getTileExtent();
+        glm::ivec2 first = glm::ivec2(glm::floor(texel));
+        glm::ivec2 heightmapTexel = {wrap(first.x, HEIGHTMAP_SIZE), wrap(first.y, HEIGHTMAP_SIZE)};
+
+        // One copy region, so the 2x2 block can't wrap around the heightmap's edge
+        if (heightmapTexel.x + 1 >= I32(HEIGHTMAP_SIZE) || heightmapTexel.y + 1 >= I32(HEIGHTMAP_SIZE)) {
+            return std::nullopt;
+        }
+
+        for (U32 corner = 0; corner < 4; corner++) {
+            glm::ivec2 offset = glm::ivec2(corner & 1, corner >> 1);
+
+            glm::ivec2 chunk = glm::ivec2(glm::floor(glm::vec2(first + offset) / F32(RESOLUTION)));
+            if (glm::any(glm::lessThan(chunk, windowOrigin)) ||
+                    glm::any(glm::greaterThanEqual(chunk, windowOrigin + WINDOW_CHUNKS))) {
+                return std::nullopt;
+            }
+
+            glm::ivec2 tile = (heightmapTexel + offset) / glm::ivec2(tileExtent.width, tileExtent.height);
+            if (!heightmap.isTileFilled(tile.x, tile.y, 0)) return std::nullopt;
+        }
+
+        return heightmapTexel;
+    }
+
+    void resolveHeightReadbacks(Size slot) {
+        if (pendingHeights[slot].empty()) return;
+
+        heightReadbackBuffer.invalidate();
+        const U8* data = static_cast<const U8*>(heightReadbackBuffer.info.pMappedData);
+
+        for (const PendingHeight& pending : pendingHeights[slot]) {
+            std::array<U16, 4> values;
+            std::memcpy(values.data(), data + pending.offset, HEIGHT_READBACK_BYTES);
+
+            glm::vec2 texel = heightQueries[pending.query].texels[pending.index];
+            std::array<F32, 4> corners;
+            for (U32 corner = 0; corner < 4; corner++) {
+                corners[corner] = unpackHeight(values[corner]);
+            }
+
+            resolveHeight(pending.query, pending.index, bilinear(texel, corners));
+        }
+
+        pendingHeights[slot].clear();
+    }
+
+    TerrainNoise::Settings noiseSettings() const {
+        return {
+            .scale = perlinGeneratorPC.scale,
+            .seed = perlinGeneratorPC.seed,
+            .octaves = static_cast<I32>(perlinGeneratorPC.octaves),
+        };
+    }
+
+    void scheduleHeights(RenderEngine* graphics, Size slot) {
+        if (queuedHeights.empty()) return;
+
+        Size slotOffset = slot * HEIGHT_READBACK_BYTES * HEIGHT_READBACKS_PER_FRAME;
+        ImageCopyObject readback = {.image = heightmap.getImage(), .buffer = &heightReadbackBuffer, .regions = {}};
+
+        std::vector<QueuedHeight> generated;
+        std::vector<F32> cellX, cellY;
+
+        Size scheduled = 0;
+        for (; scheduled < queuedHeights.size() && readback.regions.size() < HEIGHT_READBACKS_PER_FRAME; scheduled++) {
+            const QueuedHeight& queued = queuedHeights[scheduled];
+            glm::vec2 texel = heightQueries[queued.query].texels[queued.index];
+
+            Option<glm::ivec2> first = residentTexel(texel);
+            if (!first.has_value()) {
+                // Texel i holds the noise at the centre of its cell
+                generated.push_back(queued);
+                cellX.push_back((texel.x + 0.5f) / F32(RESOLUTION));
+                cellY.push_back((texel.y + 0.5f) / F32(RESOLUTION));
+                continue;
+            }
+
+            Size offset = slotOffset + readback.regions.size() * HEIGHT_READBACK_BYTES;
+            readback.regions.push_back({
+                .bufferOffset = offset,
+                .bufferRowLength = 0,
+                .bufferImageHeight = 0,
+                .imageSubresource = {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel = 0,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+                .imageOffset = {first->x, first->y, 0},
+                .imageExtent = {2, 2, 1},
+            });
+            pendingHeights[slot].push_back({queued.query, queued.index, offset});
+        }
+
+        queuedHeights.erase(queuedHeights.begin(), queuedHeights.begin() + scheduled);
+
+        if (!readback.regions.empty()) {
+            graphics->readbackImageRegions({readback});
+        }
+
+        if (generated.empty()) return;
+
+        std::vector<F32> heights(generated.size());
+        TerrainNoise::heightBatch(cellX.data(), cellY.data(), heights.data(), heights.size(), noiseSettings());
+        for (Size i = 0; i < generated.size(); i++) {
+            resolveHeight(generated[i].query, generated[i].index, heights[i]);
+        }
     }
 
     void Cleanup() {
+        heightmap.shutdown();
+        heightReadbackBuffer.shutdown();
+        fillBuffer.shutdown();
+        uploadBuffer.shutdown();
+        readbackBuffer.shutdown();
+        tileCache.shutdown();
         terrainBuffer.shutdown();
-        vertexBuffer.shutdown();
-        indexBuffer.shutdown();
+        geometryPool->free(nodeGeometry);
+        geometryPool->free(quadrantGeometry);
 
         pool.destroyPools();
         sampler.shutdown();
 
-        for (int y = 0; y < GRID_SIZE; y++) {
-            for (int x = 0; x < GRID_SIZE; x++) {
-                chunks[y][x].Cleanup();
-            }
+        nodes.clear();
+        nodeObjects.clear();
+
+        rootBounds.clear();
+        heightQueries.clear();
+        queuedHeights.clear();
+        for (std::vector<PendingHeight>& pending : pendingHeights) {
+            pending.clear();
         }
     }
 };
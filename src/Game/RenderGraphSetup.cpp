@@ -6,14 +6,18 @@
 #include "RenderEngine/Config.hpp"
 #include "RenderEngine/Debug.hpp"
 #include "RenderEngine/FrameSubmitInfo.hpp"
+#include "RenderEngine/RenderObjects/ComputeRenderObject.hpp"
+#include "RenderEngine/RenderObjects/ImageCopyObject.hpp"
+#include "RenderEngine/RenderObjects/RasterState.hpp"
 #include "RenderEngine/RenderObjects/TextureRenderObject.hpp"
 #include "imgui_impl_vulkan.h"
 #include <RenderEngine/CommandSubmitter.hpp>
 
+#include <algorithm>
 #include <memory>
 #include <vulkan/vulkan.h>
 
-std::shared_ptr<RenderGraph> setupRenderGraph() {
+std::shared_ptr<RenderGraph> setupRenderGraph(GlobalDescriptors global) {
     auto renderGraph = std::make_shared<RenderGraph>();
 
     VkImageUsageFlags commonFlags = 0;
@@ -39,18 +43,188 @@ std::shared_ptr<RenderGraph> setupRenderGraph() {
         "Final Draw"
     );
 
-    Size textureTargetsPass = renderGraph->createNode("Texture Targets", [](RecordInfo recordInfo) {
+    Size computeTargetsPass = renderGraph->createNode("Compute Targets", [](RecordInfo recordInfo) {
+        std::vector<ComputeRenderObject>& computeTargets = recordInfo.renderContext->computeTargets;
+        std::vector<ImageCopyObject>& uploads = recordInfo.renderContext->imageUploads;
+        std::vector<ImageCopyObject>& readbacks = recordInfo.renderContext->imageReadbacks;
+        if (computeTargets.empty() && uploads.empty() && readbacks.empty()) return;
+
+        Debug::SetCmdLabel(recordInfo.commandBuffer, {0.2f, 0.7f, 0.7f}, "Compute Targets Pass");
+
+        // Everything touched here stays in GENERAL until the end of the pass
+        std::vector<Image*> images;
+        for (ComputeRenderObject& computeTarget : computeTargets) {
+            images.insert(images.end(), computeTarget.storageImages.begin(), computeTarget.storageImages.end());
+        }
+        for (ImageCopyObject& copy : uploads) images.push_back(copy.image);
+        for (ImageCopyObject& copy : readbacks) images.push_back(copy.image);
+
+        for (Image* image : images) {
+            if (image->layout != VK_IMAGE_LAYOUT_GENERAL) {
+                recordInfo.commandSubmitter->transitionImage(
+                    recordInfo.commandBuffer,
+                    image,
+                    VK_IMAGE_LAYOUT_GENERAL
+                );
+            }
+        }
+
+        // Uploads and dispatches write disjoint regions, so only the readbacks wait
+        for (ImageCopyObject& upload : uploads) {
+            vkCmdCopyBufferToImage(
+                recordInfo.commandBuffer,
+                upload.buffer->buffer,
+                upload.image->image,
+                VK_IMAGE_LAYOUT_GENERAL,
+                static_cast<U32>(upload.regions.size()),
+                upload.regions.data()
+            );
+        }
+
+        for (ComputeRenderObject& computeTarget : computeTargets) {
+            if (computeTarget.material->pipeline->pipeline == nullptr) continue;
+
+            if (computeTarget.dependsOnPrevious) {
+                VkMemoryBarrier2 written = {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+                    .pNext = nullptr,
+                    .srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                    .srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                    .dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                    .dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                };
+
+                VkDependencyInfo dependency = {
+                    .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                    .pNext = nullptr,
+                    .memoryBarrierCount = 1,
+                    .pMemoryBarriers = &written,
+                };
+                vkCmdPipelineBarrier2(recordInfo.commandBuffer, &dependency);
+            }
+
+            MaterialData* material = computeTarget.material;
+            vkCmdBindPipeline(
+                recordInfo.commandBuffer,
+                VK_PIPELINE_BIND_POINT_COMPUTE,
+                material->pipeline->pipeline
+            );
+
+            for (Size setIndex = 0; setIndex < material->descriptorSets.size(); setIndex++) {
+                DescriptorSetData setData = material->descriptorSets[setIndex];
+
+                setData.set.bindBuffer(
+                    recordInfo.commandBuffer,
+                    VK_PIPELINE_BIND_POINT_COMPUTE,
+                    material->pipeline->pipelineLayout,
+                    setData.setIndex
+                );
+            }
+
+            if (material->pipeline->pushConstants.enabled) {
+                vkCmdPushConstants(
+                    recordInfo.commandBuffer,
+                    material->pipeline->pipelineLayout,
+                    material->pipeline->pushConstants.stages,
+                    material->pipeline->pushConstants.offset,
+                    material->pipeline->pushConstants.size,
+                    computeTarget.pushConstantData
+                );
+            }
+
+            vkCmdDispatch(
+                recordInfo.commandBuffer,
+                computeTarget.groupCountX,
+                computeTarget.groupCountY,
+                computeTarget.groupCountZ
+            );
+        }
+
+        if (!readbacks.empty()) {
+            VkMemoryBarrier2 generated = {
+                .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+                .pNext = nullptr,
+                .srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                .srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                .dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                .dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT,
+            };
+
+            VkDependencyInfo dependency = {
+                .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                .pNext = nullptr,
+                .memoryBarrierCount = 1,
+                .pMemoryBarriers = &generated,
+            };
+            vkCmdPipelineBarrier2(recordInfo.commandBuffer, &dependency);
+
+            for (ImageCopyObject& readback : readbacks) {
+                vkCmdCopyImageToBuffer(
+                    recordInfo.commandBuffer,
+                    readback.image->image,
+                    VK_IMAGE_LAYOUT_GENERAL,
+                    readback.buffer->buffer,
+                    static_cast<U32>(readback.regions.size()),
+                    readback.regions.data()
+                );
+            }
+
+            // Read on the host once the frame's fence has signalled
+            VkMemoryBarrier2 hostRead = {
+                .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+                .pNext = nullptr,
+                .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                .dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT,
+                .dstAccessMask = VK_ACCESS_2_HOST_READ_BIT,
+            };
+            dependency.pMemoryBarriers = &hostRead;
+            vkCmdPipelineBarrier2(recordInfo.commandBuffer, &dependency);
+        }
+
+        // Back to sampling once every dispatch and copy touching them is recorded
+        for (Image* image : images) {
+            if (image->layout == VK_IMAGE_LAYOUT_GENERAL) {
+                recordInfo.commandSubmitter->transitionImage(
+                    recordInfo.commandBuffer,
+                    image,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+                );
+            }
+        }
+
+        Debug::RemoveCmdLabel(recordInfo.commandBuffer);
+    }, {});
+
+    // Virtual texture tiles are bound on the sparse queue right before they are generated
+    renderGraph->addSparseInput(computeTargetsPass);
+
+    Size textureTargetsPass = renderGraph->createNode("Texture Targets", [global](RecordInfo recordInfo) {
         std::vector<TextureRenderObject>& textureTargets = recordInfo.renderContext->textureTargets;
 
+        // Bound once for every target, set 0 survives pipeline changes between them
+        global.set.bindBuffer(recordInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, global.layout, 0);
+
         for (Size i = 0; i < textureTargets.size(); i++) {
             TextureRenderObject* textureTarget = &textureTargets[i];
             Image* targetImage = textureTarget->texture;
 
-            recordInfo.commandSubmitter->transitionImage(
-                recordInfo.commandBuffer,
-                targetImage,
-                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-            );
+            // Consecutive targets into the same image (tiles, layers) share one transition
+            if (targetImage->layout != VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) {
+                recordInfo.commandSubmitter->transitionImage(
+                    recordInfo.commandBuffer,
+                    targetImage,
+                    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+                );
+            }
+
+            VkExtent2D levelExtent = {
+                std::max(targetImage->size.value.x >> textureTarget->mipLevel, 1u),
+                std::max(targetImage->size.value.y >> textureTarget->mipLevel, 1u),
+            };
+
+            bool partial = textureTarget->region.extent.width != 0 && textureTarget->region.extent.height != 0;
+            VkRect2D renderArea = partial ? textureTarget->region : VkRect2D{.offset = {0, 0}, .extent = levelExtent};
 
             VkRenderingAttachmentInfo colorAttachment = {
                 .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
@@ -60,7 +234,7 @@ std::shared_ptr<RenderGraph> setupRenderGraph() {
                 .resolveMode = VK_RESOLVE_MODE_NONE,
                 .resolveImageView = nullptr,
                 .resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                .loadOp = partial ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR,
                 .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
                 .clearValue = {.color = {{0.0f, 0.0f, 0.0f, 0.0f}}},
             };
@@ -69,7 +243,7 @@ std::shared_ptr<RenderGraph> setupRenderGraph() {
                 .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
                 .pNext = nullptr,
                 .flags = 0,
-                .renderArea = {.offset = {0, 0}, .extent = targetImage->size},
+                .renderArea = renderArea,
                 .layerCount = 1,
                 .viewMask = 0,
                 .colorAttachmentCount = 1,
@@ -81,22 +255,22 @@ std::shared_ptr<RenderGraph> setupRenderGraph() {
             Debug::SetCmdLabel(recordInfo.commandBuffer, {0.7f, 0.2f, 0.7f}, "Texture Target Pass");
             vkCmdBeginRendering(recordInfo.commandBuffer, &renderingInfo);
 
+            // The viewport always spans the level so shaders see the same uv for any region
             VkViewport viewport = {
                 .x = 0.0f, .y = 0.0f,
-                .width = static_cast<float>(targetImage->size.value.x),
-                .height = static_cast<float>(targetImage->size.value.y),
+                .width = static_cast<float>(levelExtent.width),
+                .height = static_cast<float>(levelExtent.height),
                 .minDepth = 0.0f, .maxDepth = 1.0f
             };
             vkCmdSetViewport(recordInfo.commandBuffer, 0, 1, &viewport);
-
-            VkRect2D scissor = {.offset = {0, 0}, .extent = targetImage->size};
-            vkCmdSetScissor(recordInfo.commandBuffer, 0, 1, &scissor);
+            vkCmdSetScissor(recordInfo.commandBuffer, 0, 1, &renderArea);
 
             vkCmdBindPipeline(
                 recordInfo.commandBuffer,
                 VK_PIPELINE_BIND_POINT_GRAPHICS,
                 textureTarget->material->pipeline->pipeline
             );
+            RasterStates::Set(recordInfo.commandBuffer, textureTarget->material->pipeline->raster, std::nullopt);
 
             for (Size setIndex = 0; setIndex < textureTarget->material->descriptorSets.size(); setIndex++) {
                 DescriptorSetData setData = textureTarget->material->descriptorSets[setIndex];
@@ -124,18 +298,21 @@ std::shared_ptr<RenderGraph> setupRenderGraph() {
             vkCmdEndRendering(recordInfo.commandBuffer);
             Debug::RemoveCmdLabel(recordInfo.commandBuffer);
 
-            recordInfo.commandSubmitter->transitionImage(
-                recordInfo.commandBuffer,
-                targetImage,
-                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-            );
+            bool lastForImage = i + 1 == textureTargets.size() || textureTargets[i + 1].texture != targetImage;
+            if (lastForImage) {
+                recordInfo.commandSubmitter->transitionImage(
+                    recordInfo.commandBuffer,
+                    targetImage,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+                );
+            }
         }
-    }, {});
+    }, {computeTargetsPass});
 
     Size geometry = renderGraph->addGeometry("Main Geometry");
     Size geometryPass = renderGraph->createNode(
         "Geometry",
-        [finalImg, depthBuffer, geometry](RecordInfo recordInfo) {
+        [finalImg, depthBuffer, geometry, global](RecordInfo recordInfo) {
             Debug::SetCmdLabel(recordInfo.commandBuffer, {0.7f, 0.2f, 0.2f}, "Geometry Pass");
 
             Image* outputImg = &recordInfo.renderContext->images[finalImg];
@@ -199,27 +376,52 @@ std::shared_ptr<RenderGraph> setupRenderGraph() {
             VkRect2D scissor = {.offset = {0, 0}, .extent = outputImg->size};
             vkCmdSetScissor(recordInfo.commandBuffer, 0, 1, &scissor);
 
+            // Every graphics layout is compatible for set 0, the material binds below start at set 1
+            global.set.bindBuffer(recordInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, global.layout, 0);
+
+            // Objects sharing a material only differ by push constants (e.g. an object data address).
+            // Raster state is dynamic, so materials drawn filled and as wireframe share one pipeline.
+            MaterialData* boundMaterial = nullptr;
+            VkPipeline boundPipeline = nullptr;
+            Option<RasterState> boundRaster;
+            Buffer* boundVertexBuffer = nullptr;
+            Buffer* boundIndexBuffer = nullptr;
+
             std::vector<RenderObject>& objects = recordInfo.renderContext->geometries[geometry];
             for (Size i = 0; i < objects.size(); i++) {
                 MaterialData* material = objects[i].material;
 
-                vkCmdBindPipeline(
-                    recordInfo.commandBuffer,
-                    VK_PIPELINE_BIND_POINT_GRAPHICS,
-                    material->pipeline->pipeline
-                );
-
-                for (Size setIndex = 0; setIndex < material->descriptorSets.size(); setIndex++) {
-                    DescriptorSetData setData = material->descriptorSets[setIndex];
-
-                    setData.set.bindBuffer(
-                        recordInfo.commandBuffer,
-                        VK_PIPELINE_BIND_POINT_GRAPHICS,
-                        material->pipeline->pipelineLayout,
-                        setData.setIndex
-                    );
+                // Still compiling in the background without a fallback
+                if (material->pipeline->pipeline == nullptr) continue;
+
+                if (material != boundMaterial) {
+                    if (material->pipeline->pipeline != boundPipeline) {
+                        vkCmdBindPipeline(
+                            recordInfo.commandBuffer,
+                            VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            material->pipeline->pipeline
+                        );
+                        boundPipeline = material->pipeline->pipeline;
+                    }
+
+                    for (Size setIndex = 0; setIndex < material->descriptorSets.size(); setIndex++) {
+                        DescriptorSetData setData = material->descriptorSets[setIndex];
+
+                        setData.set.bindBuffer(
+                            recordInfo.commandBuffer,
+                            VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            material->pipeline->pipelineLayout,
+                            setData.setIndex
+                        );
+                    }
+
+                    boundMaterial = material;
                 }
 
+                RasterState raster = objects[i].raster.value_or(material->pipeline->raster);
+                RasterStates::Set(recordInfo.commandBuffer, raster, boundRaster);
+                boundRaster = raster;
+
                 if (material->pipeline->pushConstants.enabled) {
                     vkCmdPushConstants(
                         recordInfo.commandBuffer,
@@ -231,26 +433,35 @@ std::shared_ptr<RenderGraph> setupRenderGraph() {
                     );
                 }
 
-                VkDeviceSize offsets[] = {0};
-                vkCmdBindVertexBuffers(
-                    recordInfo.commandBuffer,
-                    0, 1,
-                    &objects[i].vertexBuffer->buffer,
-                    offsets
-                );
-                vkCmdBindIndexBuffer(
-                    recordInfo.commandBuffer,
-                    objects[i].indexBuffer->buffer,
-                    0,
-                    VK_INDEX_TYPE_UINT32
-                );
+                // Pooled meshes share one vertex and index buffer, so these rarely change.
+                // Meshes built from gl_VertexIndex have no vertex buffer and leave it bound.
+                if (objects[i].vertexBuffer != nullptr && objects[i].vertexBuffer != boundVertexBuffer) {
+                    VkDeviceSize offsets[] = {0};
+                    vkCmdBindVertexBuffers(
+                        recordInfo.commandBuffer,
+                        0, 1,
+                        &objects[i].vertexBuffer->buffer,
+                        offsets
+                    );
+                    boundVertexBuffer = objects[i].vertexBuffer;
+                }
+
+                if (objects[i].indexBuffer != boundIndexBuffer) {
+                    vkCmdBindIndexBuffer(
+                        recordInfo.commandBuffer,
+                        objects[i].indexBuffer->buffer,
+                        0,
+                        VK_INDEX_TYPE_UINT32
+                    );
+                    boundIndexBuffer = objects[i].indexBuffer;
+                }
 
                 vkCmdDrawIndexed(
                     recordInfo.commandBuffer,
                     objects[i].indexCount,
                     1,
                     objects[i].startIndex,
-                    0,
+                    objects[i].vertexOffset,
                     0
                 );
             }
@@ -3,8 +3,10 @@
 #pragma once
 
 #include "RenderEngine/RenderGraph/RenderGraph.hpp"
+#include "RenderEngine/RenderObjects/Materials.hpp"
 
 #include <memory>
 
-std::shared_ptr<RenderGraph> setupRenderGraph();
+// The global set is bound once at the start of every graphics pass
+std::shared_ptr<RenderGraph> setupRenderGraph(GlobalDescriptors global);
 
@@ -1,20 +1,23 @@
 // src/Game/Scene/TestScene.cpp
 
 #include "TestScene.hpp"
-#include "Game/GameObjects/SkyboxGenerator.hpp"
+#include "AssetManagement/Meshes/CubeGenerator.hpp"
+#include "Game/GameObjects/Atmosphere.hpp"
 #include "Game/GameObjects/TerrainManager.hpp"
 #include "Game/RenderGraphSetup.hpp"
 #include "imgui.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/euler_angles.hpp>
+#include <array>
+#include <cmath>
 
 void TestScene::Setup(ResourceManager* resources, Input* input, RenderEngine* graphics) {
     this->resources = resources;
     start = Duration::now();
 
     // Camera Inputs
-    camera = FreeCam(1080.0f / 720.0f, 90.0f, 0.1f, 1000.0f);
+    camera = FreeCam(1080.0f / 720.0f, 90.0f, 0.1f, 10000.0f);
     camera.setPosition(glm::vec3(0.0f, 1.0f, 50.0f));
     camera.setRotation(glm::radians(glm::vec3(45.0f, 0.0f, 180.0f)));
 
@@ -28,17 +31,41 @@ void TestScene::Setup(ResourceManager* resources, Input* input, RenderEngine* gr
     globalBuffer = resources->createUniformBuffer(512, "Global Info Buffer").value();
     buffers.registerBuffer(&globalBuffer, "Global Buffer");
 
-    terrain.Setup(resources, &buffers);
+    // Every material the scene uses, built in parallel before the objects ask for them. The
+    // terrain's unrolled generator is left out, it compiles in the background behind a fallback
+    ProvidedVertexLayout cubeLayout = cubeVertexLayout();
+    std::array<MaterialRequest, 5> materials = {{
+        {"atmosphereTransmittance", nullptr},
+        {"atmosphereSkyView", nullptr},
+        {"terrainGenerator", nullptr},
+        {"terrain", nullptr},
+        {"skyBox", &cubeLayout},
+    }};
+    resources->getMaterialManager()->preload(materials);
+
+    atmosphere.Setup(resources);
+
+    terrain.Setup(resources);
+
+    // Set 0 of every graphics material: camera, lights, and the atmosphere for the sky and fog
+    std::array<DescriptorPool::PoolSizeRatio, 2> poolRatios = {{
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 3.0f},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1.0f},
+    }};
+    globalPool = resources->createDescriptorPool(1, poolRatios).value();
+
+    GlobalDescriptors global = resources->getMaterialManager()->createGlobalDescriptors(&globalPool);
+    global.set.writeUniformBuffer(0, &globalBuffer, 192, 0);     // camera
+    global.set.writeUniformBuffer(1, &globalBuffer, 320, 192);   // lights
+    global.set.writeUniformBuffer(2, atmosphere.getParametersBuffer(), sizeof(Atmosphere::Parameters), 0);
+    global.set.writeImageSampler(3, atmosphere.getSkyView(), atmosphere.sampler);
 
     // Set renderGraph
-    std::shared_ptr<RenderGraph> renderGraph = setupRenderGraph();
+    std::shared_ptr<RenderGraph> renderGraph = setupRenderGraph(global);
     graphics->setRenderGraph(renderGraph);
 
     // Sky
-    skyGenerator.Setup(resources);
-
     skybox.Setup(resources);
-    skybox.SetImage(skyGenerator.getImage());
 }
 
 void TestScene::Run(Input* input) {
@@ -94,17 +121,20 @@ void TestScene::Run(Input* input) {
         float intensity;
     } lights;
 
-    skyGenerator.Run();
+    atmosphere.Run(input->deltaTime().asSeconds(), camera.getPosition());
 
-    glm::vec3 skyDir = skyGenerator.getSunDirection(false);
+    glm::vec3 skyDir = atmosphere.getSunDirection(false);
 
+    // Sunlight after the atmosphere, reddening towards the horizon
     lights.dirLightDir = skyDir;
-    lights.dirLightColor = glm::vec3(1.0f);
+    lights.dirLightColor = atmosphere.getSunColor();
     lights.intensity = 1.0f;
 
     memcpy(globalPtr + 192, &lights, sizeof(lights));
 
-    terrain.Run();
+    // Half the screen height in pixels per unit of slope, for the terrain's screen space error
+    F32 projectionScale = 720.0f * 0.5f * std::abs(camera.getProjectionMatrix()[1][1]);
+    terrain.Run(camera.getPosition(), projectionScale);
 
     glm::mat4 view = camera.getViewMatrix();
     glm::mat4 viewNoTranslation = view;
@@ -114,16 +144,17 @@ void TestScene::Run(Input* input) {
 }
 
 void TestScene::Draw(RenderEngine* graphics) {
-    skyGenerator.Draw(graphics);
+    atmosphere.Draw(graphics);
     skybox.Draw(graphics);
 
     terrain.Draw(graphics);
 }
 
 void TestScene::Cleanup() {
-    skyGenerator.Cleanup();
+    atmosphere.Cleanup();
     skybox.Cleanup();
 
+    globalPool.destroyPools();
     globalBuffer.shutdown();
     terrain.Cleanup();
 }
@@ -2,8 +2,8 @@
 
 #pragma once
 
+#include "Game/GameObjects/Atmosphere.hpp"
 #include "Game/GameObjects/Skybox.hpp"
-#include "Game/GameObjects/SkyboxGenerator.hpp"
 #include "Game/GameObjects/TerrainManager.hpp"
 #include "Game/Scene/Scene.hpp"
 #include "Game/Camera/FreeCam.hpp"
@@ -22,10 +22,12 @@ public:
     BufferRegistry buffers;
     Buffer globalBuffer;
 
+    DescriptorPool globalPool;
+
     TerrainManager terrain;
 
-    // Skybox
-    SkyboxGenerator skyGenerator;
+    // Sky
+    Atmosphere atmosphere;
     Skybox skybox;
 
     virtual void Setup(ResourceManager* resources, Input* input, RenderEngine* graphics) override;
@@ -3,11 +3,14 @@
 #include "CommandSubmitter.hpp"
 
 #include "InternalResources/CommandPool.hpp"
+#include "SparseBinder.hpp"
 #include "VkUtils.hpp"
 
 #include <spdlog/spdlog.h>
 #include <vulkan/vk_enum_string_helper.h>
 
+#include <algorithm>
+
 bool CommandSubmitter::initialize(VulkanInfo* vkInfo) {
     m_vkInfo = vkInfo;
 
@@ -84,6 +87,26 @@ void CommandSubmitter::frameSubmit(FrameSubmitInfo info) {
     //pipelineStageFlags |= VK_PIPELINE_STAGE_TRANSFER_BIT;
     pipelineStageFlags |= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
+    // Flush this frame's sparse binds once, signaling every node that consumes them
+    std::vector<bool> waitsOnSparse(numNodes, false);
+    if (m_vkInfo->sparseBinder->hasPending()) {
+        std::vector<VkSemaphore> sparseSignals;
+        for (Size i = 0; i < numNodes; i++) {
+            if (!graph->nodes[i].sparseInput) continue;
+            waitsOnSparse[i] = true;
+            sparseSignals.push_back(frame.renderContext.sparseSemaphores[i].get());
+        }
+
+        if (sparseSignals.empty() && numNodes > 0) {
+            waitsOnSparse[0] = true;
+            sparseSignals.push_back(frame.renderContext.sparseSemaphores[0].get());
+        }
+
+        if (!m_vkInfo->sparseBinder->submit(sparseSignals)) {
+            std::fill(waitsOnSparse.begin(), waitsOnSparse.end(), false);
+        }
+    }
+
     for (Size i = 0; i < numNodes; i++) {
         VkCommandBuffer cmd = cmdBuffers[i];
 
@@ -140,6 +163,12 @@ void CommandSubmitter::frameSubmit(FrameSubmitInfo info) {
 
         std::vector<VkPipelineStageFlags> waitStages(dependencys.size(), pipelineStageFlags);
 
+        if (waitsOnSparse[i]) {
+            // Sparse resources may be read from any stage
+            dependencys.push_back(frame.renderContext.sparseSemaphores[i].get());
+            waitStages.push_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+        }
+
         VkSubmitInfo submitInfo{
             .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
             .pNext = nullptr,
@@ -183,7 +212,11 @@ StageAccessMasks getStageAccessMasks(VkImageLayout layout, bool isTransferQueue)
             if (isTransferQueue) {
                 masks.stageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
             } else {
-                masks.stageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+                // Heightmaps are sampled from vertex shaders, generated ones are read back by compute
+                masks.stageMask = VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT |
+                                  VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT |
+                                  VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+                masks.accessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
             }
             break;
 
@@ -97,3 +97,27 @@ void FrameData::clearTextureTargets() {
     renderContext.textureTargets.clear();
 }
 
+void FrameData::addComputeTargets(std::vector<ComputeRenderObject> targets) {
+    renderContext.computeTargets.insert(
+            renderContext.computeTargets.end(), targets.begin(), targets.end());
+}
+
+void FrameData::clearComputeTargets() {
+    renderContext.computeTargets.clear();
+}
+
+void FrameData::addImageUploads(std::vector<ImageCopyObject> uploads) {
+    renderContext.imageUploads.insert(
+            renderContext.imageUploads.end(), uploads.begin(), uploads.end());
+}
+
+void FrameData::addImageReadbacks(std::vector<ImageCopyObject> readbacks) {
+    renderContext.imageReadbacks.insert(
+            renderContext.imageReadbacks.end(), readbacks.begin(), readbacks.end());
+}
+
+void FrameData::clearImageCopies() {
+    renderContext.imageUploads.clear();
+    renderContext.imageReadbacks.clear();
+}
+
@@ -13,6 +13,8 @@
 #include "../InternalResources/Semaphore.hpp"
 #include "../RenderGraph/RenderGraph.hpp"
 #include "../RenderObjects/RenderObject.hpp"
+#include "RenderEngine/RenderObjects/ComputeRenderObject.hpp"
+#include "RenderEngine/RenderObjects/ImageCopyObject.hpp"
 #include "RenderEngine/RenderObjects/TextureRenderObject.hpp"
 
 #include <vulkan/vulkan.h>
@@ -32,6 +34,13 @@ public:
     void addTextureTargets(std::vector<TextureRenderObject> targets);
     void clearTextureTargets();
 
+    void addComputeTargets(std::vector<ComputeRenderObject> targets);
+    void clearComputeTargets();
+
+    void addImageUploads(std::vector<ImageCopyObject> uploads);
+    void addImageReadbacks(std::vector<ImageCopyObject> readbacks);
+    void clearImageCopies();
+
     CommandPool commandPool;
     VkCommandBuffer transferBuffer;
 
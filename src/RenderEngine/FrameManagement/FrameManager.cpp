@@ -146,6 +146,10 @@ void FrameManager::presentFrame(FrameSubmitInfo info) {
         .clearAllRenderObjects();
     m_frameData[m_frameNumber % Config::framesInFlight]
         .clearTextureTargets();
+    m_frameData[m_frameNumber % Config::framesInFlight]
+        .clearComputeTargets();
+    m_frameData[m_frameNumber % Config::framesInFlight]
+        .clearImageCopies();
 
     m_frameNumber++;
 }
@@ -174,3 +178,18 @@ void FrameManager::addTextureRenderObjects(std::vector<TextureRenderObject> obje
     m_frameData[m_frameNumber % Config::framesInFlight]
         .addTextureTargets(objects);
 }
+
+void FrameManager::addComputeRenderObjects(std::vector<ComputeRenderObject> objects) {
+    m_frameData[m_frameNumber % Config::framesInFlight]
+        .addComputeTargets(objects);
+}
+
+void FrameManager::addImageUploads(std::vector<ImageCopyObject> uploads) {
+    m_frameData[m_frameNumber % Config::framesInFlight]
+        .addImageUploads(uploads);
+}
+
+void FrameManager::addImageReadbacks(std::vector<ImageCopyObject> readbacks) {
+    m_frameData[m_frameNumber % Config::framesInFlight]
+        .addImageReadbacks(readbacks);
+}
@@ -29,6 +29,9 @@ public:
 
     void addRenderObjects(Size geoId, std::vector<RenderObject> objects);
     void addTextureRenderObjects(std::vector<TextureRenderObject> objects);
+    void addComputeRenderObjects(std::vector<ComputeRenderObject> objects);
+    void addImageUploads(std::vector<ImageCopyObject> uploads);
+    void addImageReadbacks(std::vector<ImageCopyObject> readbacks);
 
     GLFWwindow* getGLFWwindow() const { return m_window->getGLFWwindow(); };
     void setRenderGraph(std::shared_ptr<RenderGraph> renderGraph);
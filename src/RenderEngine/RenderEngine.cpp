@@ -6,6 +6,9 @@
 #include "Debug.hpp"
 #include "InternalResources/CommandPool.hpp"
 #include "RenderEngine/FrameSubmitInfo.hpp"
+#include "RenderEngine/RenderObjects/RasterState.hpp"
+#include "RenderEngine/SparseBinder.hpp"
+#include "RenderEngine/SparsePageHeap.hpp"
 #include "RenderEngine/VulkanInitHelpers.hpp"
 #include "VkUtils.hpp"
 
@@ -66,14 +69,28 @@ bool RenderEngine::initVulkan() {
             features10,
             features12,
             features13,
-            descriptorBufferFeatures)) {
+            descriptorBufferFeatures,
+            &m_vkInfo.graphicsPipelineLibrary,
+            &m_vkInfo.wireframe,
+            &m_vkInfo.dynamicPolygonMode)) {
         spdlog::error("Failed to create logical device.");
         return false;
     }
 
+    // Pipelines only declare polygon mode dynamic when the command to set it was found
+    m_vkInfo.dynamicPolygonMode = RasterStates::LoadCommands(m_vkInfo.device, m_vkInfo.dynamicPolygonMode);
+
     m_vkInfo.graphicsQueueFamily = graphicsFamily;
     m_vkInfo.transferQueueFamily = transferFamily;
 
+    // Sparse binding queue
+    U32 sparseFamily = 0;
+    m_vkInfo.sparseQueue = VK_NULL_HANDLE;
+    if (PickSparseQueueFamily(m_vkInfo.physicalDevice, graphicsFamily, transferFamily, &sparseFamily)) {
+        m_vkInfo.sparseQueueFamily = sparseFamily;
+        m_vkInfo.sparseQueue = (sparseFamily == transferFamily) ? m_vkInfo.transferQueue : m_vkInfo.graphicsQueue;
+    }
+
     // Create VMA allocator
     VmaAllocatorCreateInfo allocatorInfo{};
     allocatorInfo.physicalDevice = m_vkInfo.physicalDevice;
@@ -96,6 +113,23 @@ bool RenderEngine::initVulkan() {
         return false;
     }
 
+    // Sparse binder
+    m_vkInfo.sparseBinder = new SparseBinder();
+    if (!m_vkInfo.sparseBinder->initialize(&m_vkInfo)) {
+        spdlog::error("Failed to initialize SparseBinder.");
+        return false;
+    }
+
+    // Sparse page heap
+    m_vkInfo.sparseHeap = new SparsePageHeap();
+    if (!m_vkInfo.sparseHeap->initialize(
+            &m_vkInfo,
+            SparsePageHeap::DEFAULT_PAGE_SIZE,
+            SparsePageHeap::DEFAULT_PAGES_PER_BLOCK)) {
+        spdlog::error("Failed to initialize SparsePageHeap.");
+        return false;
+    }
+
     // Initialize command submitter
     m_commandSubmitter = std::make_shared<CommandSubmitter>();
     if (!m_commandSubmitter->initialize(&m_vkInfo)) {
@@ -129,6 +163,16 @@ bool RenderEngine::initVulkan() {
         delete m_vkInfo.transferPool;
     });
 
+    m_mainDeletionQueue.push([this]() {
+        m_vkInfo.sparseBinder->shutdown();
+        delete m_vkInfo.sparseBinder;
+    });
+
+    m_mainDeletionQueue.push([this]() {
+        m_vkInfo.sparseHeap->shutdown();
+        delete m_vkInfo.sparseHeap;
+    });
+
     return true;
 }
 
@@ -238,6 +282,18 @@ void RenderEngine::renderTextureObjects(std::vector<TextureRenderObject> objects
     m_frameManager->addTextureRenderObjects(objects);
 }
 
+void RenderEngine::dispatchComputeObjects(std::vector<ComputeRenderObject> objects) {
+    m_frameManager->addComputeRenderObjects(objects);
+}
+
+void RenderEngine::uploadImageRegions(std::vector<ImageCopyObject> uploads) {
+    m_frameManager->addImageUploads(uploads);
+}
+
+void RenderEngine::readbackImageRegions(std::vector<ImageCopyObject> readbacks) {
+    m_frameManager->addImageReadbacks(readbacks);
+}
+
 void RenderEngine::setRenderGraph(std::shared_ptr<RenderGraph> graph) {
     m_frameManager->setRenderGraph(graph);
 }
@@ -245,6 +301,7 @@ void RenderEngine::setRenderGraph(std::shared_ptr<RenderGraph> graph) {
 void RenderEngine::renderFrame() {
     FrameSubmitInfo info = m_frameManager->getNextFrameInfo();
     m_commandSubmitter->frameSubmit(info);
+    m_vkInfo.sparseHeap->endFrame();
     m_frameManager->presentFrame(info);
 }
 
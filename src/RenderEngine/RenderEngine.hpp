@@ -5,6 +5,8 @@
 #include "Core/DeletionQueue.hpp"
 #include "FrameManagement/FrameManager.hpp"
 #include "CommandSubmitter.hpp"
+#include "RenderEngine/RenderObjects/ComputeRenderObject.hpp"
+#include "RenderEngine/RenderObjects/ImageCopyObject.hpp"
 #include "RenderEngine/RenderObjects/TextureRenderObject.hpp"
 #include "RenderGraph/RenderGraph.hpp"
 #include "RenderObjects/RenderObject.hpp"
@@ -25,6 +27,9 @@ public:
     void StartImGui();
     void renderObjects(Size geoId, std::vector<RenderObject> objects);
     void renderTextureObjects(std::vector<TextureRenderObject> objects);
+    void dispatchComputeObjects(std::vector<ComputeRenderObject> objects);
+    void uploadImageRegions(std::vector<ImageCopyObject> uploads);
+    void readbackImageRegions(std::vector<ImageCopyObject> readbacks);
     void setRenderGraph(std::shared_ptr<RenderGraph> graph);
     void renderFrame();
 
@@ -42,5 +42,8 @@ struct RenderNode {
 
     std::vector<Size> geometryInputs;
     std::vector<Size> geometryOutputs;
+
+    // Waits on the frame's sparse bind batch before executing
+    bool sparseInput;
 };
 
@@ -16,7 +16,11 @@ RenderInfo RenderInfo::create(
         .images = std::vector<Image>(renderGraph->images.size()),
         .geometries = std::vector<std::vector<RenderObject>>(renderGraph->geometries.size()),
         .textureTargets = {},
+        .computeTargets = {},
+        .imageUploads = {},
+        .imageReadbacks = {},
         .semaphores = std::vector<Semaphore>(renderGraph->nodes.size()),
+        .sparseSemaphores = std::vector<Semaphore>(renderGraph->nodes.size()),
     };
 
     for (Size i = 0; i < renderGraph->images.size(); i++) {
@@ -53,6 +57,10 @@ RenderInfo RenderInfo::create(
                 vkInfo,
                 fmt::format("{}'s semaphore", renderGraph->nodes[i].name)
         );
+        info.sparseSemaphores[i].initialize(
+                vkInfo,
+                fmt::format("{}'s sparse bind semaphore", renderGraph->nodes[i].name)
+        );
     }
 
     return info;
@@ -66,6 +74,10 @@ void RenderInfo::shutdown() {
     for (Size i = 0; i < semaphores.size(); i++) {
         semaphores[i].shutdown();
     }
+
+    for (Size i = 0; i < sparseSemaphores.size(); i++) {
+        sparseSemaphores[i].shutdown();
+    }
 }
 
 Size RenderGraph::addImage(
@@ -113,6 +125,7 @@ Size RenderGraph::createNode(
         .imageOutputs = {},
         .geometryInputs = {},
         .geometryOutputs = {},
+        .sparseInput = false,
     };
 
     return insertNode(node, dependencies);
@@ -138,6 +151,10 @@ void RenderGraph::addGeometryOutput(Size nodeId, std::vector<Size> geoIds) {
             nodes[nodeId].geometryOutputs.end(), geoIds.begin(), geoIds.end());
 }
 
+void RenderGraph::addSparseInput(Size nodeId) {
+    nodes[nodeId].sparseInput = true;
+}
+
 Size RenderGraph::getNode(std::string name) {
     for (RenderNode node : nodes) {
         if (node.name == name) {
@@ -7,6 +7,8 @@
 
 #include "GraphContext.hpp"
 #include "RenderEngine/InternalResources/Semaphore.hpp"
+#include "RenderEngine/RenderObjects/ComputeRenderObject.hpp"
+#include "RenderEngine/RenderObjects/ImageCopyObject.hpp"
 #include "RenderEngine/RenderObjects/TextureRenderObject.hpp"
 #include "RenderEngine/VulkanInfo.hpp"
 #include "ResourceManagement/RenderResources/Image.hpp"
@@ -24,7 +26,11 @@ struct RenderInfo {
     std::vector<Image> images;
     std::vector<std::vector<RenderObject>> geometries;
     std::vector<TextureRenderObject> textureTargets;
+    std::vector<ComputeRenderObject> computeTargets;
+    std::vector<ImageCopyObject> imageUploads;
+    std::vector<ImageCopyObject> imageReadbacks;
     std::vector<Semaphore> semaphores;
+    std::vector<Semaphore> sparseSemaphores;
 
     static RenderInfo create(
             VulkanInfo* vkInfo,
@@ -63,6 +69,7 @@ public:
     void addImageOutput(Size nodeId, std::vector<Size> imageIds);
     void addGeometryInput(Size nodeId, std::vector<Size> geoIds);
     void addGeometryOutput(Size nodeId, std::vector<Size> geoIds);
+    void addSparseInput(Size nodeId);
 
     Size getNode(std::string name);
     void printGraph() const;
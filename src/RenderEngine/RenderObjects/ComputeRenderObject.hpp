@@ -0,0 +1,26 @@
+// src/RenderEngine/RenderObjects/ComputeRenderObject.hpp
+
+#pragma once
+
+#include "Core/Types.hpp"
+#include "RenderEngine/RenderObjects/Materials.hpp"
+#include "ResourceManagement/RenderResources/Image.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+struct ComputeRenderObject {
+    MaterialData* material;
+    void* pushConstantData;
+
+    U32 groupCountX = 1;
+    U32 groupCountY = 1;
+    U32 groupCountZ = 1;
+
+    // Written as storage images, in GENERAL for the dispatch and shader read only after it
+    std::vector<Image*> storageImages;
+
+    // Reads what the dispatches recorded before it wrote, e.g. a lut built earlier in the pass
+    bool dependsOnPrevious = false;
+};
@@ -9,12 +9,13 @@ DescriptorSetBuilder* DescriptorSetBuilder::addBinding(
         VkDescriptorType type,
         VkShaderStageFlags stages,
         U32 size,
-        U32 offset
+        U32 offset,
+        U32 count
 ) {
     VkDescriptorSetLayoutBinding binding = {
         .binding = bindingNumber,
         .descriptorType = type,
-        .descriptorCount = 1,
+        .descriptorCount = count,
         .stageFlags = stages,
         .pImmutableSamplers = nullptr,
     };
@@ -25,6 +26,7 @@ DescriptorSetBuilder* DescriptorSetBuilder::addBinding(
         .stages = stages,
         .size = size,
         .offset = offset,
+        .count = count,
     };
 
     m_bindings.push_back(binding);
@@ -15,7 +15,8 @@ public:
             VkDescriptorType type,
             VkShaderStageFlags stages,
             U32 size,
-            U32 offset
+            U32 offset,
+            U32 count = 1
     );
 
     Option<DescriptorSetInfo> build(VkDevice device);
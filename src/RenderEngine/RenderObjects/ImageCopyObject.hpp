@@ -0,0 +1,17 @@
+// src/RenderEngine/RenderObjects/ImageCopyObject.hpp
+
+#pragma once
+
+#include "ResourceManagement/RenderResources/Buffer.hpp"
+#include "ResourceManagement/RenderResources/Image.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+// Buffer <-> image regions copied in GENERAL, uploads before the compute dispatches and readbacks after
+struct ImageCopyObject {
+    Image* image;
+    Buffer* buffer;
+    std::vector<VkBufferImageCopy> regions;
+};
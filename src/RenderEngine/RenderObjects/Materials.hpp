@@ -3,14 +3,19 @@
 #pragma once
 
 #include "Core/Types.hpp"
+#include "RasterState.hpp"
 #include "ResourceManagement/RenderResources/DescriptorSet.hpp"
 #include <vulkan/vulkan.h>
 
+#include <map>
+#include <string>
+#include <variant>
 #include <vector>
 
 enum MaterialType {
     Opaque,
-    Transparent
+    Transparent,
+    Compute
 };
 
 struct DescriptorBindingInfo {
@@ -19,13 +24,15 @@ struct DescriptorBindingInfo {
     VkShaderStageFlags stages;
     U32 size;
     U32 offset;
+    U32 count;
 
     bool operator==(const DescriptorBindingInfo &b) const {
         return binding == b.binding &&
             descriptorType == b.descriptorType &&
             stages == b.stages &&
             size == b.size &&
-            offset == b.offset;
+            offset == b.offset &&
+            count == b.count;
     }
 };
 
@@ -46,12 +53,25 @@ struct PushConstantsInfo {
     Size offset;
 };
 
+// The only range of every graphics pipeline layout, so any two stay compatible for set 0.
+// 128 bytes is the smallest maxPushConstantsSize a device may report.
+constexpr VkPushConstantRange SHARED_PUSH_CONSTANT_RANGE = {
+    .stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS,
+    .offset = 0,
+    .size = 128,
+};
+
+// Overrides of a material's specialization_constants by name, converted to the declared type
+using SpecializationValue = std::variant<bool, I32, U32, F32>;
+using Specialization = std::map<std::string, SpecializationValue>;
+
 struct MaterialInfo {
     VkPipeline pipeline;
     VkPipelineLayout pipelineLayout;
     PushConstantsInfo pushConstants;
     std::vector<DescriptorSetInfo> descriptorSets;
     MaterialType type;
+    RasterState raster;     // From pipeline.yaml, draws may override it
 };
 
 struct DescriptorSetData {
@@ -65,3 +85,8 @@ struct MaterialData {
     std::vector<DescriptorSetData> descriptorSets;
 };
 
+// Set 0 of every graphics material, bound once per pass with a layout compatible with all of them
+struct GlobalDescriptors {
+    DescriptorSet set;
+    VkPipelineLayout layout;
+};
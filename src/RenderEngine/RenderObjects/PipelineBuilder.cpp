@@ -4,7 +4,7 @@
 
 #include "RenderEngine/VkUtils.hpp"
 #include <spdlog/spdlog.h>
-#include <array>
+#include <algorithm>
 
 PipelineBuilder::PipelineBuilder() {
     clear();
@@ -32,19 +32,16 @@ void PipelineBuilder::clear() {
     m_vertexInputState.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
     m_colorAttachmentFormat = VK_FORMAT_UNDEFINED;
+    m_layout = nullptr;
 
     m_shaderStages.clear();
+    m_specializations.clear();
+    m_dynamicStates.clear();
     m_pushConstants.clear();
     m_descriptors.clear();
 }
 
-PipelineInfo PipelineBuilder::build(VkDevice device) {
-    PipelineInfo output = {
-        .pipeline = nullptr,
-        .layout = nullptr,
-        .success = true,
-    };
-
+VkPipelineLayout PipelineBuilder::buildLayout(VkDevice device) {
     VkPipelineLayoutCreateInfo layoutInfo = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
         .pNext = nullptr,
@@ -55,13 +52,36 @@ PipelineInfo PipelineBuilder::build(VkDevice device) {
         .pPushConstantRanges = m_pushConstants.data()
     };
 
+    VkPipelineLayout layout = nullptr;
     VkResult layoutResult = vkCreatePipelineLayout(
             device,
             &layoutInfo,
             nullptr,
-            &output.layout
+            &layout
     );
     if (!VkUtils::checkVkResult(layoutResult, "Couldn't create pipeline layout")) {
+        return nullptr;
+    }
+
+    return layout;
+}
+
+PipelineBuilder* PipelineBuilder::setLayout(VkPipelineLayout layout) {
+    m_layout = layout;
+    return this;
+}
+
+PipelineInfo PipelineBuilder::build(VkDevice device, VkPipelineCache cache) {
+    applySpecializations();
+
+    PipelineInfo output = {
+        .pipeline = nullptr,
+        .layout = nullptr,
+        .success = true,
+    };
+
+    output.layout = m_layout != nullptr ? m_layout : buildLayout(device);
+    if (output.layout == nullptr) {
         output.success = false;
         return output;
     }
@@ -87,7 +107,12 @@ PipelineInfo PipelineBuilder::build(VkDevice device) {
         .blendConstants = {},
     };
 
-    std::array<VkDynamicState, 2> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    std::vector<VkDynamicState> dynamicStates = getDynamicStates(
+            VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT |
+            VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT |
+            VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT |
+            VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT
+    );
     VkPipelineDynamicStateCreateInfo dynamicStateInfo = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
         .pNext = nullptr,
@@ -122,7 +147,7 @@ PipelineInfo PipelineBuilder::build(VkDevice device) {
 
     VkResult pipelineResult = vkCreateGraphicsPipelines(
             device,
-            nullptr,
+            cache,
             1,
             &pipelineInfo,
             nullptr,
@@ -136,6 +161,199 @@ PipelineInfo PipelineBuilder::build(VkDevice device) {
     return output;
 }
 
+VkPipeline PipelineBuilder::buildLibrary(VkDevice device, VkGraphicsPipelineLibraryFlagsEXT part, VkPipelineCache cache) {
+    applySpecializations();
+
+    // Each part only takes the shaders and state it owns, the rest is left out
+    std::vector<VkPipelineShaderStageCreateInfo> stages;
+    for (const VkPipelineShaderStageCreateInfo& stage : m_shaderStages) {
+        bool fragment = stage.stage == VK_SHADER_STAGE_FRAGMENT_BIT;
+        if ((fragment && (part & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT)) ||
+            (!fragment && (part & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT))) {
+            stages.push_back(stage);
+        }
+    }
+
+    bool vertexInput = part & VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+    bool preRasterization = part & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+    bool fragmentShader = part & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+    bool fragmentOutput = part & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+
+    VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo = {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+        .pNext = &m_renderInfo,
+        .flags = part,
+    };
+
+    VkPipelineViewportStateCreateInfo viewportInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .viewportCount = 1,
+        .pViewports = nullptr,
+        .scissorCount = 1,
+        .pScissors = nullptr,
+    };
+
+    VkPipelineColorBlendStateCreateInfo blendStateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .logicOpEnable = VK_FALSE,
+        .logicOp = VK_LOGIC_OP_NO_OP,
+        .attachmentCount = 1,
+        .pAttachments = &m_colorBlendAttachment,
+        .blendConstants = {},
+    };
+
+    std::vector<VkDynamicState> dynamicStates = getDynamicStates(part);
+    VkPipelineDynamicStateCreateInfo dynamicStateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .dynamicStateCount = static_cast<U32>(dynamicStates.size()),
+        .pDynamicStates = dynamicStates.data(),
+    };
+
+    // Retained so a linked pipeline could still be optimised across parts later
+    VkGraphicsPipelineCreateInfo pipelineInfo = {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = &libraryInfo,
+        .flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT,
+        .stageCount = static_cast<U32>(stages.size()),
+        .pStages = stages.data(),
+        .pVertexInputState = vertexInput ? &m_vertexInputState : nullptr,
+        .pInputAssemblyState = vertexInput ? &m_inputAssembly : nullptr,
+        .pTessellationState = nullptr,
+        .pViewportState = preRasterization ? &viewportInfo : nullptr,
+        .pRasterizationState = preRasterization ? &m_rasterizer : nullptr,
+        .pMultisampleState = fragmentShader || fragmentOutput ? &m_multisampling : nullptr,
+        .pDepthStencilState = fragmentShader ? &m_depthStencil : nullptr,
+        .pColorBlendState = fragmentOutput ? &blendStateInfo : nullptr,
+        .pDynamicState = dynamicStates.empty() ? nullptr : &dynamicStateInfo,
+        .layout = preRasterization || fragmentShader ? m_layout : nullptr,
+        .renderPass = nullptr,
+        .subpass = 0,
+        .basePipelineHandle = nullptr,
+        .basePipelineIndex = 0,
+    };
+
+    VkPipeline library = nullptr;
+    VkResult pipelineResult = vkCreateGraphicsPipelines(
+            device,
+            cache,
+            1,
+            &pipelineInfo,
+            nullptr,
+            &library
+    );
+    if (!VkUtils::checkVkResult(pipelineResult, "Couldn't create pipeline library")) {
+        return nullptr;
+    }
+
+    return library;
+}
+
+PipelineInfo PipelineBuilder::link(VkDevice device, std::span<const VkPipeline> libraries, VkPipelineCache cache) {
+    PipelineInfo output = {
+        .pipeline = nullptr,
+        .layout = m_layout,
+        .success = true,
+    };
+
+    VkPipelineLibraryCreateInfoKHR libraryInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+        .pNext = nullptr,
+        .libraryCount = static_cast<U32>(libraries.size()),
+        .pLibraries = libraries.data(),
+    };
+
+    // No link time optimisation, so linking stays cheap enough to do on demand
+    VkGraphicsPipelineCreateInfo pipelineInfo = {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = &libraryInfo,
+        .flags = 0,
+        .stageCount = 0,
+        .pStages = nullptr,
+        .pVertexInputState = nullptr,
+        .pInputAssemblyState = nullptr,
+        .pTessellationState = nullptr,
+        .pViewportState = nullptr,
+        .pRasterizationState = nullptr,
+        .pMultisampleState = nullptr,
+        .pDepthStencilState = nullptr,
+        .pColorBlendState = nullptr,
+        .pDynamicState = nullptr,
+        .layout = m_layout,
+        .renderPass = nullptr,
+        .subpass = 0,
+        .basePipelineHandle = nullptr,
+        .basePipelineIndex = 0,
+    };
+
+    VkResult pipelineResult = vkCreateGraphicsPipelines(
+            device,
+            cache,
+            1,
+            &pipelineInfo,
+            nullptr,
+            &output.pipeline
+    );
+    if (!VkUtils::checkVkResult(pipelineResult, "Couldn't link pipeline libraries")) {
+        output.success = false;
+        return output;
+    }
+
+    return output;
+}
+
+PipelineInfo PipelineBuilder::buildCompute(VkDevice device, VkPipelineCache cache) {
+    applySpecializations();
+
+    PipelineInfo output = {
+        .pipeline = nullptr,
+        .layout = nullptr,
+        .success = true,
+    };
+
+    if (m_shaderStages.size() != 1 || m_shaderStages[0].stage != VK_SHADER_STAGE_COMPUTE_BIT) {
+        spdlog::error("Compute pipelines take exactly one compute shader");
+        output.success = false;
+        return output;
+    }
+
+    output.layout = m_layout != nullptr ? m_layout : buildLayout(device);
+    if (output.layout == nullptr) {
+        output.success = false;
+        return output;
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .stage = m_shaderStages[0],
+        .layout = output.layout,
+        .basePipelineHandle = nullptr,
+        .basePipelineIndex = 0,
+    };
+
+    VkResult pipelineResult = vkCreateComputePipelines(
+            device,
+            cache,
+            1,
+            &pipelineInfo,
+            nullptr,
+            &output.pipeline
+    );
+    if (!VkUtils::checkVkResult(pipelineResult, "Couldn't create compute pipeline")) {
+        output.success = false;
+        return output;
+    }
+
+    return output;
+}
+
 PipelineBuilder* PipelineBuilder::addShader(VkShaderModule module, VkShaderStageFlagBits stageFlags) {
     const char* name = "main";
 
@@ -156,6 +374,43 @@ PipelineBuilder* PipelineBuilder::addShader(VkShaderModule module, VkShaderStage
 
 void PipelineBuilder::clearShaders() {
     m_shaderStages.clear();
+    m_specializations.clear();
+}
+
+PipelineBuilder* PipelineBuilder::setSpecialization(
+        VkShaderStageFlagBits stage,
+        const std::vector<VkSpecializationMapEntry>& entries,
+        const std::vector<U8>& data
+) {
+    std::erase_if(m_specializations, [&](const StageSpecialization& specialization) {
+        return specialization.stage == stage;
+    });
+
+    m_specializations.push_back({
+        .stage = stage,
+        .entries = entries,
+        .data = data,
+        .info = {},
+    });
+
+    return this;
+}
+
+void PipelineBuilder::applySpecializations() {
+    for (StageSpecialization& specialization : m_specializations) {
+        specialization.info = {
+            .mapEntryCount = static_cast<U32>(specialization.entries.size()),
+            .pMapEntries = specialization.entries.data(),
+            .dataSize = specialization.data.size(),
+            .pData = specialization.data.data(),
+        };
+
+        for (VkPipelineShaderStageCreateInfo& shaderStage : m_shaderStages) {
+            if (shaderStage.stage == specialization.stage) {
+                shaderStage.pSpecializationInfo = &specialization.info;
+            }
+        }
+    }
 }
 
 PipelineBuilder* PipelineBuilder::setBlending(BlendingMode mode) {
@@ -263,6 +518,52 @@ PipelineBuilder* PipelineBuilder::setDepthInfo(bool depthTest, bool writeDepth,
     return this;
 }
 
+PipelineBuilder* PipelineBuilder::addDynamicState(VkDynamicState state) {
+    if (std::find(m_dynamicStates.begin(), m_dynamicStates.end(), state) == m_dynamicStates.end()) {
+        m_dynamicStates.push_back(state);
+    }
+
+    return this;
+}
+
+std::vector<VkDynamicState> PipelineBuilder::getDynamicStates(VkGraphicsPipelineLibraryFlagsEXT parts) const {
+    std::vector<VkDynamicState> output;
+
+    bool preRasterization = parts & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+    if (preRasterization) {
+        output.push_back(VK_DYNAMIC_STATE_VIEWPORT);
+        output.push_back(VK_DYNAMIC_STATE_SCISSOR);
+    }
+
+    for (VkDynamicState state : m_dynamicStates) {
+        VkGraphicsPipelineLibraryFlagsEXT owner;
+        switch (state) {
+            case VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY:
+            case VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE:
+                owner = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+                break;
+
+            case VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE:
+            case VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE:
+            case VK_DYNAMIC_STATE_DEPTH_COMPARE_OP:
+            case VK_DYNAMIC_STATE_DEPTH_BOUNDS_TEST_ENABLE:
+            case VK_DYNAMIC_STATE_STENCIL_TEST_ENABLE:
+            case VK_DYNAMIC_STATE_STENCIL_OP:
+                owner = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+                break;
+
+            default:
+                // Cull mode, front face, polygon mode and the rest of the rasterizer
+                owner = VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+                break;
+        }
+
+        if (parts & owner) output.push_back(state);
+    }
+
+    return output;
+}
+
 PipelineBuilder* PipelineBuilder::addDescriptorLayout(DescriptorSetInfo layout) {
     m_descriptors.push_back(layout.layout);
 
@@ -4,6 +4,7 @@
 
 #include "Core/Types.hpp"
 #include "RenderEngine/RenderObjects/Materials.hpp"
+#include <span>
 #include <vector>
 #include <vulkan/vulkan.h>
 
@@ -23,11 +24,30 @@ class PipelineBuilder {
 public:
     PipelineBuilder();
     void clear();
-    PipelineInfo build(VkDevice device);
+    PipelineInfo build(VkDevice device, VkPipelineCache cache = nullptr);
+    PipelineInfo buildCompute(VkDevice device, VkPipelineCache cache = nullptr);   // Layout and the first shader stage only
+
+    // One VK_EXT_graphics_pipeline_library part from the state and shaders it depends on.
+    // Shader parts need setLayout, a layout identical to the linked pipeline's.
+    VkPipeline buildLibrary(VkDevice device, VkGraphicsPipelineLibraryFlagsEXT part, VkPipelineCache cache = nullptr);
+    // Links one library of every part into a complete pipeline with the set layout
+    PipelineInfo link(VkDevice device, std::span<const VkPipeline> libraries, VkPipelineCache cache = nullptr);
+
+    // From the descriptor layouts and push constants alone, no shaders needed
+    VkPipelineLayout buildLayout(VkDevice device);
+    // Built pipelines use this layout instead of creating their own
+    PipelineBuilder* setLayout(VkPipelineLayout layout);
 
     PipelineBuilder* addShader(VkShaderModule module, VkShaderStageFlagBits stageFlags);
     void clearShaders();
 
+    // Entries index into data, every shader of the stage gets them
+    PipelineBuilder* setSpecialization(
+        VkShaderStageFlagBits stage,
+        const std::vector<VkSpecializationMapEntry>& entries,
+        const std::vector<U8>& data
+    );
+
     PipelineBuilder* setBlending(BlendingMode mode);
 
     PipelineBuilder* setColorFormat(VkFormat format);
@@ -42,6 +62,9 @@ public:
 
     PipelineBuilder* setDepthInfo(bool depthTest, bool writeDepth, VkCompareOp op);
 
+    // Viewport and scissor are always dynamic. Values set above for these are ignored.
+    PipelineBuilder* addDynamicState(VkDynamicState state);
+
     PipelineBuilder* addDescriptorLayout(DescriptorSetInfo layout);
     PipelineBuilder* addPushConstant(VkShaderStageFlags stageFlags, U32 size, U32 offset);
 
@@ -52,9 +75,23 @@ public:
     );
 
 private:
+    struct StageSpecialization {
+        VkShaderStageFlagBits stage;
+        std::vector<VkSpecializationMapEntry> entries;
+        std::vector<U8> data;
+        VkSpecializationInfo info;
+    };
+
+    // Pointed at from the stages only once building, after the vectors stop moving
+    void applySpecializations();
+    // Dynamic states of the state owned by the parts, all parts for complete pipelines
+    std::vector<VkDynamicState> getDynamicStates(VkGraphicsPipelineLibraryFlagsEXT parts) const;
+
     std::vector<VkDescriptorSetLayout> m_descriptors;
     std::vector<VkPushConstantRange> m_pushConstants;
     std::vector<VkPipelineShaderStageCreateInfo> m_shaderStages;
+    std::vector<StageSpecialization> m_specializations;
+    std::vector<VkDynamicState> m_dynamicStates;
 
     std::vector<VkVertexInputBindingDescription> m_vertexBindings;
     std::vector<VkVertexInputAttributeDescription> m_vertexAttributes;
@@ -68,4 +105,5 @@ private:
     VkPipelineVertexInputStateCreateInfo m_vertexInputState;
 
     VkFormat m_colorAttachmentFormat;
+    VkPipelineLayout m_layout;
 };
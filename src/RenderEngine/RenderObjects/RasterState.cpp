@@ -0,0 +1,49 @@
+// src/RenderEngine/RenderObjects/RasterState.cpp
+
+#include "RasterState.hpp"
+
+#include <spdlog/spdlog.h>
+
+// Loaded Commands for VK_EXT_extended_dynamic_state3
+static PFN_vkCmdSetPolygonModeEXT my_vkCmdSetPolygonModeEXT = nullptr;
+
+bool RasterStates::LoadCommands(VkDevice device, bool dynamicPolygonMode) {
+    my_vkCmdSetPolygonModeEXT = nullptr;
+    if (!dynamicPolygonMode) return false;
+
+    my_vkCmdSetPolygonModeEXT = reinterpret_cast<PFN_vkCmdSetPolygonModeEXT>(
+        vkGetDeviceProcAddr(device, "vkCmdSetPolygonModeEXT")
+    );
+    if (my_vkCmdSetPolygonModeEXT == nullptr) {
+        spdlog::error("Failed to load vkCmdSetPolygonModeEXT, polygon mode stays baked into pipelines");
+        return false;
+    }
+    return true;
+}
+
+bool RasterStates::HasDynamicPolygonMode() {
+    return my_vkCmdSetPolygonModeEXT != nullptr;
+}
+
+void RasterStates::Set(VkCommandBuffer cmd, const RasterState& state, const Option<RasterState>& bound) {
+    bool all = !bound.has_value();
+
+    if (my_vkCmdSetPolygonModeEXT && (all || bound->polygonMode != state.polygonMode)) {
+        my_vkCmdSetPolygonModeEXT(cmd, state.polygonMode);
+    }
+    if (all || bound->cullMode != state.cullMode) {
+        vkCmdSetCullMode(cmd, state.cullMode);
+    }
+    if (all || bound->frontFace != state.frontFace) {
+        vkCmdSetFrontFace(cmd, state.frontFace);
+    }
+    if (all || bound->depthTest != state.depthTest) {
+        vkCmdSetDepthTestEnable(cmd, state.depthTest ? VK_TRUE : VK_FALSE);
+    }
+    if (all || bound->depthWrite != state.depthWrite) {
+        vkCmdSetDepthWriteEnable(cmd, state.depthWrite ? VK_TRUE : VK_FALSE);
+    }
+    if (all || bound->depthCompareOp != state.depthCompareOp) {
+        vkCmdSetDepthCompareOp(cmd, state.depthCompareOp);
+    }
+}
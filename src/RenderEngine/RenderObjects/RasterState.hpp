@@ -0,0 +1,30 @@
+// src/RenderEngine/RenderObjects/RasterState.hpp
+
+#pragma once
+
+#include "Core/Types.hpp"
+
+#include <vulkan/vulkan.h>
+
+// Raster and depth state every graphics pipeline leaves dynamic, set per draw.
+// Polygon mode is only dynamic with VK_EXT_extended_dynamic_state3, otherwise
+// pipelines bake it in and it is ignored here.
+struct RasterState {
+    VkPolygonMode polygonMode;
+    VkCullModeFlags cullMode;
+    VkFrontFace frontFace;
+    bool depthTest;
+    bool depthWrite;
+    VkCompareOp depthCompareOp;
+
+    bool operator==(const RasterState& b) const = default;
+};
+
+namespace RasterStates {
+    // Loads vkCmdSetPolygonModeEXT when the device enabled it, false when it isn't available
+    bool LoadCommands(VkDevice device, bool dynamicPolygonMode);
+    bool HasDynamicPolygonMode();
+
+    // Only records what differs from bound, everything when nothing is bound yet
+    void Set(VkCommandBuffer cmd, const RasterState& state, const Option<RasterState>& bound);
+}
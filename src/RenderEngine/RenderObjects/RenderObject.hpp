@@ -5,6 +5,7 @@
 #include "Core/Types.hpp"
 #include "ResourceManagement/RenderResources/Buffer.hpp"
 #include "Materials.hpp"
+#include "RasterState.hpp"
 
 #include <glm/glm.hpp>
 #include <strings.h>
@@ -13,12 +14,15 @@
 struct RenderObject {
     U32 indexCount;
     U32 startIndex;
+    I32 vertexOffset = 0;   // In vertices, for meshes sharing a vertex buffer
 
     Buffer* indexBuffer;
     Buffer* vertexBuffer;
 
     MaterialData* material;
     void* pushConstantData;
+
+    Option<RasterState> raster = std::nullopt;  // Instead of the material's, e.g. to draw it as wireframe
 };
 
 class IRenderable {
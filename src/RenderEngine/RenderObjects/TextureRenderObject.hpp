@@ -6,10 +6,16 @@
 #include "ResourceManagement/RenderResources/Image.hpp"
 #include "ResourceManagement/RenderResources/ImageView.hpp"
 
+#include <vulkan/vulkan.h>
+
 struct TextureRenderObject {
     Image* texture;
     ImageView view;
     MaterialData* material;
     void* pushConstantData;
+
+    // Zero extent renders (and clears) the whole level, otherwise only the region is redrawn
+    U32 mipLevel = 0;
+    VkRect2D region = {};
 };
 
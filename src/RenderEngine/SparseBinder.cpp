@@ -0,0 +1,135 @@
+// src/RenderEngine/SparseBinder.cpp
+
+#include "SparseBinder.hpp"
+
+#include "VkUtils.hpp"
+
+#include <spdlog/spdlog.h>
+
+bool SparseBinder::initialize(VulkanInfo* vkInfo) {
+    m_vkInfo = vkInfo;
+
+    if (m_vkInfo->sparseQueue == VK_NULL_HANDLE) {
+        spdlog::warn("No sparse binding capable queue, sparse resources are unavailable");
+    }
+
+    return true;
+}
+
+void SparseBinder::shutdown() {
+    if (hasPending()) {
+        spdlog::warn("Dropping pending sparse binds on shutdown");
+    }
+
+    m_bufferBatches.clear();
+    m_opaqueBatches.clear();
+    m_imageBatches.clear();
+}
+
+void SparseBinder::queueBufferBinds(VkBuffer buffer, std::span<const VkSparseMemoryBind> binds) {
+    if (binds.empty()) return;
+
+    for (BufferBatch& batch : m_bufferBatches) {
+        if (batch.buffer == buffer) {
+            batch.binds.insert(batch.binds.end(), binds.begin(), binds.end());
+            return;
+        }
+    }
+
+    m_bufferBatches.push_back({buffer, {binds.begin(), binds.end()}});
+}
+
+void SparseBinder::queueImageOpaqueBinds(VkImage image, std::span<const VkSparseMemoryBind> binds) {
+    if (binds.empty()) return;
+
+    for (OpaqueBatch& batch : m_opaqueBatches) {
+        if (batch.image == image) {
+            batch.binds.insert(batch.binds.end(), binds.begin(), binds.end());
+            return;
+        }
+    }
+
+    m_opaqueBatches.push_back({image, {binds.begin(), binds.end()}});
+}
+
+void SparseBinder::queueImageBinds(VkImage image, std::span<const VkSparseImageMemoryBind> binds) {
+    if (binds.empty()) return;
+
+    for (ImageBatch& batch : m_imageBatches) {
+        if (batch.image == image) {
+            batch.binds.insert(batch.binds.end(), binds.begin(), binds.end());
+            return;
+        }
+    }
+
+    m_imageBatches.push_back({image, {binds.begin(), binds.end()}});
+}
+
+bool SparseBinder::hasPending() const {
+    return !m_bufferBatches.empty() || !m_opaqueBatches.empty() || !m_imageBatches.empty();
+}
+
+bool SparseBinder::submit(std::span<const VkSemaphore> signalSemaphores) {
+    if (!hasPending()) return true;
+
+    if (m_vkInfo->sparseQueue == VK_NULL_HANDLE) {
+        spdlog::error("Attempted to submit sparse binds without a sparse queue");
+        m_bufferBatches.clear();
+        m_opaqueBatches.clear();
+        m_imageBatches.clear();
+        return false;
+    }
+
+    std::vector<VkSparseBufferMemoryBindInfo> bufferInfos;
+    bufferInfos.reserve(m_bufferBatches.size());
+    for (const BufferBatch& batch : m_bufferBatches) {
+        bufferInfos.push_back({
+            .buffer = batch.buffer,
+            .bindCount = static_cast<U32>(batch.binds.size()),
+            .pBinds = batch.binds.data(),
+        });
+    }
+
+    std::vector<VkSparseImageOpaqueMemoryBindInfo> opaqueInfos;
+    opaqueInfos.reserve(m_opaqueBatches.size());
+    for (const OpaqueBatch& batch : m_opaqueBatches) {
+        opaqueInfos.push_back({
+            .image = batch.image,
+            .bindCount = static_cast<U32>(batch.binds.size()),
+            .pBinds = batch.binds.data(),
+        });
+    }
+
+    std::vector<VkSparseImageMemoryBindInfo> imageInfos;
+    imageInfos.reserve(m_imageBatches.size());
+    for (const ImageBatch& batch : m_imageBatches) {
+        imageInfos.push_back({
+            .image = batch.image,
+            .bindCount = static_cast<U32>(batch.binds.size()),
+            .pBinds = batch.binds.data(),
+        });
+    }
+
+    VkBindSparseInfo bindInfo = {
+        .sType = VK_STRUCTURE_TYPE_BIND_SPARSE_INFO,
+        .pNext = nullptr,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = nullptr,
+        .bufferBindCount = static_cast<U32>(bufferInfos.size()),
+        .pBufferBinds = bufferInfos.data(),
+        .imageOpaqueBindCount = static_cast<U32>(opaqueInfos.size()),
+        .pImageOpaqueBinds = opaqueInfos.data(),
+        .imageBindCount = static_cast<U32>(imageInfos.size()),
+        .pImageBinds = imageInfos.data(),
+        .signalSemaphoreCount = static_cast<U32>(signalSemaphores.size()),
+        .pSignalSemaphores = signalSemaphores.data(),
+    };
+
+    VkResult res = vkQueueBindSparse(m_vkInfo->sparseQueue, 1, &bindInfo, VK_NULL_HANDLE);
+
+    m_bufferBatches.clear();
+    m_opaqueBatches.clear();
+    m_imageBatches.clear();
+
+    return VkUtils::checkVkResult(res, "Failed to submit sparse binds");
+}
@@ -0,0 +1,49 @@
+// src/RenderEngine/SparseBinder.hpp
+
+#pragma once
+
+#include "Core/Types.hpp"
+#include "VulkanInfo.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <span>
+#include <vector>
+
+// Collects sparse (un)binds from every sparse resource and submits them as
+// a single vkQueueBindSparse per frame on the sparse capable queue.
+class SparseBinder {
+public:
+    bool initialize(VulkanInfo* vkInfo);
+    void shutdown();
+
+    void queueBufferBinds(VkBuffer buffer, std::span<const VkSparseMemoryBind> binds);
+    void queueImageOpaqueBinds(VkImage image, std::span<const VkSparseMemoryBind> binds);
+    void queueImageBinds(VkImage image, std::span<const VkSparseImageMemoryBind> binds);
+
+    bool hasPending() const;
+    bool submit(std::span<const VkSemaphore> signalSemaphores);
+
+private:
+    struct BufferBatch {
+        VkBuffer buffer;
+        std::vector<VkSparseMemoryBind> binds;
+    };
+
+    struct OpaqueBatch {
+        VkImage image;
+        std::vector<VkSparseMemoryBind> binds;
+    };
+
+    struct ImageBatch {
+        VkImage image;
+        std::vector<VkSparseImageMemoryBind> binds;
+    };
+
+    VulkanInfo* m_vkInfo = nullptr;
+
+    std::vector<BufferBatch> m_bufferBatches;
+    std::vector<OpaqueBatch> m_opaqueBatches;
+    std::vector<ImageBatch> m_imageBatches;
+
+};
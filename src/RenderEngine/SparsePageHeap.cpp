@@ -0,0 +1,116 @@
+// src/RenderEngine/SparsePageHeap.cpp
+
+#include "SparsePageHeap.hpp"
+
+#include "Debug.hpp"
+#include "VkUtils.hpp"
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+bool SparsePageHeap::initialize(VulkanInfo* vkInfo, VkDeviceSize pageSize, U32 pagesPerBlock) {
+    m_vkInfo = vkInfo;
+    m_pageSize = pageSize;
+    m_pagesPerBlock = pagesPerBlock;
+    m_residentPages = 0;
+    m_retireIndex = 0;
+
+    return true;
+}
+
+void SparsePageHeap::shutdown() {
+    for (auto& [type, pool] : m_pools) {
+        for (const Block& block : pool.blocks) {
+            if (block.mapped) vkUnmapMemory(m_vkInfo->device, block.memory);
+            vkFreeMemory(m_vkInfo->device, block.memory, nullptr);
+        }
+    }
+
+    m_pools.clear();
+    for (std::vector<SparsePage>& retired : m_retired) {
+        retired.clear();
+    }
+    m_residentPages = 0;
+}
+
+Option<SparsePage> SparsePageHeap::allocate(U32 memoryType) {
+    Pool& pool = m_pools[memoryType];
+
+    if (pool.freePages.empty() && !allocateBlock(memoryType, pool)) {
+        return std::nullopt;
+    }
+
+    SparsePage page = pool.freePages.back();
+    pool.freePages.pop_back();
+    m_residentPages++;
+
+    return page;
+}
+
+void SparsePageHeap::release(const SparsePage& page) {
+    m_retired[m_retireIndex].push_back(page);
+}
+
+void SparsePageHeap::endFrame() {
+    m_retireIndex = (m_retireIndex + 1) % m_retired.size();
+
+    // Oldest slot, every frame that could have referenced these pages has retired
+    std::vector<SparsePage>& retired = m_retired[m_retireIndex];
+    for (const SparsePage& page : retired) {
+        m_pools[page.memoryType].freePages.push_back(page);
+        m_residentPages--;
+    }
+    retired.clear();
+}
+
+Size SparsePageHeap::getBlockCount() const {
+    Size count = 0;
+    for (const auto& [type, pool] : m_pools) {
+        count += pool.blocks.size();
+    }
+    return count;
+}
+
+bool SparsePageHeap::allocateBlock(U32 memoryType, Pool& pool) {
+    VkMemoryAllocateInfo allocInfo = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext = nullptr,
+        .allocationSize = m_pageSize * m_pagesPerBlock,
+        .memoryTypeIndex = memoryType,
+    };
+
+    Block block = {VK_NULL_HANDLE, nullptr};
+    VkResult res = vkAllocateMemory(m_vkInfo->device, &allocInfo, nullptr, &block.memory);
+    if (!VkUtils::checkVkResult(res, "Failed to allocate sparse page block")) {
+        return false;
+    }
+
+    Debug::SetObjectName(
+            m_vkInfo->device, (U64)block.memory, VK_OBJECT_TYPE_DEVICE_MEMORY,
+            fmt::format("Sparse Page Block [{}:{}]", memoryType, pool.blocks.size()).c_str());
+
+    VkPhysicalDeviceMemoryProperties memProperties;
+    vkGetPhysicalDeviceMemoryProperties(m_vkInfo->physicalDevice, &memProperties);
+    if (memProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        res = vkMapMemory(m_vkInfo->device, block.memory, 0, VK_WHOLE_SIZE, 0, &block.mapped);
+        if (!VkUtils::checkVkResult(res, "Failed to map sparse page block")) {
+            block.mapped = nullptr;
+        }
+    }
+
+    pool.blocks.push_back(block);
+
+    // Push in reverse so pages are handed out in ascending offset order
+    pool.freePages.reserve(pool.freePages.size() + m_pagesPerBlock);
+    for (U32 i = m_pagesPerBlock; i > 0; i--) {
+        VkDeviceSize offset = (i - 1) * m_pageSize;
+        pool.freePages.push_back({
+            .memory = block.memory,
+            .offset = offset,
+            .mapped = block.mapped ? static_cast<U8*>(block.mapped) + offset : nullptr,
+            .memoryType = memoryType,
+        });
+    }
+
+    return true;
+}
@@ -0,0 +1,63 @@
+// src/RenderEngine/SparsePageHeap.hpp
+
+#pragma once
+
+#include "Config.hpp"
+#include "Core/Types.hpp"
+#include "VulkanInfo.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+struct SparsePage {
+    VkDeviceMemory memory;
+    VkDeviceSize offset;
+    void* mapped;       // nullptr unless the memory type is host visible
+    U32 memoryType;
+};
+
+// Large VkDeviceMemory blocks carved into fixed size pages, shared by every
+// sparse resource so residency is not bounded by maxMemoryAllocationCount.
+class SparsePageHeap {
+public:
+    static constexpr VkDeviceSize DEFAULT_PAGE_SIZE = 64 * 1024;
+    static constexpr U32 DEFAULT_PAGES_PER_BLOCK = 256;     // 16 MiB blocks
+
+    bool initialize(VulkanInfo* vkInfo, VkDeviceSize pageSize, U32 pagesPerBlock);
+    void shutdown();
+
+    Option<SparsePage> allocate(U32 memoryType);
+    void release(const SparsePage& page);   // Returned once frames in flight are done with it
+    void endFrame();
+
+    VkDeviceSize getPageSize() const { return m_pageSize; }
+    Size getResidentPages() const { return m_residentPages; }
+    Size getBlockCount() const;
+
+private:
+    struct Block {
+        VkDeviceMemory memory;
+        void* mapped;
+    };
+
+    struct Pool {
+        std::vector<Block> blocks;
+        std::vector<SparsePage> freePages;
+    };
+
+    bool allocateBlock(U32 memoryType, Pool& pool);
+
+    VulkanInfo* m_vkInfo = nullptr;
+    VkDeviceSize m_pageSize = 0;
+    U32 m_pagesPerBlock = 0;
+    Size m_residentPages = 0;
+
+    std::unordered_map<U32, Pool> m_pools;
+
+    std::array<std::vector<SparsePage>, Config::framesInFlight + 1> m_retired;
+    Size m_retireIndex = 0;
+
+};
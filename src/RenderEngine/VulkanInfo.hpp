@@ -8,6 +8,8 @@
 #include <vk_mem_alloc.h>
 
 class CommandPool;  // Forward Declaration
+class SparseBinder;
+class SparsePageHeap;
 
 typedef struct VulkanInfo {
     VkInstance instance;
@@ -15,6 +17,9 @@ typedef struct VulkanInfo {
 
     VkDevice device;
     VkPhysicalDevice physicalDevice;
+    bool graphicsPipelineLibrary;   // Materials link pipelines from shared parts when supported
+    bool wireframe;                 // fillModeNonSolid, anything can be drawn as lines at all
+    bool dynamicPolygonMode;        // VK_EXT_extended_dynamic_state3, draws can switch to wireframe
 
     VkQueue graphicsQueue;
     U32 graphicsQueueFamily;
@@ -22,7 +27,12 @@ typedef struct VulkanInfo {
     VkQueue transferQueue;
     U32 transferQueueFamily;
 
+    VkQueue sparseQueue;
+    U32 sparseQueueFamily;
+
     VmaAllocator allocator;
     CommandPool* transferPool;
+    SparseBinder* sparseBinder;
+    SparsePageHeap* sparseHeap;
 } VulkanInfo;
 
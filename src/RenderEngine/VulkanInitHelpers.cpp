@@ -5,6 +5,7 @@
 #include "RenderEngine/Debug.hpp"
 #include "RenderEngine/VkUtils.hpp"
 #include "spdlog/spdlog.h"
+#include <cstring>
 #include <vector>
 
 bool CreateVulkanInstance(VkInstance* instance, bool enableValidationLayers) {
@@ -100,13 +101,50 @@ bool PickPhysicalDevice(VkInstance instance, VkSurfaceKHR surface, VkPhysicalDev
     return false;
 }
 
+bool PickSparseQueueFamily(VkPhysicalDevice physicalDevice, U32 graphicsFamily, U32 transferFamily, U32* sparseFamily) {
+    U32 queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+    // Only families we already create queues for, prefer keeping binds off the graphics queue
+    if (queueFamilies[transferFamily].queueFlags & VK_QUEUE_SPARSE_BINDING_BIT) {
+        *sparseFamily = transferFamily;
+        return true;
+    }
+
+    if (queueFamilies[graphicsFamily].queueFlags & VK_QUEUE_SPARSE_BINDING_BIT) {
+        *sparseFamily = graphicsFamily;
+        return true;
+    }
+
+    return false;
+}
+
+bool HasDeviceExtension(VkPhysicalDevice physicalDevice, const char* name) {
+    U32 extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> available(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, available.data());
+
+    for (const VkExtensionProperties& extension : available) {
+        if (std::strcmp(extension.extensionName, name) == 0) return true;
+    }
+    return false;
+}
+
 bool CreateLogicalDevice(VkPhysicalDevice physicalDevice,
                          VkDevice* device, VkQueue* graphicsQueue, VkQueue* transferQueue,
                          U32 graphicsFamily, U32 transferFamily,
                          VkPhysicalDeviceFeatures& features10,
                          VkPhysicalDeviceVulkan12Features& features12,
                          VkPhysicalDeviceVulkan13Features& features13,
-                         VkPhysicalDeviceDescriptorBufferFeaturesEXT& descriptorBufferFeatures) {
+                         VkPhysicalDeviceDescriptorBufferFeaturesEXT& descriptorBufferFeatures,
+                         bool* graphicsPipelineLibrary,
+                         bool* wireframe,
+                         bool* dynamicPolygonMode) {
     descriptorBufferFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT;
     descriptorBufferFeatures.descriptorBuffer = VK_TRUE;
 
@@ -124,11 +162,84 @@ bool CreateLogicalDevice(VkPhysicalDevice physicalDevice,
     features10.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
     features10.sparseBinding = VK_TRUE;
     features10.sparseResidencyBuffer = VK_TRUE;
+    features10.sparseResidencyImage2D = VK_TRUE;
+    features10.fragmentStoresAndAtomics = VK_TRUE;     // Virtual texture feedback
+    features10.shaderStorageImageArrayDynamicIndexing = VK_TRUE;   // Per mip storage views in compute
+    features10.shaderStorageImageExtendedFormats = VK_TRUE;        // r16 heightmap storage
+
+    // Optional, wireframe drawing is disabled without it
+    VkPhysicalDeviceFeatures supported10 = {};
+    vkGetPhysicalDeviceFeatures(physicalDevice, &supported10);
+    *wireframe = supported10.fillModeNonSolid == VK_TRUE;
+    features10.fillModeNonSolid = supported10.fillModeNonSolid;
 
     std::vector<const char*> extensions = {
         "VK_KHR_swapchain",
     };
 
+    // Optional, materials build monolithic pipelines without it
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT libraryFeatures = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT,
+        .pNext = nullptr,
+        .graphicsPipelineLibrary = VK_FALSE,
+    };
+
+    *graphicsPipelineLibrary =
+        HasDeviceExtension(physicalDevice, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) &&
+        HasDeviceExtension(physicalDevice, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+
+    if (*graphicsPipelineLibrary) {
+        VkPhysicalDeviceFeatures2 supported = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &libraryFeatures,
+            .features = {},
+        };
+        vkGetPhysicalDeviceFeatures2(physicalDevice, &supported);
+        *graphicsPipelineLibrary = libraryFeatures.graphicsPipelineLibrary == VK_TRUE;
+    }
+
+    // Optional, wireframe draws need a pipeline of their own without it
+    VkPhysicalDeviceExtendedDynamicState3FeaturesEXT dynamicState3Features = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT,
+        .pNext = nullptr,
+    };
+
+    // Only ever used to switch to wireframe, pointless when the device can't draw it
+    *dynamicPolygonMode = *wireframe &&
+        HasDeviceExtension(physicalDevice, VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+
+    if (*dynamicPolygonMode) {
+        VkPhysicalDeviceFeatures2 supported = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &dynamicState3Features,
+            .features = {},
+        };
+        vkGetPhysicalDeviceFeatures2(physicalDevice, &supported);
+        *dynamicPolygonMode = dynamicState3Features.extendedDynamicState3PolygonMode == VK_TRUE;
+
+        // Only polygon mode is used, leave the rest of the extension disabled
+        dynamicState3Features = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT,
+            .pNext = nullptr,
+            .extendedDynamicState3PolygonMode = VK_TRUE,
+        };
+    }
+
+    void** featuresTail = &descriptorBufferFeatures.pNext;
+
+    if (*graphicsPipelineLibrary) {
+        extensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+        extensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+        *featuresTail = &libraryFeatures;
+        featuresTail = &libraryFeatures.pNext;
+    }
+
+    if (*dynamicPolygonMode) {
+        extensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+        *featuresTail = &dynamicState3Features;
+        featuresTail = &dynamicState3Features.pNext;
+    }
+
     float queuePriority = 1.0f;
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
 
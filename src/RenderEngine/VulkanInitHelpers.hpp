@@ -17,6 +17,18 @@ bool PickPhysicalDevice(
     U32* transferFamily
 );
 
+bool PickSparseQueueFamily(
+    VkPhysicalDevice physicalDevice,
+    U32 graphicsFamily,
+    U32 transferFamily,
+    U32* sparseFamily
+);
+
+bool HasDeviceExtension(
+    VkPhysicalDevice physicalDevice,
+    const char* name
+);
+
 bool CreateLogicalDevice(
     VkPhysicalDevice physicalDevice,
     VkDevice* device, VkQueue* graphicsQueue, VkQueue* transferQueue,
@@ -24,7 +36,10 @@ bool CreateLogicalDevice(
     VkPhysicalDeviceFeatures& features10,
     VkPhysicalDeviceVulkan12Features& features12,
     VkPhysicalDeviceVulkan13Features& features13,
-    VkPhysicalDeviceDescriptorBufferFeaturesEXT& descriptorBufferFeatures
+    VkPhysicalDeviceDescriptorBufferFeaturesEXT& descriptorBufferFeatures,
+    bool* graphicsPipelineLibrary,
+    bool* wireframe,
+    bool* dynamicPolygonMode
 );
 
 bool SetupDebugMessenger(
@@ -0,0 +1,268 @@
+// src/ResourceManagement/GeometryPool.cpp
+
+#include "GeometryPool.hpp"
+
+#include "RenderEngine/Config.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+namespace {
+    constexpr Size INDEX_STRIDE = sizeof(U32);
+
+    // Updates run before the frame's fence is waited on, so one more frame may still read a range
+    constexpr U64 RETIRE_FRAMES = Config::framesInFlight + 1;
+
+    Size alignUp(Size value, Size alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+bool GeometryPool::init(VulkanInfo* vkInfo, Size vertexCapacity, Size indexCapacity) {
+    m_vkInfo = vkInfo;
+    m_frame = 0;
+
+    if (!initArena(
+            m_vertices, vertexCapacity,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, "Geometry Pool Vertices")) {
+        return false;
+    }
+
+    if (!initArena(
+            m_indices, indexCapacity,
+            VK_BUFFER_USAGE_INDEX_BUFFER_BIT, "Geometry Pool Indices")) {
+        m_vertices.buffer.shutdown();
+        return false;
+    }
+
+    return true;
+}
+
+bool GeometryPool::initArena(Arena& arena, Size capacity, VkBufferUsageFlags usage, std::string name) {
+    // Host visible pages, meshes are written in place instead of going through staging copies
+    if (!arena.buffer.init(m_vkInfo, capacity, usage, VMA_MEMORY_USAGE_CPU_TO_GPU, name)) {
+        spdlog::error("Failed to create {}", name);
+        return false;
+    }
+
+    arena.capacity = capacity;
+    arena.used = 0;
+    arena.freeRanges = {{0, capacity}};
+    arena.owners.clear();
+    arena.pageRefs.assign((capacity + arena.buffer.getPageSize() - 1) / arena.buffer.getPageSize(), 0);
+
+    return true;
+}
+
+void GeometryPool::shutdown() {
+    m_vertices.buffer.shutdown();
+    m_indices.buffer.shutdown();
+
+    m_meshes.clear();
+    m_freeMeshes.clear();
+    m_retired.clear();
+}
+
+Option<U32> GeometryPool::allocate(
+        const void* vertices, Size vertexSize, Size vertexStride, const U32* indices, U32 indexCount
+) {
+    Size indexSize = indexCount * INDEX_STRIDE;
+
+    // Vertex ranges start on a whole vertex so draws can address them with vertexOffset
+    Option<Size> vertexOffset = 0;
+    if (vertexSize > 0) {
+        vertexOffset = m_vertices.allocate(vertexSize, vertexStride, m_vertices.capacity);
+        if (!vertexOffset.has_value()) {
+            spdlog::error("Geometry pool is out of vertex space ({} bytes requested)", vertexSize);
+            return std::nullopt;
+        }
+    }
+
+    Option<Size> indexOffset = m_indices.allocate(indexSize, INDEX_STRIDE, m_indices.capacity);
+    if (!indexOffset.has_value()) {
+        spdlog::error("Geometry pool is out of index space ({} bytes requested)", indexSize);
+        if (vertexSize > 0) m_vertices.release(vertexOffset.value(), vertexSize);
+        return std::nullopt;
+    }
+
+    if (vertexSize > 0) m_vertices.buffer.updateData(vertices, vertexSize, vertexOffset.value());
+    m_indices.buffer.updateData(indices, indexSize, indexOffset.value());
+
+    U32 mesh;
+    if (!m_freeMeshes.empty()) {
+        mesh = m_freeMeshes.back();
+        m_freeMeshes.pop_back();
+    } else {
+        mesh = static_cast<U32>(m_meshes.size());
+        m_meshes.push_back({});
+    }
+
+    m_meshes[mesh] = {
+        .live = true,
+        .vertexOffset = vertexOffset.value(),
+        .vertexSize = vertexSize,
+        .vertexStride = vertexStride,
+        .indexOffset = indexOffset.value(),
+        .indexSize = indexSize,
+    };
+
+    if (vertexSize > 0) m_vertices.owners[vertexOffset.value()] = mesh;
+    m_indices.owners[indexOffset.value()] = mesh;
+
+    return mesh;
+}
+
+void GeometryPool::free(U32 mesh) {
+    assert(mesh < m_meshes.size() && m_meshes[mesh].live && "Freeing an invalid geometry pool mesh!");
+
+    MeshRecord& record = m_meshes[mesh];
+    record.live = false;
+
+    m_indices.owners.erase(record.indexOffset);
+
+    // Frames in flight may still draw from these ranges
+    if (record.vertexSize > 0) {
+        m_vertices.owners.erase(record.vertexOffset);
+        m_retired.push_back({&m_vertices, record.vertexOffset, record.vertexSize, m_frame});
+    }
+    m_retired.push_back({&m_indices, record.indexOffset, record.indexSize, m_frame});
+
+    m_freeMeshes.push_back(mesh);
+}
+
+GeometryRange GeometryPool::getRange(U32 mesh) const {
+    const MeshRecord& record = m_meshes[mesh];
+
+    return {
+        .firstIndex = static_cast<U32>(record.indexOffset / INDEX_STRIDE),
+        .vertexOffset = record.vertexSize > 0 ? static_cast<I32>(record.vertexOffset / record.vertexStride) : 0,
+        .indexCount = static_cast<U32>(record.indexSize / INDEX_STRIDE),
+    };
+}
+
+void GeometryPool::update(Size maxMoveBytes) {
+    m_frame++;
+
+    std::erase_if(m_retired, [&](const Retired& retired) {
+        if (retired.frame + RETIRE_FRAMES > m_frame) return false;
+        retired.arena->release(retired.offset, retired.size);
+        return true;
+    });
+
+    Size moved = compact(m_vertices, true, maxMoveBytes);
+    compact(m_indices, false, maxMoveBytes - std::min(moved, maxMoveBytes));
+
+    m_vertices.buffer.flushPendingBinds();
+    m_indices.buffer.flushPendingBinds();
+}
+
+Size GeometryPool::compact(Arena& arena, bool vertexArena, Size maxMoveBytes) {
+    constexpr Size MAX_CANDIDATES = 16;
+
+    Size moved = 0;
+    Size candidates = 0;
+
+    // Highest ranges first, into the lowest hole that fits below them
+    for (auto it = arena.owners.rbegin();
+            it != arena.owners.rend() && candidates < MAX_CANDIDATES;
+            candidates++) {
+        U32 mesh = it->second;
+        MeshRecord& record = m_meshes[mesh];
+
+        Size oldOffset = it->first;
+        Size size = vertexArena ? record.vertexSize : record.indexSize;
+        Size alignment = vertexArena ? record.vertexStride : INDEX_STRIDE;
+
+        if (moved + size > maxMoveBytes) break;
+
+        Option<Size> newOffset = arena.allocate(size, alignment, oldOffset);
+        if (!newOffset.has_value()) {
+            ++it;
+            continue;
+        }
+
+        // Both ranges are host visible. This frame's draws already captured the old offsets,
+        // so the old range stays retired until they have retired too
+        std::vector<U8> data(size);
+        arena.buffer.readData(data.data(), size, oldOffset);
+        arena.buffer.updateData(data.data(), size, newOffset.value());
+
+        (vertexArena ? record.vertexOffset : record.indexOffset) = newOffset.value();
+
+        it = std::make_reverse_iterator(arena.owners.erase(std::next(it).base()));
+        arena.owners[newOffset.value()] = mesh;
+
+        m_retired.push_back({&arena, oldOffset, size, m_frame});
+        moved += size;
+    }
+
+    return moved;
+}
+
+Size GeometryPool::getResidentBytes() const {
+    return m_vertices.buffer.getResidentBytes() + m_indices.buffer.getResidentBytes();
+}
+
+Option<Size> GeometryPool::Arena::allocate(Size size, Size alignment, Size below) {
+    if (size == 0) return std::nullopt;
+
+    for (auto it = freeRanges.begin(); it != freeRanges.end() && it->first < below; ++it) {
+        Size rangeOffset = it->first;
+        Size rangeEnd = it->first + it->second;
+
+        Size offset = alignUp(rangeOffset, alignment);
+        if (offset + size > std::min(rangeEnd, below)) continue;
+
+        // Split off whatever is left on either side
+        freeRanges.erase(it);
+        if (offset > rangeOffset) freeRanges[rangeOffset] = offset - rangeOffset;
+        if (offset + size < rangeEnd) freeRanges[offset + size] = rangeEnd - (offset + size);
+
+        reference(offset, size);
+        used += size;
+
+        return offset;
+    }
+
+    return std::nullopt;
+}
+
+void GeometryPool::Arena::reference(Size offset, Size size) {
+    Size pageSize = buffer.getPageSize();
+    for (Size page = offset / pageSize; page < (offset + size + pageSize - 1) / pageSize; page++) {
+        pageRefs[page]++;
+    }
+
+    // Pages already backed by a neighbour are skipped
+    buffer.bindMemory(size, offset);
+}
+
+void GeometryPool::Arena::release(Size offset, Size size) {
+    Size pageSize = buffer.getPageSize();
+    for (Size page = offset / pageSize; page < (offset + size + pageSize - 1) / pageSize; page++) {
+        if (--pageRefs[page] == 0) buffer.unbindMemory(pageSize, page * pageSize);
+    }
+
+    used -= size;
+
+    // Coalesce with the neighbouring free ranges
+    Size last = offset + size;
+    auto next = freeRanges.lower_bound(offset);
+    if (next != freeRanges.end() && next->first == last) {
+        last += next->second;
+        next = freeRanges.erase(next);
+    }
+
+    if (next != freeRanges.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            offset = previous->first;
+            freeRanges.erase(previous);
+        }
+    }
+
+    freeRanges[offset] = last - offset;
+}
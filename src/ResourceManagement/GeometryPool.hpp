@@ -0,0 +1,94 @@
+// src/ResourceManagement/GeometryPool.hpp
+
+#pragma once
+
+#include "Core/Types.hpp"
+#include "RenderEngine/VulkanInfo.hpp"
+#include "RenderResources/Buffer.hpp"
+#include "RenderResources/SparseBuffer.hpp"
+
+#include <map>
+#include <vector>
+
+// Where a pooled mesh currently lives, fetched per draw since defragmentation moves meshes
+struct GeometryRange {
+    U32 firstIndex;
+    I32 vertexOffset;   // In vertices
+    U32 indexCount;
+};
+
+// One vertex and one index buffer for every mesh in the world.
+//
+// Both are large sparse buffers, only the pages under live meshes are backed by
+// memory. Freed ranges are retired until every frame that could draw from them has
+// completed before they are reused or their pages unbound, and update() slides meshes
+// from the top of each buffer into lower holes so the tail pages can be released.
+class GeometryPool {
+public:
+    static constexpr Size DEFAULT_VERTEX_CAPACITY = 256 * 1024 * 1024;
+    static constexpr Size DEFAULT_INDEX_CAPACITY = 64 * 1024 * 1024;
+
+    bool init(VulkanInfo* vkInfo, Size vertexCapacity, Size indexCapacity);
+    void shutdown();
+
+    // vertexSize 0 for index only meshes whose vertices come from gl_VertexIndex
+    Option<U32> allocate(const void* vertices, Size vertexSize, Size vertexStride, const U32* indices, U32 indexCount);
+    void free(U32 mesh);
+
+    GeometryRange getRange(U32 mesh) const;
+
+    Buffer* getVertexBuffer() { return &m_vertices.buffer.buffer; }
+    Buffer* getIndexBuffer() { return &m_indices.buffer.buffer; }
+
+    // Once per frame before submission: retires frees, moves up to maxMoveBytes, flushes binds
+    void update(Size maxMoveBytes);
+
+    Size getUsedBytes() const { return m_vertices.used + m_indices.used; }
+    Size getResidentBytes() const;
+
+private:
+    struct Arena {
+        SparseBuffer buffer;
+        Size capacity = 0;
+        Size used = 0;
+
+        std::map<Size, Size> freeRanges;    // offset -> size, coalesced
+        std::map<Size, U32> owners;         // offset -> mesh, live ranges only
+        std::vector<U32> pageRefs;          // Live or retiring ranges touching each page
+
+        Option<Size> allocate(Size size, Size alignment, Size below);
+        void release(Size offset, Size size);
+        void reference(Size offset, Size size);
+    };
+
+    struct MeshRecord {
+        bool live;
+        Size vertexOffset;
+        Size vertexSize;
+        Size vertexStride;
+        Size indexOffset;
+        Size indexSize;
+    };
+
+    struct Retired {
+        Arena* arena;
+        Size offset;
+        Size size;
+        U64 frame;
+    };
+
+    bool initArena(Arena& arena, Size capacity, VkBufferUsageFlags usage, std::string name);
+    Size compact(Arena& arena, bool vertexArena, Size maxMoveBytes);
+
+    VulkanInfo* m_vkInfo = nullptr;
+
+    Arena m_vertices;
+    Arena m_indices;
+
+    std::vector<MeshRecord> m_meshes;
+    std::vector<U32> m_freeMeshes;
+
+    std::vector<Retired> m_retired;
+    U64 m_frame = 0;
+
+};
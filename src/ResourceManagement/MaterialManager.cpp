@@ -3,62 +3,312 @@
 #include "MaterialManager.hpp"
 
 #include "RenderEngine/RenderObjects/Materials.hpp"
+#include "RenderEngine/RenderObjects/PipelineBuilder.hpp"
 #include "ResourceManagement/MaterialManagerUtils/yamlParsers.hpp"
 #include "ResourceManagement/RenderResources/DescriptorPool.hpp"
 #include "ResourceManagement/RenderResources/DescriptorSet.hpp"
+#include "RenderEngine/VkUtils.hpp"
 
 #include <fmt/format.h>
 #include <spdlog/spdlog.h>
 #include <yaml-cpp/yaml.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace {
+    constexpr char PIPELINE_CACHE_MAGIC[8] = {'W', 'S', 'P', 'S', 'O', 'C', 'H', '\0'};
+}
+
 bool MaterialManager::initialize(VulkanInfo* vkInfo) {
     m_vkInfo = vkInfo;
+    m_initializeTime = Duration::now();
+
+    std::vector<U8> initialData = loadPipelineCacheData();
+    m_pipelineCacheWarm = !initialData.empty();
+
+    VkPipelineCacheCreateInfo cacheInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .initialDataSize = initialData.size(),
+        .pInitialData = initialData.data(),
+    };
+
+    VkResult result = vkCreatePipelineCache(m_vkInfo->device, &cacheInfo, nullptr, &m_pipelineCache);
+    if (result != VK_SUCCESS && m_pipelineCacheWarm) {
+        // Drivers may still refuse data that passed the header checks, start cold instead
+        spdlog::warn("Driver rejected {}, starting with an empty pipeline cache", pipelineCachePath.string());
+        m_pipelineCacheWarm = false;
+        cacheInfo.initialDataSize = 0;
+        cacheInfo.pInitialData = nullptr;
+        result = vkCreatePipelineCache(m_vkInfo->device, &cacheInfo, nullptr, &m_pipelineCache);
+    }
+    if (!VkUtils::checkVkResult(result, "Couldn't create pipeline cache")) {
+        return false;
+    }
+
+    spdlog::info("Pipeline cache is {}", m_pipelineCacheWarm ? "warm" : "cold");
+
+    // Graphics materials are checked against it and share its layout as set 0
+    m_globalLayout = getLayout(globalLayoutPath.string());
+    m_globalPipelineLayout = getPipelineLayout({m_globalLayout}, {SHARED_PUSH_CONSTANT_RANGE});
+    if (m_globalPipelineLayout == nullptr) {
+        spdlog::error("Couldn't create the global pipeline layout");
+        return false;
+    }
+
+    m_compileWorker = std::jthread([this](std::stop_token stop) { compilePipelines(stop); });
     return true;
 }
 
+std::vector<U8> MaterialManager::loadPipelineCacheData() {
+    std::ifstream file(pipelineCachePath, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) return {};
+
+    Size fileSize = static_cast<Size>(file.tellg());
+    if (fileSize < sizeof(PipelineCacheFileHeader) + sizeof(VkPipelineCacheHeaderVersionOne)) return {};
+
+    PipelineCacheFileHeader fileHeader;
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader));
+
+    std::vector<U8> data(fileSize - sizeof(fileHeader));
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+    if (!file) return {};
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_vkInfo->physicalDevice, &properties);
+
+    VkPipelineCacheHeaderVersionOne header;
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    // Blobs from another GPU or driver build are at best useless, at worst crash the driver
+    bool valid = std::memcmp(fileHeader.magic, PIPELINE_CACHE_MAGIC, sizeof(PIPELINE_CACHE_MAGIC)) == 0
+            && fileHeader.dataSize == data.size()
+            && fileHeader.driverVersion == properties.driverVersion
+            && header.headerSize >= sizeof(header)
+            && header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+            && header.vendorID == properties.vendorID
+            && header.deviceID == properties.deviceID
+            && std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+
+    if (!valid) {
+        spdlog::info("Discarding stale pipeline cache {}", pipelineCachePath.string());
+        return {};
+    }
+
+    return data;
+}
+
+void MaterialManager::savePipelineCache() {
+    Size dataSize = 0;
+    if (vkGetPipelineCacheData(m_vkInfo->device, m_pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) {
+        return;
+    }
+
+    std::vector<U8> data(dataSize);
+    if (vkGetPipelineCacheData(m_vkInfo->device, m_pipelineCache, &dataSize, data.data()) != VK_SUCCESS) {
+        spdlog::warn("Failed to read back the pipeline cache");
+        return;
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_vkInfo->physicalDevice, &properties);
+
+    PipelineCacheFileHeader fileHeader = {
+        .magic = {},
+        .driverVersion = properties.driverVersion,
+        .dataSize = static_cast<U32>(dataSize),
+    };
+    std::memcpy(fileHeader.magic, PIPELINE_CACHE_MAGIC, sizeof(PIPELINE_CACHE_MAGIC));
+
+    std::error_code error;
+    fs::create_directories(pipelineCachePath.parent_path(), error);
+
+    // Written aside and renamed, so a crash mid write leaves the previous cache intact
+    fs::path temporary = pipelineCachePath;
+    temporary += ".tmp";
+
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        spdlog::warn("Failed to write pipeline cache {}", temporary.string());
+        return;
+    }
+
+    file.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+    file.write(reinterpret_cast<const char*>(data.data()), dataSize);
+    file.close();
+
+    fs::rename(temporary, pipelineCachePath, error);
+    if (error) {
+        spdlog::warn("Failed to store pipeline cache {}: {}", pipelineCachePath.string(), error.message());
+        fs::remove(temporary, error);
+    }
+}
+
 void MaterialManager::shutdown() {
-    // Clear all images
+    stopCompiling();
+    m_fallbacks.clear();
+
+    if (m_pipelineCache != nullptr) {
+        savePipelineCache();
+        vkDestroyPipelineCache(m_vkInfo->device, m_pipelineCache, nullptr);
+        m_pipelineCache = nullptr;
+    }
+
+    // Preloaded materials nobody picked up are still live with no references
     for (auto& pair : m_materialInfos) {
-        auto& refCount = pair.second;
-        if (refCount.references > 0) {
-            destroyMaterialInfo(&refCount.value);
-        }
+        destroyMaterialInfo(&pair.second.value);
     }
     m_materialInfos.clear();
+
+    if (m_globalPipelineLayout != nullptr) {
+        dropPipelineLayout(m_globalPipelineLayout);
+        dropLayout(&m_globalLayout);
+        m_globalPipelineLayout = nullptr;
+    }
+
+    for (auto& [key, library] : m_pipelineLibraries) {
+        vkDestroyPipeline(m_vkInfo->device, library, nullptr);
+    }
+    m_pipelineLibraries.clear();
 }
 
-DescriptorSetInfo MaterialManager::getLayout(std::string path) {
-    auto it = m_descriptorLayouts.find(path);
-    if (it != m_descriptorLayouts.end()) {
-        it->second.references++;
-        return it->second.value;
+VkPipeline MaterialManager::getPipelineLibrary(const std::string& key, const std::function<VkPipeline()>& build) {
+    {
+        std::lock_guard<std::mutex> lock(m_libraryMutex);
+        auto it = m_pipelineLibraries.find(key);
+        if (it != m_pipelineLibraries.end()) {
+            return it->second;
+        }
+    }
+
+    // Built unlocked so workers compile different parts at once, a racing duplicate is dropped
+    VkPipeline library = build();
+    if (library == nullptr) {
+        return nullptr;
     }
 
+    std::lock_guard<std::mutex> lock(m_libraryMutex);
+    auto [it, inserted] = m_pipelineLibraries.try_emplace(key, library);
+    if (!inserted) {
+        vkDestroyPipeline(m_vkInfo->device, library, nullptr);
+    }
+    return it->second;
+}
+
+DescriptorSetInfo MaterialManager::getLayout(std::string path) {
     fs::path fullPath = resourceBasePath / path;
 
     if (!fs::exists(fullPath)) {
         spdlog::error("Material Descriptor not found: {}", fullPath.string());
     }
 
-    // Get Material Info
     YAML::Node yaml = YAML::LoadFile(fullPath);
-    DescriptorSetInfo layout = MaterialManagerUtils::yamlToLayout(yaml, m_vkInfo->device).value();
+    return getLayout(MaterialManagerUtils::yamlToBindings(yaml));
+}
 
-    m_descriptorLayouts[path] = RefCount<DescriptorSetInfo>{
+DescriptorSetInfo MaterialManager::getLayout(const std::vector<DescriptorBindingInfo>& bindings) {
+    std::string key = MaterialManagerUtils::descriptorLayoutKey(bindings);
+
+    std::lock_guard<std::mutex> lock(m_layoutMutex);
+
+    auto it = m_descriptorLayouts.find(key);
+    if (it != m_descriptorLayouts.end()) {
+        it->second.references++;
+        return it->second.value;
+    }
+
+    DescriptorSetInfo layout = MaterialManagerUtils::bindingsToLayout(bindings, m_vkInfo->device).value();
+
+    m_descriptorLayouts[key] = RefCount<DescriptorSetInfo>{
         .value = layout,
         .references = 1,
     };
 
-    return m_descriptorLayouts[path].value;
+    return m_descriptorLayouts[key].value;
 }
 
-MaterialInfo* MaterialManager::getInfo(std::string path, const ProvidedVertexLayout* layout) {
-    auto it = m_materialInfos.find(path);
-    if (it != m_materialInfos.end()) {
+VkPipelineLayout MaterialManager::getPipelineLayout(
+        const std::vector<DescriptorSetInfo>& sets,
+        const std::vector<VkPushConstantRange>& pushConstants
+) {
+    // Set layouts are shared by the same key, so equal keys also mean equal handles
+    std::string key;
+    for (const DescriptorSetInfo& set : sets) {
+        key += MaterialManagerUtils::descriptorLayoutKey(set.bindings) + "|";
+    }
+    for (const VkPushConstantRange& range : pushConstants) {
+        key += fmt::format("{}:{}:{};", range.stageFlags, range.offset, range.size);
+    }
+
+    std::lock_guard<std::mutex> lock(m_layoutMutex);
+
+    auto it = m_pipelineLayouts.find(key);
+    if (it != m_pipelineLayouts.end()) {
         it->second.references++;
-        return &it->second.value;
+        return it->second.value;
+    }
+
+    PipelineBuilder builder;
+    for (const DescriptorSetInfo& set : sets) {
+        builder.addDescriptorLayout(set);
+    }
+    for (const VkPushConstantRange& range : pushConstants) {
+        builder.addPushConstant(range.stageFlags, range.size, range.offset);
+    }
+
+    VkPipelineLayout layout = builder.buildLayout(m_vkInfo->device);
+    if (layout == nullptr) {
+        return nullptr;
     }
 
+    m_pipelineLayouts[key] = RefCount<VkPipelineLayout>{
+        .value = layout,
+        .references = 1,
+    };
+
+    return layout;
+}
+
+void MaterialManager::dropPipelineLayout(VkPipelineLayout layout) {
+    std::lock_guard<std::mutex> lock(m_layoutMutex);
+
+    for (auto it = m_pipelineLayouts.begin(); it != m_pipelineLayouts.end(); ++it) {
+        if (it->second.value == layout) {
+            it->second.references--;
+
+            if (it->second.references <= 0) {
+                vkDestroyPipelineLayout(m_vkInfo->device, layout, nullptr);
+                m_pipelineLayouts.erase(it);
+            }
+            return;
+        }
+    }
+
+    spdlog::error("Pipeline layout not found for dropping!");
+}
+
+GlobalDescriptors MaterialManager::createGlobalDescriptors(DescriptorPool* descriptor) {
+    return GlobalDescriptors{
+        .set = descriptor->allocate(m_globalLayout.layout),
+        .layout = m_globalPipelineLayout,
+    };
+}
+
+std::string MaterialManager::materialKey(const std::string& path, const Specialization& specialization) {
+    return path + MaterialManagerUtils::specializationKey(specialization);
+}
+
+Result<MaterialInfo, std::string> MaterialManager::buildInfo(
+        std::string path,
+        const ProvidedVertexLayout* layout,
+        const Specialization& specialization
+) {
     fs::path materialFolder = resourceBasePath / path;
     fs::path fullPath = materialFolder / "pipeline.yaml";
 
@@ -68,47 +318,136 @@ MaterialInfo* MaterialManager::getInfo(std::string path, const ProvidedVertexLay
 
     // Get Material Info
     YAML::Node yaml = YAML::LoadFile(fullPath);
-    MaterialInfo matInfo = MaterialManagerUtils::yamlToInfo(
+    Result<MaterialInfo, std::string> matInfo = MaterialManagerUtils::yamlToInfo(
         this,
         yaml,
         resourceBasePath,
         path,
         m_vkInfo->device,
-        layout
-    ).value();
+        layout,
+        specialization
+    );
+
+    return matInfo;
+}
+
+void MaterialManager::recordPipelineBuild(Duration buildTime) {
+    m_pipelinesBuilt++;
+    m_pipelineBuildMilliseconds += buildTime.asMilliseconds();
+}
+
+void MaterialManager::preload(std::span<const MaterialRequest> materials) {
+    std::vector<const MaterialRequest*> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_materialMutex);
+        for (const MaterialRequest& material : materials) {
+            std::string key = materialKey(material.path, material.specialization);
+            bool queued = std::any_of(pending.begin(), pending.end(), [&](const MaterialRequest* other) {
+                return materialKey(other->path, other->specialization) == key;
+            });
+            if (!queued && !m_materialInfos.contains(key)) {
+                pending.push_back(&material);
+            }
+        }
+    }
+
+    // Each worker pulls the next material, shader compiles and pipeline creation are thread safe
+    std::atomic<Size> next = 0;
+    auto buildMaterials = [&]() {
+        for (Size i = next++; i < pending.size(); i = next++) {
+            const MaterialRequest* material = pending[i];
+
+            Result<MaterialInfo, std::string> matInfo;
+            try {
+                matInfo = buildInfo(material->path, material->layout, material->specialization);
+            } catch (const std::exception& error) {
+                matInfo = std::unexpected(std::string(error.what()));
+            }
+
+            // Left for getInfo to build again, where the error surfaces as usual
+            if (!matInfo.has_value()) {
+                spdlog::error("Failed to preload material {}: {}", material->path, matInfo.error());
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(m_materialMutex);
+            m_materialInfos[materialKey(material->path, material->specialization)] = RefCount<MaterialInfo>{
+                .value = matInfo.value(),
+                .references = 0,
+            };
+        }
+    };
+
+    U32 threadCount = std::clamp(
+            static_cast<U32>(pending.size()), 1u, std::max(std::thread::hardware_concurrency(), 1u)
+    );
+
+    // The calling thread works too and the jthreads join on scope exit
+    {
+        std::vector<std::jthread> workers;
+        for (U32 i = 1; i < threadCount; i++) {
+            workers.emplace_back(buildMaterials);
+        }
+        buildMaterials();
+    }
+
+    spdlog::info("Preloaded {} materials on {} threads", pending.size(), threadCount);
+}
+
+MaterialInfo* MaterialManager::getInfo(
+        std::string path,
+        const ProvidedVertexLayout* layout,
+        const Specialization& specialization
+) {
+    std::string key = materialKey(path, specialization);
+    {
+        std::lock_guard<std::mutex> lock(m_materialMutex);
+        auto it = m_materialInfos.find(key);
+        if (it != m_materialInfos.end()) {
+            it->second.references++;
+            return &it->second.value;
+        }
+    }
 
-    m_materialInfos[path] = RefCount<MaterialInfo>{
+    MaterialInfo matInfo = buildInfo(path, layout, specialization).value();
+
+    std::lock_guard<std::mutex> lock(m_materialMutex);
+    m_materialInfos[key] = RefCount<MaterialInfo>{
         .value = matInfo,
         .references = 1,
     };
 
-    return &m_materialInfos[path].value;
+    return &m_materialInfos[key].value;
 }
 
 void MaterialManager::destroyMaterialInfo(MaterialInfo* info) {
     vkDestroyPipeline(m_vkInfo->device, info->pipeline, nullptr);
-    vkDestroyPipelineLayout(m_vkInfo->device, info->pipelineLayout, nullptr);
+    dropPipelineLayout(info->pipelineLayout);
 
     for (DescriptorSetInfo set : info->descriptorSets) {
         this->dropLayout(&set);
     }
 }
 
-bool compareMaterialInfo(MaterialInfo a, MaterialInfo b) {
-   return a.pipeline == b.pipeline &&
-          a.pipelineLayout == b.pipelineLayout &&
-          a.type == b.type &&
-          a.descriptorSets == b.descriptorSets;
-}
-
 void MaterialManager::dropMaterialInfo(MaterialInfo* info) {
+    std::lock_guard<std::mutex> lock(m_materialMutex);
+
+    // Matched by address, materials may share pipeline layouts and, while compiling, pipelines
     for (auto it = m_materialInfos.begin(); it != m_materialInfos.end(); ++it) {
-        auto sharedResource = it->second.value;
-        if (compareMaterialInfo(sharedResource, *info)) {
+        if (&it->second.value == info) {
             // Decrement reference count
             it->second.references--;
 
             if (it->second.references <= 0) {
+                // Still compiling, destroyed once the worker is done with its layout
+                auto pending = m_pendingPipelines.find(it->first);
+                if (pending != m_pendingPipelines.end()) {
+                    pending->second.orphaned = true;
+                    pending->second.orphan = it->second.value;
+                    m_materialInfos.erase(it);
+                    return;
+                }
+
                 // If reference count is zero, apply custom shutdown logic
                 destroyMaterialInfo(info);
                 m_materialInfos.erase(it);
@@ -126,6 +465,8 @@ void MaterialManager::destroyDescriptorLayoutInfo(DescriptorSetInfo* info) {
 }
 
 void MaterialManager::dropLayout(DescriptorSetInfo* layout) {
+    std::lock_guard<std::mutex> lock(m_layoutMutex);
+
     for (auto it = m_descriptorLayouts.begin(); it != m_descriptorLayouts.end(); ++it) {
         auto sharedResource = it->second.value;
         if (sharedResource == *layout) {
@@ -147,13 +488,30 @@ void MaterialManager::dropLayout(DescriptorSetInfo* layout) {
 MaterialData MaterialManager::getData(
         std::string path,
         DescriptorPool* descriptor,
-        const ProvidedVertexLayout* layout
+        const ProvidedVertexLayout* layout,
+        const Specialization& specialization
 ) {
-    MaterialInfo* materialInfo = getInfo(path, layout);
+    return createData(getInfo(path, layout, specialization), descriptor);
+}
 
+MaterialData MaterialManager::getDataAsync(
+        std::string path,
+        DescriptorPool* descriptor,
+        const ProvidedVertexLayout* layout,
+        std::string fallback,
+        const Specialization& specialization
+) {
+    return createData(getInfoAsync(path, layout, fallback, specialization), descriptor);
+}
+
+MaterialData MaterialManager::createData(MaterialInfo* materialInfo, DescriptorPool* descriptor) {
     std::vector<DescriptorSetData> descriptorSets = {};
 
     for (Size i = 0; i < materialInfo->descriptorSets.size(); i++) {
+        // The global set is bound once per pass, sets no shader reads need nothing bound
+        bool global = i == 0 && materialInfo->type != MaterialType::Compute;
+        if (global || materialInfo->descriptorSets[i].bindings.empty()) continue;
+
         std::vector<U32> bindingDatas;
 
         DescriptorSet set = descriptor->allocate(materialInfo->descriptorSets[i].layout);
@@ -179,6 +537,195 @@ MaterialData MaterialManager::getData(
     return data;
 }
 
+void MaterialManager::registerFallback(std::string path, const ProvidedVertexLayout* layout) {
+    if (m_fallbacks.contains(path)) return;
+
+    // The reference is never dropped, shutdown destroys it with everything else
+    m_fallbacks[path] = getInfo(path, layout);
+}
+
+MaterialInfo* MaterialManager::getInfoAsync(
+        std::string path,
+        const ProvidedVertexLayout* layout,
+        std::string fallback,
+        const Specialization& specialization
+) {
+    std::string key = materialKey(path, specialization);
+    {
+        std::lock_guard<std::mutex> lock(m_materialMutex);
+        auto it = m_materialInfos.find(key);
+        if (it != m_materialInfos.end()) {
+            it->second.references++;
+            return &it->second.value;
+        }
+    }
+
+    // Dropped and asked for again before its compile finished
+    auto pending = m_pendingPipelines.find(key);
+    if (pending != m_pendingPipelines.end() && pending->second.orphaned) {
+        pending->second.orphaned = false;
+
+        std::lock_guard<std::mutex> lock(m_materialMutex);
+        m_materialInfos[key] = RefCount<MaterialInfo>{
+            .value = pending->second.orphan,
+            .references = 1,
+        };
+        return &m_materialInfos[key].value;
+    }
+
+    fs::path fullPath = resourceBasePath / path / "pipeline.yaml";
+    if (!fs::exists(fullPath)) {
+        spdlog::error("Material Descriptor not found: {}", fullPath.string());
+    }
+
+    // Only the layouts are made here, so descriptor sets can be allocated and written now.
+    // Reflecting them compiles the shaders, which the pipeline build then reads from the SPIR-V cache.
+    YAML::Node yaml = YAML::LoadFile(fullPath);
+    MaterialInfo matInfo = MaterialManagerUtils::yamlToPipelineLayout(this, yaml, resourceBasePath, path).value();
+
+    // Layouts are shared by content, so the same handle means the material's sets bind against the fallback
+    auto fallbackIt = m_fallbacks.find(fallback);
+    if (fallbackIt != m_fallbacks.end()
+            && fallbackIt->second->type == matInfo.type
+            && fallbackIt->second->pipelineLayout == matInfo.pipelineLayout) {
+        matInfo.pipeline = fallbackIt->second->pipeline;
+    } else if (!fallback.empty()) {
+        spdlog::warn("Fallback material {} is not registered or does not fit {}, skipping it until compiled", fallback, path);
+    }
+
+    m_pendingPipelines[key] = PendingPipeline{
+        .orphaned = false,
+        .orphan = {},
+    };
+
+    m_reportBuilds = true;
+    {
+        std::lock_guard<std::mutex> lock(m_compileMutex);
+        m_compileQueue.push_back(AsyncBuild{
+            .key = key,
+            .path = path,
+            .yaml = yaml,
+            .layout = layout != nullptr ? Option<ProvidedVertexLayout>(*layout) : std::nullopt,
+            .specialization = specialization,
+            .layoutInfo = matInfo,
+        });
+    }
+    m_compileCondition.notify_one();
+
+    std::lock_guard<std::mutex> lock(m_materialMutex);
+    m_materialInfos[key] = RefCount<MaterialInfo>{
+        .value = matInfo,
+        .references = 1,
+    };
+
+    return &m_materialInfos[key].value;
+}
+
+void MaterialManager::compilePipelines(std::stop_token stop) {
+    while (true) {
+        AsyncBuild build;
+        {
+            std::unique_lock<std::mutex> lock(m_compileMutex);
+            m_compileCondition.wait(lock, stop, [&]() { return !m_compileQueue.empty(); });
+            if (stop.stop_requested()) return;
+
+            build = std::move(m_compileQueue.front());
+            m_compileQueue.pop_front();
+        }
+
+        Result<VkPipeline, std::string> pipeline;
+        try {
+            pipeline = MaterialManagerUtils::yamlToPipeline(
+                this,
+                build.yaml,
+                resourceBasePath,
+                build.path,
+                m_vkInfo->device,
+                build.layout.has_value() ? &build.layout.value() : nullptr,
+                build.layoutInfo,
+                build.specialization
+            );
+        } catch (const std::exception& error) {
+            pipeline = std::unexpected(std::string(error.what()));
+        }
+
+        std::lock_guard<std::mutex> lock(m_compileMutex);
+        m_compiled.push_back(AsyncResult{
+            .key = build.key,
+            .pipeline = pipeline,
+        });
+    }
+}
+
+void MaterialManager::update() {
+    std::vector<AsyncResult> compiled;
+    {
+        std::lock_guard<std::mutex> lock(m_compileMutex);
+        compiled.swap(m_compiled);
+    }
+
+    for (AsyncResult& result : compiled) {
+        auto pending = m_pendingPipelines.find(result.key);
+        PendingPipeline record = pending->second;
+        m_pendingPipelines.erase(pending);
+
+        if (!result.pipeline.has_value()) {
+            spdlog::error("Failed to compile material {}: {}", result.key, result.pipeline.error());
+        }
+        VkPipeline pipeline = result.pipeline.value_or(nullptr);
+
+        if (record.orphaned) {
+            record.orphan.pipeline = pipeline;
+            destroyMaterialInfo(&record.orphan);
+            continue;
+        }
+
+        // Frames in flight may have recorded the fallback, which lives until shutdown.
+        // A failed material is skipped from now on rather than left on the fallback.
+        std::lock_guard<std::mutex> lock(m_materialMutex);
+        m_materialInfos.at(result.key).value.pipeline = pipeline;
+    }
+
+    // Compare runs with and without cache/pipelines.bin for cold vs warm startup
+    if (m_reportBuilds && m_pendingPipelines.empty()) {
+        m_reportBuilds = false;
+        spdlog::info(
+                "Pipelines done {:.1f} ms after startup, {} built in {:.1f} ms with a {} pipeline cache",
+                Duration::since(m_initializeTime).asMilliseconds(),
+                m_pipelinesBuilt.load(),
+                m_pipelineBuildMilliseconds.load(),
+                m_pipelineCacheWarm ? "warm" : "cold"
+        );
+    }
+}
+
+void MaterialManager::stopCompiling() {
+    if (m_compileWorker.joinable()) {
+        m_compileWorker.request_stop();
+        m_compileWorker.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_materialMutex);
+    for (AsyncResult& result : m_compiled) {
+        if (result.pipeline.has_value()) {
+            vkDestroyPipeline(m_vkInfo->device, result.pipeline.value(), nullptr);
+        }
+    }
+    m_compiled.clear();
+    m_compileQueue.clear();
+
+    // Whatever is still pending holds a fallback pipeline that is not its own
+    for (auto& [key, record] : m_pendingPipelines) {
+        if (record.orphaned) {
+            record.orphan.pipeline = nullptr;
+            destroyMaterialInfo(&record.orphan);
+        } else {
+            m_materialInfos.at(key).value.pipeline = nullptr;
+        }
+    }
+    m_pendingPipelines.clear();
+}
+
 void MaterialManager::dropMaterialData(MaterialData* data) {
     // HACK: not now ^
     (void) data;
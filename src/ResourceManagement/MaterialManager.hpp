@@ -2,32 +2,114 @@
 
 #pragma once
 
+#include "Game/Input/Duration.hpp"
 #include "RenderEngine/VulkanInfo.hpp"
 #include "RenderEngine/RenderObjects/Materials.hpp"
 #include "ResourceManagement/RenderResources/DescriptorPool.hpp"
 #include "ResourceManagement/RenderResources/VertexAttribute.hpp"
 
 #include <vulkan/vulkan.h>
+#include <yaml-cpp/yaml.h>
 
-#include <unordered_map>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace fs = std::filesystem;
 
+struct MaterialRequest {
+    std::string path;
+    const ProvidedVertexLayout* layout;
+    Specialization specialization = {};
+};
+
 class MaterialManager {
 public:
     bool initialize(VulkanInfo* vkInfo);
     void shutdown();
 
+    // Builds every material not loaded yet on a pool of worker threads, blocking until
+    // all are published. Preloaded materials hold no references until getInfo/getData.
+    void preload(std::span<const MaterialRequest> materials);
+
+    // Layouts are shared by content, whichever material or file declared them
     DescriptorSetInfo getLayout(std::string path);
+    DescriptorSetInfo getLayout(const std::vector<DescriptorBindingInfo>& bindings);
     void dropLayout(DescriptorSetInfo* layout);
 
-    MaterialInfo* getInfo(std::string path, const ProvidedVertexLayout* layout);
+    VkPipelineLayout getPipelineLayout(
+            const std::vector<DescriptorSetInfo>& sets,
+            const std::vector<VkPushConstantRange>& pushConstants
+    );
+    void dropPipelineLayout(VkPipelineLayout layout);
+
+    // Set 0 of every graphics material, declared once in global.yaml. Its set is bound once
+    // per pass with the returned layout and stays bound across material changes.
+    DescriptorSetInfo getGlobalLayout() const { return m_globalLayout; }
+    GlobalDescriptors createGlobalDescriptors(DescriptorPool* descriptor);
+
+    // Each specialization of a material is its own cached pipeline variant
+    MaterialInfo* getInfo(
+            std::string path,
+            const ProvidedVertexLayout* layout,
+            const Specialization& specialization = {}
+    );
     void dropMaterialInfo(MaterialInfo* info);
 
-    MaterialData getData(std::string path, DescriptorPool* descriptor, const ProvidedVertexLayout* layout);
+    MaterialData getData(
+            std::string path,
+            DescriptorPool* descriptor,
+            const ProvidedVertexLayout* layout,
+            const Specialization& specialization = {}
+    );
     void dropMaterialData(MaterialData* data);
 
+    // Returns at once with descriptor sets ready to write, the pipeline is compiled in the
+    // background. Until then the material draws with the registered fallback, or is skipped
+    // without one. A fallback has to use the same descriptor layouts and push constants.
+    MaterialData getDataAsync(
+            std::string path,
+            DescriptorPool* descriptor,
+            const ProvidedVertexLayout* layout,
+            std::string fallback = "",
+            const Specialization& specialization = {}
+    );
+    // Built synchronously and kept until shutdown, so any frame in flight may still bind it
+    void registerFallback(std::string path, const ProvidedVertexLayout* layout);
+
+    // Once per frame before recording, swaps finished background pipelines in
+    void update();
+
+    // Shared by every pipeline build, loaded at initialize and saved at shutdown
+    VkPipelineCache getPipelineCache() const { return m_pipelineCache; }
+    bool isPipelineCacheWarm() const { return m_pipelineCacheWarm; }
+
+    // Graphics pipeline library parts shared by every material, keyed by all the state a
+    // part was built from. build runs only on a miss, and may run on any thread.
+    bool usesPipelineLibraries() const { return m_vkInfo->graphicsPipelineLibrary; }
+    VkPipeline getPipelineLibrary(const std::string& key, const std::function<VkPipeline()>& build);
+
+    // The device can draw lines at all, materials with a line polygon mode need it
+    bool supportsWireframe() const { return m_vkInfo->wireframe; }
+    // Polygon mode is dynamic, one pipeline draws a material both filled and as wireframe
+    bool usesDynamicPolygonMode() const { return m_vkInfo->dynamicPolygonMode; }
+
+    // Totals over every vkCreate*Pipelines call, pipeline library parts included, from any thread.
+    // Only the driver's work is timed, so the cache's effect isn't hidden by shader loading.
+    // update() logs them, with the time since initialize, whenever the compile queue drains.
+    void recordPipelineBuild(Duration buildTime);
+    Size getPipelinesBuilt() const { return m_pipelinesBuilt; }
+    double getPipelineBuildMilliseconds() const { return m_pipelineBuildMilliseconds; }
+
 private:
     template <typename ResourceType>
     struct RefCount {
@@ -35,12 +117,94 @@ private:
         Size references;
     };
 
+    // Prepended to the driver's blob, which itself carries no driver version
+    struct PipelineCacheFileHeader {
+        char magic[8];
+        U32 driverVersion;
+        U32 dataSize;
+    };
+
+    struct AsyncBuild {
+        std::string key;
+        std::string path;
+        YAML::Node yaml;
+        Option<ProvidedVertexLayout> layout;
+        Specialization specialization;
+        MaterialInfo layoutInfo;
+    };
+
+    struct AsyncResult {
+        std::string key;
+        Result<VkPipeline, std::string> pipeline;
+    };
+
+    // Until its pipeline is swapped in, a material holds the fallback's pipeline. Dropping it
+    // meanwhile parks it here, the worker may still be using its pipeline layout.
+    struct PendingPipeline {
+        bool orphaned;
+        MaterialInfo orphan;
+    };
+
     VulkanInfo* m_vkInfo;
 
     fs::path resourceBasePath = "assets/materials";
+    fs::path pipelineCachePath = "cache/pipelines.bin";
+    fs::path globalLayoutPath = "global.yaml";
+
+    DescriptorSetInfo m_globalLayout = {};
+    VkPipelineLayout m_globalPipelineLayout = nullptr;
+
+    VkPipelineCache m_pipelineCache = nullptr;
+    bool m_pipelineCacheWarm = false;
+    std::atomic<Size> m_pipelinesBuilt = 0;
+    std::atomic<double> m_pipelineBuildMilliseconds = 0.0;
+    Duration::TimePoint m_initializeTime;
+    bool m_reportBuilds = true;         // Set while queued pipelines haven't been reported yet
+
+    // Preload workers build materials and layouts concurrently
+    std::mutex m_materialMutex;
+    std::mutex m_layoutMutex;
 
     std::unordered_map<std::string, RefCount<MaterialInfo>> m_materialInfos;
     std::unordered_map<std::string, RefCount<DescriptorSetInfo>> m_descriptorLayouts;
+    std::unordered_map<std::string, RefCount<VkPipelineLayout>> m_pipelineLayouts;
+
+    // Kept until shutdown, linked pipelines do not need them but new variants reuse them
+    std::mutex m_libraryMutex;
+    std::unordered_map<std::string, VkPipeline> m_pipelineLibraries;
+
+    // Background compiles, results are only published by update(). The worker is declared
+    // last so it is joined before the queues it uses are destroyed.
+    std::mutex m_compileMutex;
+    std::condition_variable_any m_compileCondition;
+    std::deque<AsyncBuild> m_compileQueue;
+    std::vector<AsyncResult> m_compiled;
+    std::jthread m_compileWorker;
+
+    std::unordered_map<std::string, PendingPipeline> m_pendingPipelines;
+    std::unordered_map<std::string, MaterialInfo*> m_fallbacks;
+
+    // Material infos are cached by path plus the specialization overrides
+    static std::string materialKey(const std::string& path, const Specialization& specialization);
+
+    Result<MaterialInfo, std::string> buildInfo(
+            std::string path,
+            const ProvidedVertexLayout* layout,
+            const Specialization& specialization
+    );
+    MaterialInfo* getInfoAsync(
+            std::string path,
+            const ProvidedVertexLayout* layout,
+            std::string fallback,
+            const Specialization& specialization
+    );
+    MaterialData createData(MaterialInfo* materialInfo, DescriptorPool* descriptor);
+
+    void compilePipelines(std::stop_token stop);
+    void stopCompiling();
+
+    std::vector<U8> loadPipelineCacheData();
+    void savePipelineCache();
 
     void destroyMaterialInfo(MaterialInfo* info);
     void destroyDescriptorLayoutInfo(DescriptorSetInfo* info);
@@ -7,9 +7,12 @@
 #include <fstream>
 #include <iostream>
 #include <regex>
+#include <string_view>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 
+#include <fmt/core.h>
 #include <spdlog/spdlog.h>
 #include <glslang/Include/ResourceLimits.h>
 #include <glslang/SPIRV/GlslangToSpv.h>
@@ -124,6 +127,27 @@ static TBuiltInResource InitResources() {
     return Resources;
 }
 
+// Everything besides the source that changes the SPIR-V, bump when CompileShaderToSPIRV's settings change
+static constexpr std::string_view COMPILER_OPTIONS = "glsl 100, vulkan 1.4, spirv 1.5, default messages";
+static constexpr U32 SPIRV_MAGIC = 0x07230203;
+
+static const std::filesystem::path SPIRV_CACHE_PATH = std::filesystem::path("cache") / "shaders";
+
+// Once per process, glslang's global state is only torn down at exit
+struct GlslangProcess {
+    GlslangProcess() { glslang::InitializeProcess(); }
+    ~GlslangProcess() { glslang::FinalizeProcess(); }
+};
+
+// FNV-1a, stable across runs and platforms so cached files stay valid
+static U64 HashBytes(std::string_view bytes, U64 hash = 0xcbf29ce484222325ull) {
+    for (char c : bytes) {
+        hash ^= static_cast<U8>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
 std::vector<U8> ReadFile(const std::string& filename) {
     std::ifstream file(filename, std::ios::ate | std::ios::binary);
     if (!file.is_open()) {
@@ -170,13 +194,14 @@ std::string PreprocessIncludes(const std::filesystem::path& filePath, std::unord
         return "";
     }
 
+    static const std::regex includeRegex(R"(#include\s+\"(.+?)\")");
+
     std::string line;
     std::string processedSource;
-    std::regex includeRegex(R"(#include\s+\"(.+?)\")");
 
     while (std::getline(file, line)) {
         std::smatch match;
-        if (std::regex_search(line, match, includeRegex)) {
+        if (line.find("#include") != std::string::npos && std::regex_search(line, match, includeRegex)) {
             auto includeFile = filePath.parent_path() / match[1].str();
             processedSource += PreprocessIncludes(includeFile, includedFiles);
         } else {
@@ -192,11 +217,67 @@ std::string PreprocessIncludes(const std::filesystem::path& filePath) {
     return PreprocessIncludes(filePath, includedFiles);
 }
 
-std::vector<U32> CompileShaderToSPIRV(const std::string& filename, VkShaderStageFlagBits vkStage) {
-    glslang::InitializeProcess();
+std::filesystem::path CachedSPIRVPath(const std::string& shaderCode, VkShaderStageFlagBits vkStage) {
+    U64 hash = HashBytes(shaderCode);
+    hash = HashBytes(std::string_view(reinterpret_cast<const char*>(&vkStage), sizeof(vkStage)), hash);
+    hash = HashBytes(COMPILER_OPTIONS, hash);
 
+    return SPIRV_CACHE_PATH / fmt::format("{:016x}.spv", hash);
+}
+
+std::vector<U32> ReadCachedSPIRV(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) return {};
+
+    Size fileSize = static_cast<Size>(file.tellg());
+    if (fileSize == 0 || fileSize % sizeof(U32) != 0) return {};
+
+    std::vector<U32> spirv(fileSize / sizeof(U32));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(spirv.data()), fileSize);
+
+    // Truncated or foreign files are treated as misses and overwritten
+    if (!file || spirv[0] != SPIRV_MAGIC) return {};
+    return spirv;
+}
+
+void WriteCachedSPIRV(const std::filesystem::path& path, const std::vector<U32>& spirv) {
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    // Written aside and renamed, so a reader never sees a partial file
+    std::filesystem::path temporary = path;
+    temporary += fmt::format(".{}.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        spdlog::warn("Failed to write SPIR-V cache file {}", temporary.string());
+        return;
+    }
+
+    file.write(reinterpret_cast<const char*>(spirv.data()), spirv.size() * sizeof(U32));
+    file.close();
+
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        spdlog::warn("Failed to store SPIR-V cache file {}: {}", path.string(), error.message());
+        std::filesystem::remove(temporary, error);
+    }
+}
+
+std::vector<U32> CompileShaderToSPIRV(const std::string& filename, VkShaderStageFlagBits vkStage) {
     std::string shaderCode = PreprocessIncludes(filename);
 
+    // Keyed by the source with every include expanded, so editing an include invalidates its users
+    std::filesystem::path cachePath = CachedSPIRVPath(shaderCode, vkStage);
+    std::vector<U32> cached = ReadCachedSPIRV(cachePath);
+    if (!cached.empty()) {
+        spdlog::debug("Loaded {} from the SPIR-V cache", filename);
+        return cached;
+    }
+
+    static GlslangProcess glslangProcess;
+
     EShLanguage stage = ShaderStageFromVulkan(vkStage);
 
     glslang::TShader shader(stage);
@@ -227,7 +308,7 @@ std::vector<U32> CompileShaderToSPIRV(const std::string& filename, VkShaderStage
     std::vector<U32> spirv;
     glslang::GlslangToSpv(*program.getIntermediate(stage), spirv);
 
-    glslang::FinalizeProcess();
+    WriteCachedSPIRV(cachePath, spirv);
     return spirv;
 }
 
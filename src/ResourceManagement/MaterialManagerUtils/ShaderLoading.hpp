@@ -2,7 +2,14 @@
 
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
+#include <string>
+#include <vector>
 #include <vulkan/vulkan.h>
 
 VkShaderModule LoadAndCompileShader(VkDevice device, const std::filesystem::path filename, VkShaderStageFlagBits vkStage);
+
+// Through the SPIR-V cache, empty on failure
+std::vector<uint32_t> CompileShaderToSPIRV(const std::string& filename, VkShaderStageFlagBits vkStage);
+VkShaderModule CreateShaderModule(VkDevice device, const std::vector<uint32_t>& spirv);
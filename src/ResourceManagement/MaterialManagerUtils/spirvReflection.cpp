@@ -0,0 +1,325 @@
+// src/ResourceManagement/MaterialManagerUtils/spirvReflection.cpp
+
+#include "spirvReflection.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+    constexpr U32 SPIRV_MAGIC = 0x07230203;
+    constexpr Size HEADER_WORDS = 5;
+
+    // Opcodes
+    constexpr U32 OP_TYPE_BOOL = 20;
+    constexpr U32 OP_TYPE_INT = 21;
+    constexpr U32 OP_TYPE_FLOAT = 22;
+    constexpr U32 OP_TYPE_VECTOR = 23;
+    constexpr U32 OP_TYPE_MATRIX = 24;
+    constexpr U32 OP_TYPE_IMAGE = 25;
+    constexpr U32 OP_TYPE_SAMPLER = 26;
+    constexpr U32 OP_TYPE_SAMPLED_IMAGE = 27;
+    constexpr U32 OP_TYPE_ARRAY = 28;
+    constexpr U32 OP_TYPE_RUNTIME_ARRAY = 29;
+    constexpr U32 OP_TYPE_STRUCT = 30;
+    constexpr U32 OP_TYPE_POINTER = 32;
+    constexpr U32 OP_CONSTANT = 43;
+    constexpr U32 OP_VARIABLE = 59;
+    constexpr U32 OP_DECORATE = 71;
+    constexpr U32 OP_MEMBER_DECORATE = 72;
+    constexpr U32 OP_TYPE_ACCELERATION_STRUCTURE = 5341;
+
+    // Decorations
+    constexpr U32 DECORATION_BLOCK = 2;
+    constexpr U32 DECORATION_BUFFER_BLOCK = 3;
+    constexpr U32 DECORATION_ARRAY_STRIDE = 6;
+    constexpr U32 DECORATION_MATRIX_STRIDE = 7;
+    constexpr U32 DECORATION_BINDING = 33;
+    constexpr U32 DECORATION_DESCRIPTOR_SET = 34;
+    constexpr U32 DECORATION_OFFSET = 35;
+
+    // Storage classes
+    constexpr U32 STORAGE_UNIFORM_CONSTANT = 0;
+    constexpr U32 STORAGE_UNIFORM = 2;
+    constexpr U32 STORAGE_STORAGE_BUFFER = 12;
+
+    // Image dimensions
+    constexpr U32 DIM_BUFFER = 5;
+    constexpr U32 DIM_SUBPASS_DATA = 6;
+
+    struct SpirvType {
+        U32 opcode;
+        std::vector<U32> operands;  // Everything after the result id
+    };
+
+    struct SpirvVariable {
+        U32 id;
+        U32 pointerType;
+        U32 storageClass;
+    };
+
+    using Decorations = std::unordered_map<U32, U32>;   // Decoration -> first literal, 0 without one
+
+    struct SpirvModule {
+        std::unordered_map<U32, SpirvType> types;
+        std::unordered_map<U32, U32> constants;         // Scalar constants, for array lengths
+        std::unordered_map<U32, Decorations> decorations;
+        std::unordered_map<U32, std::unordered_map<U32, Decorations>> memberDecorations;
+        std::vector<SpirvVariable> variables;
+    };
+
+    bool isType(U32 opcode) {
+        return (opcode >= OP_TYPE_BOOL && opcode <= OP_TYPE_STRUCT)
+            || opcode == OP_TYPE_POINTER
+            || opcode == OP_TYPE_ACCELERATION_STRUCTURE;
+    }
+
+    Option<U32> decoration(const SpirvModule& parsed, U32 id, U32 kind) {
+        auto it = parsed.decorations.find(id);
+        if (it == parsed.decorations.end()) return std::nullopt;
+
+        auto value = it->second.find(kind);
+        if (value == it->second.end()) return std::nullopt;
+        return value->second;
+    }
+
+    Option<U32> memberDecoration(const SpirvModule& parsed, U32 id, U32 member, U32 kind) {
+        auto it = parsed.memberDecorations.find(id);
+        if (it == parsed.memberDecorations.end()) return std::nullopt;
+
+        auto members = it->second.find(member);
+        if (members == it->second.end()) return std::nullopt;
+
+        auto value = members->second.find(kind);
+        if (value == members->second.end()) return std::nullopt;
+        return value->second;
+    }
+
+    // Bytes a type takes in an explicitly laid out block, runtime arrays count as empty
+    U32 typeSize(const SpirvModule& parsed, U32 typeId, U32 matrixStride = 0) {
+        auto it = parsed.types.find(typeId);
+        if (it == parsed.types.end()) return 0;
+        const SpirvType& type = it->second;
+
+        switch (type.opcode) {
+            case OP_TYPE_BOOL:
+                return 4;
+            case OP_TYPE_INT:
+            case OP_TYPE_FLOAT:
+                return type.operands[0] / 8;
+            case OP_TYPE_VECTOR:
+                return type.operands[1] * typeSize(parsed, type.operands[0]);
+            case OP_TYPE_MATRIX:
+                return type.operands[1] * (matrixStride != 0 ? matrixStride : typeSize(parsed, type.operands[0]));
+            case OP_TYPE_ARRAY: {
+                U32 length = parsed.constants.contains(type.operands[1]) ? parsed.constants.at(type.operands[1]) : 0;
+                U32 stride = decoration(parsed, typeId, DECORATION_ARRAY_STRIDE).value_or(
+                        typeSize(parsed, type.operands[0], matrixStride)
+                );
+                return length * stride;
+            }
+            case OP_TYPE_STRUCT: {
+                U32 size = 0;
+                for (U32 member = 0; member < type.operands.size(); member++) {
+                    U32 offset = memberDecoration(parsed, typeId, member, DECORATION_OFFSET).value_or(0);
+                    U32 stride = memberDecoration(parsed, typeId, member, DECORATION_MATRIX_STRIDE).value_or(0);
+                    size = std::max(size, offset + typeSize(parsed, type.operands[member], stride));
+                }
+                return size;
+            }
+            default:
+                return 0;
+        }
+    }
+
+    Result<DescriptorBindingInfo, std::string> reflectBinding(
+            const SpirvModule& parsed,
+            const SpirvVariable& variable,
+            U32 binding,
+            VkShaderStageFlagBits stage
+    ) {
+        auto pointer = parsed.types.find(variable.pointerType);
+        if (pointer == parsed.types.end() || pointer->second.opcode != OP_TYPE_POINTER) {
+            return std::unexpected(fmt::format("Binding {} is not a pointer", binding));
+        }
+
+        // Arrays of descriptors become the descriptor count
+        U32 typeId = pointer->second.operands[1];
+        U32 count = 1;
+        while (parsed.types.contains(typeId)) {
+            const SpirvType& type = parsed.types.at(typeId);
+            if (type.opcode == OP_TYPE_RUNTIME_ARRAY) {
+                return std::unexpected(fmt::format("Binding {} is a runtime sized array, which is not supported", binding));
+            }
+            if (type.opcode != OP_TYPE_ARRAY) break;
+
+            count *= parsed.constants.contains(type.operands[1]) ? parsed.constants.at(type.operands[1]) : 1;
+            typeId = type.operands[0];
+        }
+
+        auto it = parsed.types.find(typeId);
+        if (it == parsed.types.end()) {
+            return std::unexpected(fmt::format("Binding {} has an unknown type", binding));
+        }
+        const SpirvType& type = it->second;
+
+        DescriptorBindingInfo info = {
+            .binding = binding,
+            .descriptorType = VK_DESCRIPTOR_TYPE_MAX_ENUM,
+            .stages = static_cast<VkShaderStageFlags>(stage),
+            .size = 0,
+            .offset = 0,
+            .count = count,
+        };
+
+        switch (type.opcode) {
+            case OP_TYPE_STRUCT:
+                if (variable.storageClass == STORAGE_STORAGE_BUFFER ||
+                        decoration(parsed, typeId, DECORATION_BUFFER_BLOCK).has_value()) {
+                    info.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                } else if (decoration(parsed, typeId, DECORATION_BLOCK).has_value()) {
+                    info.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                }
+                info.size = typeSize(parsed, typeId);
+                break;
+
+            case OP_TYPE_IMAGE: {
+                U32 dim = type.operands[1];
+                bool storage = type.operands[5] == 2;   // Sampled operand, 2 is read/write without a sampler
+
+                if (dim == DIM_BUFFER) {
+                    info.descriptorType = storage
+                        ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER
+                        : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+                } else if (dim == DIM_SUBPASS_DATA) {
+                    info.descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+                } else {
+                    info.descriptorType = storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+                }
+                break;
+            }
+
+            case OP_TYPE_SAMPLED_IMAGE:
+                info.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                break;
+
+            case OP_TYPE_SAMPLER:
+                info.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+                break;
+
+            case OP_TYPE_ACCELERATION_STRUCTURE:
+                info.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+                break;
+
+            default:
+                break;
+        }
+
+        if (info.descriptorType == VK_DESCRIPTOR_TYPE_MAX_ENUM) {
+            return std::unexpected(fmt::format("Binding {} has a type that is not a descriptor", binding));
+        }
+
+        return info;
+    }
+
+    void sortBindings(std::vector<DescriptorBindingInfo>& bindings) {
+        std::sort(bindings.begin(), bindings.end(), [](const DescriptorBindingInfo& a, const DescriptorBindingInfo& b) {
+            return a.binding < b.binding;
+        });
+    }
+}
+
+namespace MaterialManagerUtils {
+
+Result<ReflectedSets, std::string> reflectDescriptorSets(const std::vector<U32>& spirv, VkShaderStageFlagBits stage) {
+    if (spirv.size() < HEADER_WORDS || spirv[0] != SPIRV_MAGIC) {
+        return std::unexpected(std::string("Not a SPIR-V module"));
+    }
+
+    SpirvModule parsed;
+    for (Size i = HEADER_WORDS; i < spirv.size();) {
+        U32 wordCount = spirv[i] >> 16;
+        U32 opcode = spirv[i] & 0xffff;
+        if (wordCount == 0 || i + wordCount > spirv.size()) {
+            return std::unexpected(std::string("Truncated SPIR-V module"));
+        }
+
+        const U32* words = spirv.data() + i;
+
+        if (isType(opcode) && wordCount >= 2) {
+            parsed.types[words[1]] = SpirvType{
+                .opcode = opcode,
+                .operands = std::vector<U32>(words + 2, words + wordCount),
+            };
+        } else if (opcode == OP_CONSTANT && wordCount >= 4) {
+            parsed.constants[words[2]] = words[3];
+        } else if (opcode == OP_VARIABLE && wordCount >= 4) {
+            parsed.variables.push_back({.id = words[2], .pointerType = words[1], .storageClass = words[3]});
+        } else if (opcode == OP_DECORATE && wordCount >= 3) {
+            parsed.decorations[words[1]][words[2]] = wordCount >= 4 ? words[3] : 0;
+        } else if (opcode == OP_MEMBER_DECORATE && wordCount >= 4) {
+            parsed.memberDecorations[words[1]][words[2]][words[3]] = wordCount >= 5 ? words[4] : 0;
+        }
+
+        i += wordCount;
+    }
+
+    ReflectedSets sets;
+    for (const SpirvVariable& variable : parsed.variables) {
+        if (variable.storageClass != STORAGE_UNIFORM_CONSTANT &&
+                variable.storageClass != STORAGE_UNIFORM &&
+                variable.storageClass != STORAGE_STORAGE_BUFFER) {
+            continue;
+        }
+
+        Option<U32> set = decoration(parsed, variable.id, DECORATION_DESCRIPTOR_SET);
+        Option<U32> binding = decoration(parsed, variable.id, DECORATION_BINDING);
+        if (!set.has_value() || !binding.has_value()) continue;
+
+        Result<DescriptorBindingInfo, std::string> info = reflectBinding(parsed, variable, binding.value(), stage);
+        if (!info.has_value()) {
+            return std::unexpected(fmt::format("Set {}: {}", set.value(), info.error()));
+        }
+
+        sets[set.value()].push_back(info.value());
+    }
+
+    for (auto& [set, bindings] : sets) {
+        sortBindings(bindings);
+    }
+
+    return sets;
+}
+
+Result<void, std::string> mergeDescriptorSets(ReflectedSets& sets, const ReflectedSets& stageSets) {
+    for (const auto& [set, bindings] : stageSets) {
+        std::vector<DescriptorBindingInfo>& merged = sets[set];
+
+        for (const DescriptorBindingInfo& binding : bindings) {
+            auto it = std::find_if(merged.begin(), merged.end(), [&](const DescriptorBindingInfo& other) {
+                return other.binding == binding.binding;
+            });
+
+            if (it == merged.end()) {
+                merged.push_back(binding);
+                continue;
+            }
+
+            if (it->descriptorType != binding.descriptorType || it->count != binding.count) {
+                return std::unexpected(fmt::format(
+                        "Set {} binding {} is declared differently by two stages", set, binding.binding
+                ));
+            }
+
+            it->stages |= binding.stages;
+            it->size = std::max(it->size, binding.size);
+        }
+
+        sortBindings(merged);
+    }
+
+    return {};
+}
+
+}
@@ -0,0 +1,26 @@
+// src/ResourceManagement/MaterialManagerUtils/spirvReflection.hpp
+
+#pragma once
+
+#include "Core/Types.hpp"
+#include "RenderEngine/RenderObjects/Materials.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace MaterialManagerUtils {
+
+// Set -> bindings, sorted by binding
+using ReflectedSets = std::map<U32, std::vector<DescriptorBindingInfo>>;
+
+// Every descriptor a module declares, whether or not its entry point reads it.
+// Buffer sizes come from the block layout, offsets are always 0.
+Result<ReflectedSets, std::string> reflectDescriptorSets(const std::vector<U32>& spirv, VkShaderStageFlagBits stage);
+
+// Adds a stage's descriptors, bindings declared by several stages get all of their stages
+Result<void, std::string> mergeDescriptorSets(ReflectedSets& sets, const ReflectedSets& stageSets);
+
+}
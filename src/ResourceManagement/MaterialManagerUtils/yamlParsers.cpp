@@ -10,24 +10,26 @@
 #include "RenderEngine/RenderObjects/DescriptorSetBuilder.hpp"
 #include "RenderEngine/RenderObjects/Materials.hpp"
 #include "ShaderLoading.hpp"
+#include "spirvReflection.hpp"
 
 #include "Core/Types.hpp"
+#include "Game/Input/Duration.hpp"
 #include <vulkan/vulkan.h>
 #include <fmt/format.h>
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
 #include <string>
+#include <variant>
 
 namespace MaterialManagerUtils {
 
-Result<DescriptorSetInfo, std::string> yamlToLayout(YAML::Node& yaml, VkDevice device) {
-    DescriptorSetBuilder builder;
-
-    YAML::Node bindings = yaml["descriptor_layout"]["bindings"];
-
-    for (const YAML::Node& node : bindings) {
-        uint32_t binding = node["binding"].as<uint32_t>();
-        VkDescriptorType descriptorType = getDescriptorType(node["descriptor_type"].as<std::string>());
+std::vector<DescriptorBindingInfo> yamlToBindings(const YAML::Node& yaml) {
+    std::vector<DescriptorBindingInfo> bindings;
 
+    for (const YAML::Node& node : yaml["descriptor_layout"]["bindings"]) {
         // Convert shader stages
         VkShaderStageFlags stageFlags = 0;
         if (node["stages"].IsSequence()) {
@@ -40,14 +42,51 @@ Result<DescriptorSetInfo, std::string> yamlToLayout(YAML::Node& yaml, VkDevice d
             stageFlags = getShaderStageFlags({node["stages"].as<std::string>()});
         }
 
-        U32 size = node["size"].as<U32>();
-        U32 offset = node["offset"].as<U32>();
+        bindings.push_back({
+            .binding = node["binding"].as<U32>(),
+            .descriptorType = getDescriptorType(node["descriptor_type"].as<std::string>()),
+            .stages = stageFlags,
+            .size = node["size"].as<U32>(),
+            .offset = node["offset"].as<U32>(),
+            .count = node["count"] ? node["count"].as<U32>() : 1,    // Arrays, e.g. one image per mip
+        });
+    }
 
-        // Add binding to builder
-        builder.addBinding(binding, descriptorType, stageFlags, size, offset);
+    return bindings;
+}
+
+Result<DescriptorSetInfo, std::string> bindingsToLayout(
+        const std::vector<DescriptorBindingInfo>& bindings,
+        VkDevice device
+) {
+    DescriptorSetBuilder builder;
+    for (const DescriptorBindingInfo& binding : bindings) {
+        builder.addBinding(
+                binding.binding, binding.descriptorType, binding.stages, binding.size, binding.offset, binding.count
+        );
+    }
+
+    Option<DescriptorSetInfo> layout = builder.build(device);
+    if (!layout.has_value()) {
+        return std::unexpected(std::string("Couldn't create a descriptor set layout"));
     }
+    return layout.value();
+}
 
-    return builder.build(device).value();
+std::string descriptorLayoutKey(const std::vector<DescriptorBindingInfo>& bindings) {
+    std::vector<DescriptorBindingInfo> sorted = bindings;
+    std::sort(sorted.begin(), sorted.end(), [](const DescriptorBindingInfo& a, const DescriptorBindingInfo& b) {
+        return a.binding < b.binding;
+    });
+
+    // Sizes and offsets are only informational, they do not change the Vulkan layout
+    std::string key;
+    for (const DescriptorBindingInfo& binding : sorted) {
+        key += fmt::format(
+                "{}:{}:{}:{};", binding.binding, static_cast<U32>(binding.descriptorType), binding.stages, binding.count
+        );
+    }
+    return key;
 }
 
 // Info Stuff
@@ -81,6 +120,94 @@ std::vector<VkPushConstantRange> parsePushConstants(YAML::Node& yaml) {
     return pushConstants;
 }
 
+U32 packSpecializationValue(const std::string& type, const SpecializationValue& value) {
+    // Every alternative fits a double exactly, so overrides may use any of them
+    double number = std::visit([](auto v) { return static_cast<double>(v); }, value);
+
+    if (type == "bool") return number != 0.0 ? VK_TRUE : VK_FALSE;
+    if (type == "int") return std::bit_cast<U32>(static_cast<I32>(number));
+    if (type == "uint") return static_cast<U32>(number);
+    if (type == "float") return std::bit_cast<U32>(static_cast<F32>(number));
+
+    throw std::runtime_error("Unknown specialization constant type: " + type);
+}
+
+SpecializationValue parseSpecializationDefault(const std::string& type, const YAML::Node& node) {
+    if (type == "bool") return node.as<bool>();
+    if (type == "int") return node.as<I32>();
+    if (type == "uint") return node.as<U32>();
+    if (type == "float") return node.as<F32>();
+
+    throw std::runtime_error("Unknown specialization constant type: " + type);
+}
+
+// Each constant is 4 bytes in one shared blob, stages only see the entries declared for them
+void parseSpecializationConstants(
+        YAML::Node& yaml,
+        const std::string& folder,
+        const Specialization& specialization,
+        const std::vector<VkShaderStageFlagBits>& shaderStages,
+        PipelineBuilder& builder
+) {
+    std::vector<VkSpecializationMapEntry> entries;
+    std::vector<VkShaderStageFlags> entryStages;
+    std::vector<U8> data;
+    Size overridden = 0;
+
+    for (const auto& node : yaml["specialization_constants"]) {
+        std::string name = node["name"].as<std::string>();
+        std::string type = node["type"].as<std::string>();
+
+        auto value = specialization.find(name);
+        if (value != specialization.end()) {
+            overridden++;
+        }
+
+        U32 packed = packSpecializationValue(
+                type,
+                value != specialization.end() ? value->second : parseSpecializationDefault(type, node["default"])
+        );
+
+        VkShaderStageFlags stages = VK_SHADER_STAGE_ALL;
+        if (node["stages"]) {
+            std::vector<std::string> stageNames;
+            for (const auto& stage : node["stages"]) {
+                stageNames.push_back(stage.as<std::string>());
+            }
+            stages = getShaderStageFlags(stageNames);
+        }
+
+        entries.push_back({
+            .constantID = node["id"].as<U32>(),
+            .offset = static_cast<U32>(data.size()),
+            .size = sizeof(U32),
+        });
+        entryStages.push_back(stages);
+
+        const U8* bytes = reinterpret_cast<const U8*>(&packed);
+        data.insert(data.end(), bytes, bytes + sizeof(U32));
+    }
+
+    if (overridden != specialization.size()) {
+        spdlog::warn("{} does not declare every specialization constant it was given", folder);
+    }
+
+    if (entries.empty()) {
+        return;
+    }
+
+    for (VkShaderStageFlagBits stage : shaderStages) {
+        std::vector<VkSpecializationMapEntry> stageEntries;
+        for (Size i = 0; i < entries.size(); i++) {
+            if (entryStages[i] & stage) stageEntries.push_back(entries[i]);
+        }
+
+        if (!stageEntries.empty()) {
+            builder.setSpecialization(stage, stageEntries, data);
+        }
+    }
+}
+
 std::pair<
     std::vector<VkVertexInputBindingDescription>,
     std::vector<VkVertexInputAttributeDescription>
@@ -148,46 +275,217 @@ std::pair<
     return {bindings, attributes};
 }
 
-Result<MaterialInfo, std::string> yamlToInfo(
-        MaterialManager* materialManager,
-        YAML::Node& yaml, fs::path& basePath,
-        std::string& folder,
-        VkDevice device,
-        const ProvidedVertexLayout* providedLayout
+RasterState parseRasterState(YAML::Node& pipeline) {
+    YAML::Node depthInfo = pipeline["depth_info"];
+
+    return {
+        .polygonMode = getPolygonMode(pipeline["polygon_mode"].as<std::string>()),
+        .cullMode = getCullMode(pipeline["cull_mode"].as<std::string>()),
+        .frontFace = getFrontFace(pipeline["front_face"].as<std::string>()),
+        .depthTest = depthInfo["depth_test"].as<bool>(),
+        .depthWrite = depthInfo["write_depth"].as<bool>(),
+        .depthCompareOp = getCompareOp(depthInfo["compare_op"].as<std::string>()),
+    };
+}
+
+// Descriptors declared by every shader of the material, merged across stages
+Result<ReflectedSets, std::string> reflectShaders(YAML::Node& pipeline, fs::path& basePath, std::string& folder) {
+    ReflectedSets sets;
+
+    for (const YAML::Node& shader : pipeline["shaders"]) {
+        VkShaderStageFlagBits stage = getShaderStageFlagBit(shader["stage"].as<std::string>());
+        fs::path shaderPath = basePath / folder / shader["module"].as<std::string>();
+
+        // Through the SPIR-V cache, so the pipeline build reading it again is only a file read
+        std::vector<U32> spirv = CompileShaderToSPIRV(shaderPath.string(), stage);
+        if (spirv.empty()) {
+            return std::unexpected(fmt::format("Couldn't compile {}", shaderPath.string()));
+        }
+
+        Result<ReflectedSets, std::string> stageSets = reflectDescriptorSets(spirv, stage);
+        if (!stageSets.has_value()) {
+            return std::unexpected(fmt::format("{}: {}", shaderPath.string(), stageSets.error()));
+        }
+
+        Result<void, std::string> merged = mergeDescriptorSets(sets, stageSets.value());
+        if (!merged.has_value()) {
+            return std::unexpected(fmt::format("{}: {}", folder, merged.error()));
+        }
+    }
+
+    return sets;
+}
+
+// Graphics shaders may read any subset of the global set, as long as they agree with it
+Result<void, std::string> checkGlobalBindings(
+        const std::vector<DescriptorBindingInfo>& bindings,
+        const DescriptorSetInfo& global,
+        const std::string& folder
 ) {
-    PipelineBuilder builder;
+    for (const DescriptorBindingInfo& binding : bindings) {
+        auto it = std::find_if(global.bindings.begin(), global.bindings.end(), [&](const DescriptorBindingInfo& other) {
+            return other.binding == binding.binding;
+        });
+
+        bool matches = it != global.bindings.end()
+                && it->descriptorType == binding.descriptorType
+                && it->count == binding.count
+                && (binding.stages & ~it->stages) == 0;
+
+        if (!matches) {
+            return std::unexpected(fmt::format(
+                    "{} declares set 0 binding {} differently from the global set", folder, binding.binding
+            ));
+        }
+    }
 
+    return {};
+}
+
+Result<MaterialInfo, std::string> yamlToPipelineLayout(
+        MaterialManager* materialManager,
+        YAML::Node& yaml,
+        fs::path& basePath,
+        std::string& folder
+) {
     YAML::Node pipeline = yaml["pipeline"];
-    YAML::Node depthInfo = pipeline["depth_info"];
+
+    bool compute = false;
+    for (const YAML::Node& shader : pipeline["shaders"]) {
+        compute |= getShaderStageFlagBit(shader["stage"].as<std::string>()) == VK_SHADER_STAGE_COMPUTE_BIT;
+    }
 
     // Descriptors
-    YAML::Node descriptors = pipeline["descriptor_layouts"];
+    Result<ReflectedSets, std::string> reflected = reflectShaders(pipeline, basePath, folder);
+    if (!reflected.has_value()) {
+        return std::unexpected(reflected.error());
+    }
+
     std::vector<DescriptorSetInfo> layouts;
-    for (const YAML::Node& set : descriptors) {
-        DescriptorSetInfo setLayout = materialManager->getLayout(
-                fmt::format("{}/{}", folder, set["layout"].as<std::string>())
-        );
+    auto dropLayouts = [&]() {
+        for (DescriptorSetInfo& set : layouts) {
+            materialManager->dropLayout(&set);
+        }
+    };
+
+    // Graphics materials always start with the global set, whether or not they read it
+    U32 setCount = reflected->empty() ? 0 : reflected->rbegin()->first + 1;
+    if (!compute) {
+        setCount = std::max(setCount, 1u);
+    }
+
+    for (U32 set = 0; set < setCount; set++) {
+        auto it = reflected->find(set);
+        std::vector<DescriptorBindingInfo> bindings = it != reflected->end()
+            ? it->second
+            : std::vector<DescriptorBindingInfo>{};
+
+        if (set == 0 && !compute) {
+            DescriptorSetInfo global = materialManager->getGlobalLayout();
+
+            Result<void, std::string> checked = checkGlobalBindings(bindings, global, folder);
+            if (!checked.has_value()) {
+                dropLayouts();
+                return std::unexpected(checked.error());
+            }
+
+            layouts.push_back(materialManager->getLayout(global.bindings));
+            continue;
+        }
+
+        // Sets no shader reads stay empty, the pipeline layout still needs one per index
+        layouts.push_back(materialManager->getLayout(bindings));
+    }
+
+    std::vector<VkPushConstantRange> pushConstants = parsePushConstants(pipeline);
+    PushConstantsInfo pushConstantsInfo = {};
+    pushConstantsInfo.enabled = false;
+
+    for (const VkPushConstantRange& range : pushConstants) {
+        if (!compute && range.offset + range.size > SHARED_PUSH_CONSTANT_RANGE.size) {
+            dropLayouts();
+            return std::unexpected(fmt::format(
+                    "{} pushes {} bytes, graphics materials have {}",
+                    folder, range.offset + range.size, SHARED_PUSH_CONSTANT_RANGE.size
+            ));
+        }
+
+        pushConstantsInfo = {
+            .enabled = true,
+            .stages = compute ? range.stageFlags : SHARED_PUSH_CONSTANT_RANGE.stageFlags,
+            .size = range.size,
+            .offset = range.offset,
+        };
+    }
+
+    if (!compute) {
+        pushConstants = {SHARED_PUSH_CONSTANT_RANGE};
+    }
 
-        builder.addDescriptorLayout(setLayout);
-        layouts.push_back(setLayout);
+    VkPipelineLayout pipelineLayout = materialManager->getPipelineLayout(layouts, pushConstants);
+    if (pipelineLayout == nullptr) {
+        dropLayouts();
+        return std::unexpected(fmt::format("Couldn't create the pipeline layout of {}", folder));
     }
 
-    // Shaders
-    YAML::Node shaders = pipeline["shaders"];
+    return MaterialInfo{
+        .pipeline = nullptr,
+        .pipelineLayout = pipelineLayout,
+        .pushConstants = pushConstantsInfo,
+        .descriptorSets = layouts,
+        .type = compute ? MaterialType::Compute : MaterialType::Opaque,   // TODO: materialtypes
+        .raster = compute ? RasterState{} : parseRasterState(pipeline),
+    };
+}
+
+std::string specializationKey(const Specialization& specialization) {
+    // Sorted by name, so equal overrides always give the same key
+    std::string key;
+    for (const auto& [name, value] : specialization) {
+        key += fmt::format("|{}={}", name, std::visit([](auto v) { return fmt::format("{}", v); }, value));
+    }
+    return key;
+}
+
+// Compiles the shaders of the masked stages into the builder, the modules are destroyed once built
+std::vector<VkShaderModule> addShaders(
+        YAML::Node& pipeline,
+        fs::path& basePath,
+        std::string& folder,
+        VkDevice device,
+        const Specialization& specialization,
+        VkShaderStageFlags stageMask,
+        PipelineBuilder& builder
+) {
     std::vector<VkShaderModule> shaderModules;
-    for (const YAML::Node& shader : shaders) {
-        fs::path shaderPath = basePath / folder / shader["module"].as<std::string>();
+    std::vector<VkShaderStageFlagBits> shaderStages;
 
+    builder.clearShaders();
+    for (const YAML::Node& shader : pipeline["shaders"]) {
         std::string shaderStage = shader["stage"].as<std::string>();
         VkShaderStageFlagBits stage = getShaderStageFlagBit(shaderStage);
+        if (!(stage & stageMask)) continue;
 
+        fs::path shaderPath = basePath / folder / shader["module"].as<std::string>();
         VkShaderModule shaderModule = LoadAndCompileShader(device, shaderPath, stage);
 
         builder.addShader(shaderModule, stage);
         shaderModules.push_back(shaderModule);
+        shaderStages.push_back(stage);
     }
 
-    // Pipeline
+    parseSpecializationConstants(pipeline, folder, specialization, shaderStages, builder);
+    return shaderModules;
+}
+
+void setGraphicsState(
+        YAML::Node& pipeline,
+        const ProvidedVertexLayout* providedLayout,
+        bool dynamicPolygonMode,
+        PipelineBuilder& builder
+) {
+    YAML::Node depthInfo = pipeline["depth_info"];
+
     builder.setBlending(getBlendingMode(pipeline["blending"].as<std::string>()));
     builder.setColorFormat(getFormat(pipeline["color_format"].as<std::string>()));
     builder.setDepthFormat(Config::depthFormat);
@@ -204,41 +502,228 @@ Result<MaterialInfo, std::string> yamlToInfo(
             getCompareOp(depthInfo["compare_op"].as<std::string>())
     );
 
-    std::vector<VkPushConstantRange> pushConstants = parsePushConstants(pipeline);
-    PushConstantsInfo pushConstantsInfo = {};
-    pushConstantsInfo.enabled = false;
+    auto [bindings, attributes] = parseVertexInput(pipeline, providedLayout);
+    builder.setVertexInputState(bindings, attributes);
 
-    for (Size i = 0; i < pushConstants.size(); i++) {
-        builder.addPushConstant(
-                pushConstants[i].stageFlags,
-                pushConstants[i].size,
-                pushConstants[i].offset
-        );
+    // Set per draw from MaterialInfo::raster, so raster variants of a material share its pipeline
+    builder.addDynamicState(VK_DYNAMIC_STATE_CULL_MODE);
+    builder.addDynamicState(VK_DYNAMIC_STATE_FRONT_FACE);
+    builder.addDynamicState(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE);
+    builder.addDynamicState(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE);
+    builder.addDynamicState(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP);
+    if (dynamicPolygonMode) {
+        builder.addDynamicState(VK_DYNAMIC_STATE_POLYGON_MODE_EXT);
+    }
+}
 
-        pushConstantsInfo = {
-            .enabled = true,
-            .stages = pushConstants[i].stageFlags,
-            .size = pushConstants[i].size,
-            .offset = pushConstants[i].offset,
-        };
+// Descriptor layout contents and push constants, materials sharing them share a pipeline layout
+std::string pipelineLayoutKey(const MaterialInfo& layoutInfo) {
+    std::string key;
+    for (const DescriptorSetInfo& set : layoutInfo.descriptorSets) {
+        key += descriptorLayoutKey(set.bindings) + "|";
     }
 
+    // Graphics materials all declare the shared range
+    return key + fmt::format(
+            "{}:{}:{}",
+            SHARED_PUSH_CONSTANT_RANGE.stageFlags,
+            SHARED_PUSH_CONSTANT_RANGE.offset,
+            SHARED_PUSH_CONSTANT_RANGE.size
+    );
+}
+
+std::string shaderKey(
+        YAML::Node& pipeline,
+        const std::string& folder,
+        VkShaderStageFlags stageMask,
+        const Specialization& specialization
+) {
+    std::string key;
+    for (const YAML::Node& shader : pipeline["shaders"]) {
+        if (!(getShaderStageFlagBit(shader["stage"].as<std::string>()) & stageMask)) continue;
+        key += (fs::path(folder) / shader["module"].as<std::string>()).lexically_normal().generic_string() + ";";
+    }
+
+    // Defaults live in the material, so two materials sharing a shader may still differ
+    if (pipeline["specialization_constants"]) {
+        key += YAML::Dump(pipeline["specialization_constants"]);
+    }
+    return key + specializationKey(specialization);
+}
+
+// Vertex input, pre-rasterization, fragment shader and fragment output parts, each shared with
+// every material whose part matches. Materials differing only in dynamic raster state, like
+// wireframe variants, reuse every part and only pay for a link.
+Result<VkPipeline, std::string> linkPipelineLibraries(
+        MaterialManager* materialManager,
+        YAML::Node& pipeline,
+        fs::path& basePath,
+        std::string& folder,
+        VkDevice device,
+        const ProvidedVertexLayout* providedLayout,
+        const MaterialInfo& layoutInfo,
+        const Specialization& specialization
+) {
+    PipelineBuilder builder;
+    builder.setLayout(layoutInfo.pipelineLayout);
+    setGraphicsState(pipeline, providedLayout, materialManager->usesDynamicPolygonMode(), builder);
+
     auto [bindings, attributes] = parseVertexInput(pipeline, providedLayout);
-    builder.setVertexInputState(bindings, attributes);
+    std::string vertexKey = "vertex|" + pipeline["topology"].as<std::string>();
+    for (const VkVertexInputBindingDescription& binding : bindings) {
+        vertexKey += fmt::format("|b{}:{}:{}", binding.binding, binding.stride, static_cast<U32>(binding.inputRate));
+    }
+    for (const VkVertexInputAttributeDescription& attribute : attributes) {
+        vertexKey += fmt::format(
+                "|a{}:{}:{}:{}", attribute.location, attribute.binding, static_cast<U32>(attribute.format), attribute.offset
+        );
+    }
 
-    PipelineInfo piplineInfo = builder.build(device);
-    MaterialInfo output = {
-        .pipeline = piplineInfo.pipeline,
-        .pipelineLayout = piplineInfo.layout,
-        .pushConstants = pushConstantsInfo,
-        .descriptorSets = layouts,
-        .type = MaterialType::Opaque,   // TODO: materialtypes
+    // Cull mode, front face and depth state are dynamic and left out of the keys, polygon mode when it can be
+    std::string layoutKey = pipelineLayoutKey(layoutInfo);
+    VkShaderStageFlags preRasterizationStages = VK_SHADER_STAGE_ALL_GRAPHICS & ~VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    std::string preRasterizationKey = fmt::format(
+            "preraster|{}|{}|{}",
+            layoutKey,
+            shaderKey(pipeline, folder, preRasterizationStages, specialization),
+            materialManager->usesDynamicPolygonMode() ? "" : pipeline["polygon_mode"].as<std::string>()
+    );
+
+    std::string fragmentKey = fmt::format(
+            "fragment|{}|{}|{}",
+            layoutKey,
+            shaderKey(pipeline, folder, VK_SHADER_STAGE_FRAGMENT_BIT, specialization),
+            pipeline["multisampling"].as<std::string>()
+    );
+
+    std::string outputKey = fmt::format(
+            "output|{}|{}|{}",
+            pipeline["blending"].as<std::string>(),
+            pipeline["color_format"].as<std::string>(),
+            pipeline["multisampling"].as<std::string>()
+    );
+
+    auto buildPart = [&](VkGraphicsPipelineLibraryFlagsEXT part, VkShaderStageFlags stages) {
+        std::vector<VkShaderModule> shaderModules;
+        if (stages != 0) {
+            shaderModules = addShaders(pipeline, basePath, folder, device, specialization, stages, builder);
+        }
+
+        Duration::TimePoint buildStart = Duration::now();
+        VkPipeline library = builder.buildLibrary(device, part, materialManager->getPipelineCache());
+        materialManager->recordPipelineBuild(Duration::since(buildStart));
+
+        for (VkShaderModule module : shaderModules) {
+            vkDestroyShaderModule(device, module, nullptr);
+        }
+        return library;
     };
 
+    std::array<VkPipeline, 4> libraries = {
+        materialManager->getPipelineLibrary(vertexKey, [&]() {
+            return buildPart(VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT, 0);
+        }),
+        materialManager->getPipelineLibrary(preRasterizationKey, [&]() {
+            return buildPart(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT, preRasterizationStages);
+        }),
+        materialManager->getPipelineLibrary(fragmentKey, [&]() {
+            return buildPart(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT, VK_SHADER_STAGE_FRAGMENT_BIT);
+        }),
+        materialManager->getPipelineLibrary(outputKey, [&]() {
+            return buildPart(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT, 0);
+        }),
+    };
+
+    for (VkPipeline library : libraries) {
+        if (library == nullptr) {
+            return std::unexpected(fmt::format("Couldn't create the pipeline libraries of {}", folder));
+        }
+    }
+
+    Duration::TimePoint linkStart = Duration::now();
+    PipelineInfo pipelineInfo = builder.link(device, libraries, materialManager->getPipelineCache());
+    materialManager->recordPipelineBuild(Duration::since(linkStart));
+    if (!pipelineInfo.success) {
+        return std::unexpected(fmt::format("Couldn't link the pipeline of {}", folder));
+    }
+
+    return pipelineInfo.pipeline;
+}
+
+Result<VkPipeline, std::string> yamlToPipeline(
+        MaterialManager* materialManager,
+        YAML::Node& yaml,
+        fs::path& basePath,
+        std::string& folder,
+        VkDevice device,
+        const ProvidedVertexLayout* providedLayout,
+        const MaterialInfo& layoutInfo,
+        const Specialization& specialization
+) {
+    YAML::Node pipeline = yaml["pipeline"];
+
+    if (layoutInfo.type != MaterialType::Compute && materialManager->usesPipelineLibraries()) {
+        return linkPipelineLibraries(
+                materialManager, pipeline, basePath, folder, device, providedLayout, layoutInfo, specialization
+        );
+    }
+
+    PipelineBuilder builder;
+    builder.setLayout(layoutInfo.pipelineLayout);
+
+    std::vector<VkShaderModule> shaderModules = addShaders(
+            pipeline, basePath, folder, device, specialization, VK_SHADER_STAGE_ALL, builder
+    );
+
+    // Compute materials only have a layout and a single shader
+    bool compute = layoutInfo.type == MaterialType::Compute;
+    if (!compute) {
+        setGraphicsState(pipeline, providedLayout, materialManager->usesDynamicPolygonMode(), builder);
+    }
+
+    Duration::TimePoint buildStart = Duration::now();
+    PipelineInfo pipelineInfo = compute
+            ? builder.buildCompute(device, materialManager->getPipelineCache())
+            : builder.build(device, materialManager->getPipelineCache());
+    materialManager->recordPipelineBuild(Duration::since(buildStart));
+
     for (VkShaderModule module : shaderModules) {
         vkDestroyShaderModule(device, module, nullptr);
     }
 
+    if (!pipelineInfo.success) {
+        return std::unexpected(fmt::format("Couldn't create the pipeline of {}", folder));
+    }
+
+    return pipelineInfo.pipeline;
+}
+
+Result<MaterialInfo, std::string> yamlToInfo(
+        MaterialManager* materialManager,
+        YAML::Node& yaml, fs::path& basePath,
+        std::string& folder,
+        VkDevice device,
+        const ProvidedVertexLayout* providedLayout,
+        const Specialization& specialization
+) {
+    Result<MaterialInfo, std::string> output = yamlToPipelineLayout(materialManager, yaml, basePath, folder);
+    if (!output.has_value()) {
+        return output;
+    }
+
+    Result<VkPipeline, std::string> pipeline = yamlToPipeline(
+            materialManager, yaml, basePath, folder, device, providedLayout, output.value(), specialization
+    );
+    if (!pipeline.has_value()) {
+        materialManager->dropPipelineLayout(output->pipelineLayout);
+        for (DescriptorSetInfo& set : output->descriptorSets) {
+            materialManager->dropLayout(&set);
+        }
+        return std::unexpected(pipeline.error());
+    }
+
+    output->pipeline = pipeline.value();
     return output;
 }
 
@@ -10,18 +10,49 @@
 
 namespace MaterialManagerUtils {
 
-Result<DescriptorSetInfo, std::string> yamlToLayout(
-    YAML::Node& yaml,
+// Bindings of a descriptor_layout file, for layouts no single material owns
+std::vector<DescriptorBindingInfo> yamlToBindings(const YAML::Node& yaml);
+
+Result<DescriptorSetInfo, std::string> bindingsToLayout(
+    const std::vector<DescriptorBindingInfo>& bindings,
     VkDevice device
 );
 
+// Binding, type, stages and count of each binding, equal keys give interchangeable layouts
+std::string descriptorLayoutKey(const std::vector<DescriptorBindingInfo>& bindings);
+
+// Appended to a material path to key one variant's pipeline
+std::string specializationKey(const Specialization& specialization);
+
+// Descriptor set layouts reflected from the shaders' SPIR-V, push constants and the pipeline
+// layout, without building the pipeline. Set 0 of graphics materials is the global set.
+Result<MaterialInfo, std::string> yamlToPipelineLayout(
+    MaterialManager* materialManager,
+    YAML::Node& yaml,
+    fs::path& basePath,
+    std::string& folder
+);
+
+// Compiles the shaders into a pipeline using the layout from yamlToPipelineLayout
+Result<VkPipeline, std::string> yamlToPipeline(
+    MaterialManager* materialManager,
+    YAML::Node& yaml,
+    fs::path& basePath,
+    std::string& folder,
+    VkDevice device,
+    const ProvidedVertexLayout* providedLayout,
+    const MaterialInfo& layoutInfo,
+    const Specialization& specialization = {}
+);
+
 Result<MaterialInfo, std::string> yamlToInfo(
     MaterialManager* materialManager,
     YAML::Node& yaml,
     fs::path& basePath,
     std::string& folder,
     VkDevice device,
-    const ProvidedVertexLayout* providedLayout
+    const ProvidedVertexLayout* providedLayout,
+    const Specialization& specialization = {}
 );
 
 }
@@ -61,6 +61,39 @@ bool Buffer::init(
     return true;
 }
 
+bool Buffer::initSparse(
+        VulkanInfo* vkInfo,
+        Size size,
+        VkBufferUsageFlags bufferUsage,
+        std::string name
+) {
+    std::vector families = {vkInfo->graphicsQueueFamily, vkInfo->transferQueueFamily};
+
+    VkBufferCreateInfo bufferInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = VK_BUFFER_CREATE_SPARSE_BINDING_BIT | VK_BUFFER_CREATE_SPARSE_RESIDENCY_BIT,
+        .size = size,
+        .usage = bufferUsage,
+        .sharingMode = VK_SHARING_MODE_CONCURRENT,
+        .queueFamilyIndexCount = static_cast<U32>(families.size()),
+        .pQueueFamilyIndices = families.data(),
+    };
+
+    VkResult res = vkCreateBuffer(vkInfo->device, &bufferInfo, nullptr, &buffer);
+    if (!VkUtils::checkVkResult(res, "Failed to create sparse buffer")) {
+        return false;
+    }
+
+    Debug::SetObjectName(vkInfo->device, (U64)buffer, VK_OBJECT_TYPE_BUFFER, name.c_str());
+
+    allocation = VK_NULL_HANDLE;
+    info = {};
+    m_vkInfo = vkInfo;
+
+    return true;
+}
+
 void Buffer::shutdown() {
     vmaDestroyBuffer(m_vkInfo->allocator, buffer, allocation);
     buffer = VK_NULL_HANDLE;
@@ -92,6 +125,11 @@ void Buffer::unmap() {
     info.pMappedData = nullptr;
 }
 
+void Buffer::invalidate() {
+    VkResult res = vmaInvalidateAllocation(m_vkInfo->allocator, allocation, 0, VK_WHOLE_SIZE);
+    VkUtils::checkVkResult(res, "Failed to invalidate buffer memory");
+}
+
 VkDeviceAddress Buffer::getAddress() {
     if (address != 0) return address;
 
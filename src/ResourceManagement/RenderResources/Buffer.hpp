@@ -23,11 +23,22 @@ public:
             std::string name
     );
 
+    // Sparse buffers have no backing allocation until pages are bound
+    bool initSparse(
+            VulkanInfo* vkInfo,
+            Size size,
+            VkBufferUsageFlags bufferUsage,
+            std::string name
+    );
+
     void shutdown();
 
     void map();
     void unmap();
 
+    // Before reading GPU writes through the mapping
+    void invalidate();
+
     VkDeviceAddress getAddress();
 
 private:
@@ -57,12 +57,35 @@ void DescriptorSet::writeImageSampler(U32 binding, Image* image, Sampler sampler
     vkUpdateDescriptorSets(m_vkInfo->device, 1, &write, 0, nullptr);
 }
 
+void DescriptorSet::writeStorageImage(U32 binding, VkImageView view, U32 arrayElement) {
+    VkDescriptorImageInfo imageInfo = {
+        .sampler = VK_NULL_HANDLE,
+        .imageView = view,
+        .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+    };
+
+    VkWriteDescriptorSet write = {
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .pNext = nullptr,
+        .dstSet = m_descriptorSet,
+        .dstBinding = binding,
+        .dstArrayElement = arrayElement,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+        .pImageInfo = &imageInfo,
+        .pBufferInfo = nullptr,
+        .pTexelBufferView = nullptr,
+    };
+
+    vkUpdateDescriptorSets(m_vkInfo->device, 1, &write, 0, nullptr);
+}
+
 void DescriptorSet::bindBuffer(
     VkCommandBuffer commandBuffer,
     VkPipelineBindPoint pipelineBindPoint,
     VkPipelineLayout pipelineLayout,
     U32 setIndex
-) {
+) const {
     vkCmdBindDescriptorSets(
         commandBuffer,
         pipelineBindPoint,
@@ -23,6 +23,7 @@ public:
 
     void writeUniformBuffer(U32 binding, Buffer* buffer, VkDeviceSize size, VkDeviceSize offset);
     void writeImageSampler(U32 binding, Image* image, Sampler sampler);
+    void writeStorageImage(U32 binding, VkImageView view, U32 arrayElement = 0);
 
     VkDescriptorSet get() const { return m_descriptorSet; }
 
@@ -31,7 +32,7 @@ public:
         VkPipelineBindPoint pipelineBindPoint,
         VkPipelineLayout pipelineLayout,
         U32 setIndex
-    );
+    ) const;
 
 private:
     VulkanInfo* m_vkInfo = nullptr;
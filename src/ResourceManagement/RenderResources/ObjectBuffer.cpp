@@ -0,0 +1,70 @@
+// src/ResourceManagement/RenderResources/ObjectBuffer.cpp
+
+#include "ObjectBuffer.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <cassert>
+
+bool ObjectBuffer::init(VulkanInfo* vkInfo, Size stride, U32 capacity, std::string name) {
+    // buffer_reference blocks default to 16 byte alignment
+    m_stride = (stride + 15) & ~static_cast<Size>(15);
+    m_capacity = capacity;
+
+    VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                               VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+    if (!m_buffer.init(
+            vkInfo,
+            m_stride * m_capacity,
+            usage,
+            VMA_MEMORY_USAGE_CPU_TO_GPU,
+            VMA_ALLOCATION_CREATE_MAPPED_BIT,
+            name
+    )) {
+        spdlog::error("Failed to create object buffer {}", name);
+        return false;
+    }
+
+    m_baseAddress = m_buffer.getAddress();
+
+    m_freeSlots.clear();
+    m_freeSlots.reserve(m_capacity);
+    for (U32 i = m_capacity; i > 0; i--) {
+        m_freeSlots.push_back(i - 1);
+    }
+
+    return true;
+}
+
+void ObjectBuffer::shutdown() {
+    m_buffer.shutdown();
+    m_baseAddress = 0;
+    m_freeSlots.clear();
+}
+
+Option<U32> ObjectBuffer::allocate() {
+    if (m_freeSlots.empty()) {
+        spdlog::warn("Object buffer is full ({} slots)", m_capacity);
+        return std::nullopt;
+    }
+
+    U32 slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+    return slot;
+}
+
+void ObjectBuffer::free(U32 slot) {
+    assert(slot < m_capacity && "Object slot out of range!");
+    m_freeSlots.push_back(slot);
+}
+
+void* ObjectBuffer::getData(U32 slot) {
+    assert(slot < m_capacity && "Object slot out of range!");
+    return static_cast<U8*>(m_buffer.info.pMappedData) + slot * m_stride;
+}
+
+VkDeviceAddress ObjectBuffer::getAddress(U32 slot) {
+    assert(slot < m_capacity && "Object slot out of range!");
+    return m_baseAddress + slot * m_stride;
+}
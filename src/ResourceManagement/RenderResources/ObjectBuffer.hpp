@@ -0,0 +1,37 @@
+// src/ResourceManagement/RenderResources/ObjectBuffer.hpp
+
+#pragma once
+
+#include "Buffer.hpp"
+#include "Core/Types.hpp"
+#include "RenderEngine/VulkanInfo.hpp"
+
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Shared, persistently mapped buffer of fixed size per-object slots.
+// Shaders reach a slot through its device address (GL_EXT_buffer_reference),
+// so per-object data only costs a push constant write per draw.
+class ObjectBuffer {
+public:
+    bool init(VulkanInfo* vkInfo, Size stride, U32 capacity, std::string name);
+    void shutdown();
+
+    Option<U32> allocate();
+    void free(U32 slot);
+
+    void* getData(U32 slot);
+    VkDeviceAddress getAddress(U32 slot);
+
+    Size getStride() const { return m_stride; }
+    U32 getCapacity() const { return m_capacity; }
+
+private:
+    Buffer m_buffer;
+    VkDeviceAddress m_baseAddress = 0;
+
+    Size m_stride = 0;
+    U32 m_capacity = 0;
+    std::vector<U32> m_freeSlots;
+};
@@ -2,212 +2,273 @@
 
 #include "SparseBuffer.hpp"
 
+#include "RenderEngine/SparseBinder.hpp"
 #include "RenderEngine/VkUtils.hpp"
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
 bool SparseBuffer::init(
         VulkanInfo* vkInfo,
         Size size,
         VkBufferUsageFlags bufferUsage,
         VmaMemoryUsage memoryUsage,
-        VmaAllocationCreateFlags allocFlags,
-        Size pageSize
+        std::string name
 ) {
     m_vkInfo = vkInfo;
-    m_allocFlags = allocFlags;
-    m_memoryUsage = memoryUsage;
-    m_pageSize = pageSize;
-
-    return buffer.init(
-        vkInfo,
-        size,
-        bufferUsage |
-            VK_BUFFER_CREATE_SPARSE_BINDING_BIT |
-            VK_BUFFER_CREATE_SPARSE_RESIDENCY_BIT,
-        memoryUsage,
-        allocFlags,
-        "SparseBufferSHOULDN'tBeused"
-    );
-};
+    m_pageSize = m_vkInfo->sparseHeap->getPageSize();
 
-void SparseBuffer::shutdown() {
-    m_pendingBinds.clear();
-    for (const Allocation& allocation : m_allocations) {
-        freeMemory(allocation);
+    if (!buffer.initSparse(vkInfo, size, bufferUsage, name)) {
+        return false;
     }
-    buffer.shutdown();
-}
 
-void SparseBuffer::bindMemory(Size size, Size offset) {
-    size = align(size);
-    offset = align(offset);
+    VkMemoryRequirements memReq;
+    vkGetBufferMemoryRequirements(m_vkInfo->device, buffer.buffer, &memReq);
 
-    Allocation* allocation = allocateMemory(size, offset);
-    if (!allocation) {
-        spdlog::error("Failed to allocate memory for bind at offset {} with size {}", offset, size);
-        return;
+    if (memReq.alignment > m_pageSize || m_pageSize % memReq.alignment != 0) {
+        spdlog::error("Sparse buffer alignment {} incompatible with heap page size {}", memReq.alignment, m_pageSize);
+        buffer.shutdown();
+        return false;
     }
 
-    VkSparseMemoryBind bind = {
-        .resourceOffset = offset,
-        .size = size,
-        .memory = allocation->info.deviceMemory,
-        .memoryOffset = allocation->info.offset,
+    VmaAllocationCreateInfo allocInfo = {
         .flags = 0,
+        .usage = memoryUsage,
+        .requiredFlags = 0,
+        .preferredFlags = 0,
+        .memoryTypeBits = 0,
+        .pool = nullptr,
+        .pUserData = nullptr,
+        .priority = 0,
     };
 
-    m_pendingBinds.push_back(bind);
+    VkResult res = vmaFindMemoryTypeIndex(m_vkInfo->allocator, memReq.memoryTypeBits, &allocInfo, &m_memoryType);
+    if (!VkUtils::checkVkResult(res, "Failed to find sparse buffer memory type")) {
+        buffer.shutdown();
+        return false;
+    }
+
+    m_pageCount = (size + m_pageSize - 1) / m_pageSize;
+    m_pages.assign(m_pageCount, SparsePage{VK_NULL_HANDLE, 0, nullptr, 0});
+    m_residentRanges.clear();
+    m_residentPages = 0;
+
+    return true;
+};
+
+void SparseBuffer::shutdown() {
+    m_pendingBinds.clear();
+    for (const SparsePage& page : m_pages) {
+        if (page.memory != VK_NULL_HANDLE) m_vkInfo->sparseHeap->release(page);
+    }
+    m_pages.clear();
+    m_residentRanges.clear();
+    m_residentPages = 0;
+    buffer.shutdown();
 }
 
-void SparseBuffer::unbindMemory(Size size, Size offset) {
-    size = align(size);
-    offset = align(offset);
-
-    // Find allocation
-    Allocation allocation = {{},{},0,0};
-    for (Size i = 0; i < m_allocations.size(); i++) {
-        Allocation candidate = m_allocations[i];
-        if (candidate.size == size && candidate.offset == offset) {
-            allocation = candidate;
+void SparseBuffer::bindMemory(Size size, Size offset) {
+    PageRange range = toPages(size, offset);
+
+    for (Size page = range.first; page < range.last; page++) {
+        if (m_pages[page].memory != VK_NULL_HANDLE) continue;
+
+        Option<SparsePage> allocated = m_vkInfo->sparseHeap->allocate(m_memoryType);
+        if (!allocated.has_value()) {
+            spdlog::error("Failed to allocate sparse page {} for bind at offset {} with size {}", page, offset, size);
+            range.last = page;
             break;
         }
-    }
 
-    if (allocation.size != size || allocation.offset != offset) {
-        spdlog::warn("Allocation not found for unbinding at offset {} with size {}!", offset, size);
-        return;
-    }
+        m_pages[page] = allocated.value();
+        m_residentPages++;
+
+        // Extend the previous bind when both resource and memory are contiguous
+        if (!m_pendingBinds.empty()) {
+            VkSparseMemoryBind& previous = m_pendingBinds.back();
+            if (previous.memory == allocated->memory &&
+                    previous.resourceOffset + previous.size == page * m_pageSize &&
+                    previous.memoryOffset + previous.size == allocated->offset) {
+                previous.size += m_pageSize;
+                continue;
+            }
+        }
 
-    VkSparseMemoryBind bind = {
-        .resourceOffset = offset,
-        .size = size,
-        .memory = VK_NULL_HANDLE, // Null memory unbinds the range
-        .memoryOffset = 0,
-        .flags = 0
-    };
+        VkSparseMemoryBind bind = {
+            .resourceOffset = page * m_pageSize,
+            .size = m_pageSize,
+            .memory = allocated->memory,
+            .memoryOffset = allocated->offset,
+            .flags = 0,
+        };
+
+        m_pendingBinds.push_back(bind);
+    }
 
-    m_pendingBinds.push_back(bind);
-    freeMemory(allocation);
+    if (range.first < range.last) markResident(range.first, range.last);
 }
 
-void SparseBuffer::flushPendingBinds() {
-    if (m_pendingBinds.empty()) return;
+void SparseBuffer::unbindMemory(Size size, Size offset) {
+    PageRange range = toPages(size, offset);
 
-    VkBindSparseInfo bindInfo = {};
-    bindInfo.sType = VK_STRUCTURE_TYPE_BIND_SPARSE_INFO;
-    bindInfo.bufferBindCount = 1;
+    for (Size page = range.first; page < range.last; page++) {
+        if (m_pages[page].memory == VK_NULL_HANDLE) continue;
 
-    VkSparseBufferMemoryBindInfo bufferBindInfo = {};
-    bufferBindInfo.buffer = buffer.buffer;
-    bufferBindInfo.bindCount = static_cast<uint32_t>(m_pendingBinds.size());
-    bufferBindInfo.pBinds = m_pendingBinds.data();
+        m_vkInfo->sparseHeap->release(m_pages[page]);
+        m_pages[page] = {VK_NULL_HANDLE, 0, nullptr, 0};
+        m_residentPages--;
 
-    bindInfo.pBufferBinds = &bufferBindInfo;
+        if (!m_pendingBinds.empty()) {
+            VkSparseMemoryBind& previous = m_pendingBinds.back();
+            if (previous.memory == VK_NULL_HANDLE &&
+                    previous.resourceOffset + previous.size == page * m_pageSize) {
+                previous.size += m_pageSize;
+                continue;
+            }
+        }
+
+        VkSparseMemoryBind bind = {
+            .resourceOffset = page * m_pageSize,
+            .size = m_pageSize,
+            .memory = VK_NULL_HANDLE, // Null memory unbinds the range
+            .memoryOffset = 0,
+            .flags = 0
+        };
 
-    VkResult result = vkQueueBindSparse(m_vkInfo->transferQueue, 1, &bindInfo, VK_NULL_HANDLE);
-    if (!VkUtils::checkVkResult(result, "Failed to bind sparse memory")) {
-        return;
+        m_pendingBinds.push_back(bind);
     }
 
-    m_pendingBinds.clear();
+    if (range.first < range.last) markEvicted(range.first, range.last);
 }
 
-SparseBuffer::Allocation* SparseBuffer::allocateMemory(Size size, Size offset) {
-    size = align(size);
-    offset = align(offset);
+void SparseBuffer::flushPendingBinds() {
+    m_vkInfo->sparseBinder->queueBufferBinds(buffer.buffer, m_pendingBinds);
+    m_pendingBinds.clear();
+}
 
-    VmaAllocationCreateInfo allocInfo = {
-        .flags = m_allocFlags,
-        .usage = m_memoryUsage,
-        .requiredFlags = 0,
-        .preferredFlags = 0,
-        .memoryTypeBits = 0,
-        .pool = nullptr,
-        .pUserData = nullptr,
-        .priority = 0,
-    };
+bool SparseBuffer::isResident(Size size, Size offset) const {
+    PageRange range = toPages(size, offset);
+    if (range.first >= range.last) return true;
 
-    VmaAllocation vmaAllocation;
-    VkResult res = vmaAllocateMemoryForBuffer(
-            m_vkInfo->allocator, buffer.buffer, &allocInfo, &vmaAllocation, nullptr);
-    if (!VkUtils::checkVkResult(res, "Failed to allocate sparse memory!")) {
-        return nullptr;
-    }
+    auto it = m_residentRanges.upper_bound(range.first);
+    if (it == m_residentRanges.begin()) return false;
+    --it;
 
-    VmaAllocationInfo info;
-    vmaGetAllocationInfo(m_vkInfo->allocator, vmaAllocation, &info);
+    return it->second >= range.last;
+}
 
-    Allocation allocation = {
-        .allocation = vmaAllocation,
-        .info = info,
-        .size = size,
-        .offset = offset,
-    };
+Size SparseBuffer::getResidentBytes() const {
+    return m_residentPages * m_pageSize;
+}
 
-    m_allocations.push_back(allocation);
-    return &m_allocations.back();
+SparseBuffer::PageRange SparseBuffer::toPages(Size size, Size offset) const {
+    Size first = offset / m_pageSize;
+    Size last = (offset + size + m_pageSize - 1) / m_pageSize;
+    return {std::min(first, m_pageCount), std::min(last, m_pageCount)};
 }
 
-void SparseBuffer::freeMemory(Allocation allocation) {
-    vmaFreeMemory(m_vkInfo->allocator, allocation.allocation);
+void SparseBuffer::markResident(Size firstPage, Size lastPage) {
+    auto it = m_residentRanges.upper_bound(firstPage);
 
-    // Remove from allocated list
-    for (Size i = 0; i < m_allocations.size(); i++) {
-        const Allocation& candidate = m_allocations[i];
-        if (candidate.size == allocation.size && candidate.offset == allocation.offset) {
-            m_allocations.erase(m_allocations.begin() + i);
-            return;
+    // Merge with an overlapping or touching range on the left
+    if (it != m_residentRanges.begin()) {
+        auto previous = std::prev(it);
+        if (previous->second >= firstPage) {
+            firstPage = previous->first;
+            lastPage = std::max(lastPage, previous->second);
+            it = m_residentRanges.erase(previous);
         }
     }
 
-    spdlog::warn("Failed to find and remove Allocation from tracked state.");
-}
+    // Absorb every range starting inside or touching the new one
+    while (it != m_residentRanges.end() && it->first <= lastPage) {
+        lastPage = std::max(lastPage, it->second);
+        it = m_residentRanges.erase(it);
+    }
 
-Size SparseBuffer::align(Size in) {
-    return (in + m_pageSize - 1) & ~(m_pageSize - 1);
+    m_residentRanges[firstPage] = lastPage;
 }
 
-void* SparseBuffer::mapMemory(Size offset, Size size) {
-    size = align(size);
-    offset = align(offset);
-
-    for (const Allocation& allocation : m_allocations) {
-        if (allocation.offset == offset && allocation.size >= size) {
-            void* data = nullptr;
-            VkResult result = vmaMapMemory(m_vkInfo->allocator, allocation.allocation, &data);
-            if (!VkUtils::checkVkResult(result, "Failed to map memory!")) {
-                return nullptr;
-            }
+void SparseBuffer::markEvicted(Size firstPage, Size lastPage) {
+    auto it = m_residentRanges.upper_bound(firstPage);
+    if (it != m_residentRanges.begin()) --it;
 
-            return static_cast<char*>(data) + (offset - allocation.offset);
+    while (it != m_residentRanges.end() && it->first < lastPage) {
+        Size rangeFirst = it->first;
+        Size rangeLast = it->second;
+
+        if (rangeLast <= firstPage) {
+            ++it;
+            continue;
         }
-    }
 
-    spdlog::warn("No allocation found for mapping the specified region");
-    return nullptr;
+        // Split off whatever survives on either side
+        it = m_residentRanges.erase(it);
+        if (rangeFirst < firstPage) m_residentRanges[rangeFirst] = firstPage;
+        if (rangeLast > lastPage) {
+            m_residentRanges[lastPage] = rangeLast;
+            break;
+        }
+    }
 }
 
-void SparseBuffer::unmapMemory(Size offset) {
-    offset = align(offset);
+void* SparseBuffer::mapMemory(Size offset, Size size) {
+    // Pages are persistently mapped but not contiguous, so a mapping never crosses a page
+    Size page = offset / m_pageSize;
+    if (page >= m_pageCount || offset + size > (page + 1) * m_pageSize) {
+        spdlog::warn("Mapping at offset {} with size {} crosses a page boundary", offset, size);
+        return nullptr;
+    }
+
+    const SparsePage& sparsePage = m_pages[page];
+    if (sparsePage.memory == VK_NULL_HANDLE) {
+        spdlog::warn("Attempted to map non-resident page {}", page);
+        return nullptr;
+    }
 
-    for (const Allocation& allocation : m_allocations) {
-        if (allocation.offset <= offset && allocation.offset + allocation.size > offset) {
-            vmaUnmapMemory(m_vkInfo->allocator, allocation.allocation);
-            return;
-        }
+    if (!sparsePage.mapped) {
+        spdlog::warn("Sparse buffer memory is not host visible");
+        return nullptr;
     }
 
-    spdlog::warn("No allocation found for unmapping the specified region");
+    return static_cast<U8*>(sparsePage.mapped) + (offset - page * m_pageSize);
 }
 
 void SparseBuffer::updateData(const void* data, Size size, Size offset) {
-    size = align(size);
-    offset = align(offset);
+    const U8* src = static_cast<const U8*>(data);
+
+    while (size > 0) {
+        Size pageEnd = (offset / m_pageSize + 1) * m_pageSize;
+        Size chunk = std::min(size, pageEnd - offset);
+
+        void* mappedMemory = mapMemory(offset, chunk);
+        if (!mappedMemory) return;
+        std::memcpy(mappedMemory, src, chunk);
+
+        src += chunk;
+        offset += chunk;
+        size -= chunk;
+    }
+}
+
+void SparseBuffer::readData(void* data, Size size, Size offset) {
+    U8* dst = static_cast<U8*>(data);
+
+    while (size > 0) {
+        Size pageEnd = (offset / m_pageSize + 1) * m_pageSize;
+        Size chunk = std::min(size, pageEnd - offset);
 
-    void* mappedMemory = mapMemory(offset, size);
-    std::memcpy(mappedMemory, data, size);
-    unmapMemory(offset);
+        void* mappedMemory = mapMemory(offset, chunk);
+        if (!mappedMemory) return;
+        std::memcpy(dst, mappedMemory, chunk);
+
+        dst += chunk;
+        offset += chunk;
+        size -= chunk;
+    }
 }
 
 Size SparseBuffer::getPageSize() const {
@@ -4,57 +4,68 @@
 
 #include "Buffer.hpp"
 #include "Core/Types.hpp"
+#include "RenderEngine/SparsePageHeap.hpp"
 
 #include <vulkan/vulkan.h>
 #include <vk_mem_alloc.h>
 
+#include <map>
+#include <string>
 #include <vector>
 
 class SparseBuffer {
 public:
     Buffer buffer;
 
+    // Page size is the shared sparse heap's page size
     bool init(
             VulkanInfo* vkInfo,
             Size size,
             VkBufferUsageFlags bufferUsage,
             VmaMemoryUsage memoryUsage,
-            VmaAllocationCreateFlags allocFlags,
-            Size pageSize
+            std::string name
     );
     void shutdown();
 
+    // Ranges are page aligned outwards, already (non)resident pages are skipped
     void bindMemory(Size size, Size offset);
     void unbindMemory(Size size, Size offset);
     void flushPendingBinds();
 
+    bool isResident(Size size, Size offset) const;
+    Size getResidentBytes() const;
+
+    // Host visible memory only, copies may span pages
     void updateData(const void* data, Size size, Size offset);
+    void readData(void* data, Size size, Size offset);
 
     Size getPageSize() const;
 
 private:
-    struct Allocation {
-        VmaAllocation allocation;
-        VmaAllocationInfo info;
-        Size size;
-        Size offset;
+    struct PageRange {
+        Size first;
+        Size last;  // exclusive
     };
 
-    Allocation* allocateMemory(Size size, Size offset);
-    void freeMemory(Allocation allocation);
+    PageRange toPages(Size size, Size offset) const;
 
-    Size align(Size size);
+    void markResident(Size firstPage, Size lastPage);
+    void markEvicted(Size firstPage, Size lastPage);
 
     void* mapMemory(Size offset, Size size);
-    void unmapMemory(Size offset);
 
     VulkanInfo* m_vkInfo;
     Size m_pageSize;
-    VmaMemoryUsage m_memoryUsage;
-    VmaAllocationCreateFlags m_allocFlags;
+    Size m_pageCount;
+    U32 m_memoryType;
 
     std::vector<VkSparseMemoryBind> m_pendingBinds;
-    std::vector<Allocation> m_allocations;
 
-};
+    // Page table, memory == VK_NULL_HANDLE for non-resident pages
+    std::vector<SparsePage> m_pages;
 
+    // Merged resident page intervals, first -> last (exclusive)
+    std::map<Size, Size> m_residentRanges;
+    Size m_residentPages = 0;
+
+};
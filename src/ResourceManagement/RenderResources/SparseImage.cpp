@@ -1,31 +1,36 @@
-// src/ResourceManagement/RenderResources/SparseBuffer.cpp
+// src/ResourceManagement/RenderResources/SparseImage.cpp
 
 #include "SparseImage.hpp"
 
+#include "RenderEngine/Debug.hpp"
+#include "RenderEngine/SparseBinder.hpp"
 #include "RenderEngine/VkUtils.hpp"
 
+#include <fmt/core.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
 bool SparseImage::init(
         VulkanInfo* vkInfo,
-        Vector<U32, 3> size,
-        VkFormat format,
-        VkImageUsageFlags usage
+        Vector<U32, 2> imageSize,
+        VkFormat imageFormat,
+        VkImageUsageFlags usage,
+        U32 mipLevels,
+        std::string name
 ) {
     m_vkInfo = vkInfo;
+    size = imageSize;
+    format = imageFormat;
+    this->mipLevels = mipLevels;
 
     // Check device capabilities
     VkPhysicalDeviceFeatures features;
     vkGetPhysicalDeviceFeatures(m_vkInfo->physicalDevice, &features);
     assert(features.sparseBinding);
 
-    // Get min tile size
-    VkSparseImageMemoryRequirements sparseReq = {};
-    uint32_t count = 1;
-    vkGetImageSparseMemoryRequirements(m_vkInfo->device, image, &count, &sparseReq);
-    granularity = sparseReq.formatProperties.imageGranularity;
-
     // Create VkImage
     VkImageCreateFlags flags = VK_IMAGE_CREATE_SPARSE_BINDING_BIT | VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT;
-    U32 mipLevels = 1;
     U32 arrayLayers = 1;
 
     std::vector families = {vkInfo->graphicsQueueFamily, vkInfo->transferQueueFamily};
@@ -36,7 +41,7 @@ bool SparseImage::init(
         .flags = flags,
         .imageType = VK_IMAGE_TYPE_2D,
         .format = format,
-        .extent = size,
+        .extent = {size.value.x, size.value.y, 1},
         .mipLevels = mipLevels,
         .arrayLayers = arrayLayers,
         .samples = VK_SAMPLE_COUNT_1_BIT,
@@ -53,83 +58,242 @@ bool SparseImage::init(
         return false;
     }
 
+    Debug::SetObjectName(m_vkInfo->device, (U64)image, VK_OBJECT_TYPE_IMAGE, fmt::format("{}'s image", name).c_str());
+
+    // Tiles come from the shared page heap
+    VkMemoryRequirements memReq;
+    vkGetImageMemoryRequirements(m_vkInfo->device, image, &memReq);
+
+    VkDeviceSize pageSize = m_vkInfo->sparseHeap->getPageSize();
+    if (memReq.alignment > pageSize || pageSize % memReq.alignment != 0) {
+        spdlog::error("Sparse image block size {} incompatible with heap page size {}", memReq.alignment, pageSize);
+        vkDestroyImage(m_vkInfo->device, image, nullptr);
+        image = VK_NULL_HANDLE;
+        return false;
+    }
+
+    m_memoryType = VkUtils::findMemoryType(m_vkInfo, memReq.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    // Get min tile size and the mip tail
+    U32 count = 0;
+    vkGetImageSparseMemoryRequirements(m_vkInfo->device, image, &count, nullptr);
+    std::vector<VkSparseImageMemoryRequirements> sparseReqs(count);
+    vkGetImageSparseMemoryRequirements(m_vkInfo->device, image, &count, sparseReqs.data());
+
+    bool foundColor = false;
+    for (const VkSparseImageMemoryRequirements& req : sparseReqs) {
+        if (req.formatProperties.aspectMask & VK_IMAGE_ASPECT_COLOR_BIT) {
+            granularity = req.formatProperties.imageGranularity;
+            mipTailFirstLod = std::min(req.imageMipTailFirstLod, mipLevels);
+            foundColor = true;
+
+            if (!bindMipTail(req, 0)) return false;
+        } else if (req.formatProperties.aspectMask & VK_IMAGE_ASPECT_METADATA_BIT) {
+            if (!bindMipTail(req, VK_SPARSE_MEMORY_BIND_METADATA_BIT)) return false;
+        }
+    }
+
+    if (!foundColor) {
+        spdlog::error("Sparse image {} has no color sparse memory requirements", name);
+        return false;
+    }
+
+    VkImageViewCreateInfo viewInfo = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .image = image,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = format,
+
+        .components = {
+            .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .a = VK_COMPONENT_SWIZZLE_IDENTITY,
+        },
+
+        .subresourceRange = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = mipLevels,
+            .baseArrayLayer = 0,
+            .layerCount = arrayLayers,
+        },
+    };
+
+    result = vkCreateImageView(m_vkInfo->device, &viewInfo, nullptr, &view);
+    if (!VkUtils::checkVkResult(result, "Failed to create sparse image view")) {
+        return false;
+    }
+
+    Debug::SetObjectName(m_vkInfo->device, (U64)view, VK_OBJECT_TYPE_IMAGE_VIEW, fmt::format("{}'s image view", name).c_str());
+
     return true;
 }
 
-void SparseImage::bindMemory(U32 tileX, U32 tileY, VkDeviceMemory memory) {
+bool SparseImage::bindMipTail(const VkSparseImageMemoryRequirements& requirements, VkSparseMemoryBindFlags flags) {
+    // Single layer, so the first tail is the only one
+    if (requirements.imageMipTailSize == 0) return true;
+
+    // The tail is one opaque range, backed page by page since heap pages are not contiguous
+    VkDeviceSize pageSize = m_vkInfo->sparseHeap->getPageSize();
+    for (VkDeviceSize offset = 0; offset < requirements.imageMipTailSize; offset += pageSize) {
+        Option<SparsePage> page = m_vkInfo->sparseHeap->allocate(m_memoryType);
+        if (!page.has_value()) {
+            spdlog::error("Failed to allocate sparse mip tail page");
+            return false;
+        }
+
+        m_tailPages.push_back(page.value());
+        m_pendingOpaqueBinds.push_back({
+            .resourceOffset = requirements.imageMipTailOffset + offset,
+            .size = std::min(pageSize, requirements.imageMipTailSize - offset),
+            .memory = page->memory,
+            .memoryOffset = page->offset,
+            .flags = flags,
+        });
+    }
+
+    return true;
+}
+
+ImageView SparseImage::createMipView(U32 mipLevel, const std::string& name) const {
+    if (mipLevel >= mipLevels) {
+        spdlog::error("Mip level {} out of bounds (max {}).", mipLevel, mipLevels - 1);
+        return {};
+    }
+
+    VkImageViewCreateInfo viewInfo = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .image = image,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = format,
+
+        .components = {
+            .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .a = VK_COMPONENT_SWIZZLE_IDENTITY,
+        },
+
+        .subresourceRange = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = mipLevel,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        }
+    };
+
+    VkImageView newView;
+    VkResult result = vkCreateImageView(m_vkInfo->device, &viewInfo, nullptr, &newView);
+    if (!VkUtils::checkVkResult(result, fmt::format("Failed to create mip view at level {}", mipLevel))) {
+        return {};
+    }
+
+    if (!name.empty()) {
+        Debug::SetObjectName(m_vkInfo->device, (U64)newView, VK_OBJECT_TYPE_IMAGE_VIEW, name.c_str());
+    }
+
+    return ImageView::create(m_vkInfo, newView);
+}
+
+Vector<U32, 2> SparseImage::getMipSize(U32 mipLevel) const {
+    return {std::max(size.value.x >> mipLevel, 1u), std::max(size.value.y >> mipLevel, 1u)};
+}
+
+Vector<U32, 2> SparseImage::getTileCount(U32 mipLevel) const {
+    Vector<U32, 2> mipSize = getMipSize(mipLevel);
+    return {
+        (mipSize.value.x + granularity.width - 1) / granularity.width,
+        (mipSize.value.y + granularity.height - 1) / granularity.height,
+    };
+}
+
+void SparseImage::bindMemory(U32 tileX, U32 tileY, U32 mipLevel, VkDeviceMemory memory, VkDeviceSize memoryOffset) {
+    Vector<U32, 2> mipSize = getMipSize(mipLevel);
+    U32 x = tileX * granularity.width;
+    U32 y = tileY * granularity.height;
+
     VkSparseImageMemoryBind bind{};
     bind.subresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    bind.subresource.mipLevel = 0;
+    bind.subresource.mipLevel = mipLevel;
     bind.subresource.arrayLayer = 0;
     bind.offset = {
-        .x = static_cast<int32_t>(tileX * granularity.width),
-        .y = static_cast<int32_t>(tileY * granularity.height),
+        .x = static_cast<int32_t>(x),
+        .y = static_cast<int32_t>(y),
         .z = 0
     };
-    bind.extent = granularity;
-    bind.memory = memory;   // unbind it
-    bind.memoryOffset = 0;
+    // Edge tiles may be clipped to the mip extent
+    bind.extent = {
+        .width = std::min(granularity.width, mipSize.value.x - x),
+        .height = std::min(granularity.height, mipSize.value.y - y),
+        .depth = 1,
+    };
+    bind.memory = memory;   // null unbinds the tile
+    bind.memoryOffset = memoryOffset;
     bind.flags = 0;
 
-    VkSparseImageMemoryBindInfo bindInfo{};
-    bindInfo.image = image;
-    bindInfo.bindCount = 1;
-    bindInfo.pBinds = &bind;
-
-    VkBindSparseInfo sparseInfo{};
-    sparseInfo.sType = VK_STRUCTURE_TYPE_BIND_SPARSE_INFO;
-    sparseInfo.imageBindCount = 1;
-    sparseInfo.pImageBinds = &bindInfo;
+    m_pendingBinds.push_back(bind);
+}
 
-    vkQueueBindSparse(m_vkInfo->graphicsQueue, 1, &sparseInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(m_vkInfo->graphicsQueue);   // wait for binding to complete
+void SparseImage::flushPendingBinds() {
+    m_vkInfo->sparseBinder->queueImageOpaqueBinds(image, m_pendingOpaqueBinds);
+    m_vkInfo->sparseBinder->queueImageBinds(image, m_pendingBinds);
+    m_pendingOpaqueBinds.clear();
+    m_pendingBinds.clear();
 }
 
-void SparseImage::bindTile(U32 tileX, U32 tileY) {
+void SparseImage::bindTile(U32 tileX, U32 tileY, U32 mipLevel) {
     assert(image != nullptr);
+    assert(mipLevel < mipTailFirstLod && "Mip tail levels are always resident");
 
-    VkMemoryRequirements memReq;
-    vkGetImageMemoryRequirements(m_vkInfo->device, image, &memReq);
+    U64 key = packTile(tileX, tileY, mipLevel);
+    if (memoryMap.contains(key)) return;
 
-    // Align memory size to granularity
-    VkMemoryAllocateInfo allocInfo = {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext = nullptr,
-        .allocationSize = memReq.alignment,
-        .memoryTypeIndex = VkUtils::findMemoryType(m_vkInfo, memReq.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
-    };
-
-    VkDeviceMemory memory = VK_NULL_HANDLE;
-    VkResult result = vkAllocateMemory(m_vkInfo->device, &allocInfo, nullptr, &memory);
-    if (!VkUtils::checkVkResult(result, "Failed to allocate sparse tile memory")) return;
-
-    // Bind tile
-    bindMemory(tileX, tileY, memory);
+    Option<SparsePage> page = m_vkInfo->sparseHeap->allocate(m_memoryType);
+    if (!page.has_value()) {
+        spdlog::error("Failed to allocate sparse tile ({}, {}) at mip {}", tileX, tileY, mipLevel);
+        return;
+    }
 
-    // Store VkDeviceMemory
-    memoryMap[{tileX, tileY}] = memory;
+    bindMemory(tileX, tileY, mipLevel, page->memory, page->offset);
+    memoryMap[key] = page.value();
 }
 
-void SparseImage::unbindTile(U32 tileX, U32 tileY) {
-    auto it = memoryMap.find({tileX, tileY});
+void SparseImage::unbindTile(U32 tileX, U32 tileY, U32 mipLevel) {
+    auto it = memoryMap.find(packTile(tileX, tileY, mipLevel));
     if (it == memoryMap.end()) return;
 
-    VkDeviceMemory memory = it->second;
-
-    bindMemory(tileX, tileY, nullptr);
+    bindMemory(tileX, tileY, mipLevel, VK_NULL_HANDLE, 0);
 
-    vkFreeMemory(m_vkInfo->device, memory, nullptr);
+    m_vkInfo->sparseHeap->release(it->second);
     memoryMap.erase(it);
 }
 
+bool SparseImage::isTileResident(U32 tileX, U32 tileY, U32 mipLevel) const {
+    if (mipLevel >= mipTailFirstLod) return true;
+    return memoryMap.contains(packTile(tileX, tileY, mipLevel));
+}
+
 void SparseImage::shutdown() {
-    for (auto& [coord, mem] : memoryMap) {
-        unbindTile(coord.first, coord.second);
-        vkFreeMemory(m_vkInfo->device, mem, nullptr);
+    for (auto& [coord, page] : memoryMap) {
+        m_vkInfo->sparseHeap->release(page);
+    }
+    for (const SparsePage& page : m_tailPages) {
+        m_vkInfo->sparseHeap->release(page);
     }
 
-    vkDestroyImage(m_vkInfo->device, image, nullptr);
-    vkDestroyImageView(m_vkInfo->device, view, nullptr);
+    m_pendingBinds.clear();
+    m_pendingOpaqueBinds.clear();
     memoryMap.clear();
-}
+    m_tailPages.clear();
 
+    vkDestroyImageView(m_vkInfo->device, view, nullptr);
+    vkDestroyImage(m_vkInfo->device, image, nullptr);
+    view = VK_NULL_HANDLE;
+    image = VK_NULL_HANDLE;
+}
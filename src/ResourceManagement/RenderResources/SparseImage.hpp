@@ -1,46 +1,68 @@
-// src/ResourceManagement/RenderResources/SparseBuffer.hpp
+// src/ResourceManagement/RenderResources/SparseImage.hpp
 
 #pragma once
 
 #include "Core/Vector.hpp"
+#include "RenderEngine/SparsePageHeap.hpp"
 #include "RenderEngine/VulkanInfo.hpp"
-#include <unordered_map>
+#include "ResourceManagement/RenderResources/ImageView.hpp"
+
 #include <vulkan/vulkan.h>
-#include <utility>
-#include <functional>
-
-namespace std {
-    template <>
-    struct hash<std::pair<U32, U32>> {
-        size_t operator()(const std::pair<U32, U32>& p) const {
-            return std::hash<U32>()(p.first) ^ (std::hash<U32>()(p.second) << 1);
-        }
-    };
-}
+
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 class SparseImage {
 public:
     VkImage image = VK_NULL_HANDLE;
-    VkImageView view = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;     // Every mip level
+    Vector<U32, 2> size = {0, 0};
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    U32 mipLevels = 1;
 
     VkExtent3D granularity = {};
-    std::unordered_map<std::pair<U32, U32>, VkDeviceMemory> memoryMap;
+    U32 mipTailFirstLod = 0;                // Mips from here on are bound opaquely and always resident
+
+    // Keyed by packTile(x, y, mip)
+    std::unordered_map<U64, SparsePage> memoryMap;
 
     bool init(
             VulkanInfo* vkInfo,
-            Vector<U32, 3> size,
-            VkFormat format,
-            VkImageUsageFlags usage
+            Vector<U32, 2> imageSize,
+            VkFormat imageFormat,
+            VkImageUsageFlags usage,
+            U32 mipLevels,
+            std::string name
     );
 
-    void bindMemory(U32 tileX, U32 tileY, VkDeviceMemory memory);
-    void bindTile(U32 tileX, U32 tileY);
-    void unbindTile(U32 tileX, U32 tileY);
+    ImageView createMipView(U32 mipLevel, const std::string& name) const;
+
+    Vector<U32, 2> getMipSize(U32 mipLevel) const;
+    Vector<U32, 2> getTileCount(U32 mipLevel) const;
+
+    void bindMemory(U32 tileX, U32 tileY, U32 mipLevel, VkDeviceMemory memory, VkDeviceSize memoryOffset);
+    void bindTile(U32 tileX, U32 tileY, U32 mipLevel);
+    void unbindTile(U32 tileX, U32 tileY, U32 mipLevel);
+    bool isTileResident(U32 tileX, U32 tileY, U32 mipLevel) const;
+    void flushPendingBinds();
 
     void shutdown();
 
+    static U64 packTile(U32 tileX, U32 tileY, U32 mipLevel) {
+        return (static_cast<U64>(mipLevel) << 48) | (static_cast<U64>(tileY) << 24) | tileX;
+    }
+
 private:
+    bool bindMipTail(const VkSparseImageMemoryRequirements& requirements, VkSparseMemoryBindFlags flags);
+
     VulkanInfo* m_vkInfo = nullptr;
+    U32 m_memoryType = 0;
 
-};
+    std::vector<VkSparseImageMemoryBind> m_pendingBinds;
+    std::vector<VkSparseMemoryBind> m_pendingOpaqueBinds;
+
+    // Opaque pages backing the mip tail (and metadata if the format needs it)
+    std::vector<SparsePage> m_tailPages;
 
+};
@@ -0,0 +1,435 @@
+// src/ResourceManagement/RenderResources/VirtualTexture.cpp
+
+#include "VirtualTexture.hpp"
+
+#include "RenderEngine/Config.hpp"
+
+#include <fmt/core.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace {
+    U32 tileX(U64 key) { return static_cast<U32>(key & 0xFFFFFF); }
+    U32 tileY(U64 key) { return static_cast<U32>((key >> 24) & 0xFFFFFF); }
+    U32 tileMip(U64 key) { return static_cast<U32>(key >> 48); }
+
+    // Feedback lags a few frames, tiles requested this recently count as on screen
+    constexpr U64 VISIBLE_FRAMES = Config::framesInFlight * 2;
+
+    // Written before the frame's fence is waited on
+    constexpr Size INFO_SLOTS = Config::framesInFlight + 1;
+
+    // Distance along a wrapped axis
+    U32 wrappedDistance(U32 a, U32 b, U32 size) {
+        U32 distance = a > b ? a - b : b - a;
+        return std::min(distance, size - distance);
+    }
+}
+
+bool VirtualTexture::init(
+        VulkanInfo* vkInfo,
+        U32 size,
+        VkFormat format,
+        VkImageUsageFlags usage,
+        U32 maxResidentTiles,
+        std::string name
+) {
+    m_vkInfo = vkInfo;
+    m_maxResidentTiles = maxResidentTiles;
+    m_frame = 0;
+
+    U32 mipLevels = std::min(static_cast<U32>(std::bit_width(size)), MAX_MIP_LEVELS);
+    if (!m_sparse.init(vkInfo, {size, size}, format, usage, mipLevels, name)) {
+        spdlog::error("Failed to create virtual texture {}", name);
+        return false;
+    }
+
+    m_image.image = m_sparse.image;
+    m_image.view = m_sparse.view;
+    m_image.size = m_sparse.size;
+    m_image.format = format;
+    m_image.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    m_image.layers = 1;
+
+    for (U32 mip = 0; mip < mipLevels; mip++) {
+        m_mipViews.push_back(m_sparse.createMipView(mip, fmt::format("{}'s mip {} view", name, mip)));
+    }
+
+    // Feedback slots for every tile that can be streamed
+    m_feedbackOffsets.assign(MAX_MIP_LEVELS, 0);
+    m_feedbackCount = 0;
+    for (U32 mip = 0; mip < m_sparse.mipTailFirstLod; mip++) {
+        Vector<U32, 2> tiles = m_sparse.getTileCount(mip);
+        m_feedbackOffsets[mip] = m_feedbackCount;
+        m_feedbackCount += tiles.value.x * tiles.value.y;
+    }
+
+    if (!m_feedback.init(
+            vkInfo,
+            std::max(m_feedbackCount, 1u) * sizeof(U32),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            VMA_MEMORY_USAGE_GPU_TO_CPU,
+            VMA_ALLOCATION_CREATE_MAPPED_BIT,
+            fmt::format("{} Feedback", name)
+    )) {
+        return false;
+    }
+    std::memset(m_feedback.info.pMappedData, 0, m_feedback.info.size);
+    m_feedbackAddress = m_feedback.getAddress();
+
+    // Residency, a spare slot past the frames in flight so an update never races a frame still sampling
+    Vector<U32, 2> tiles = m_sparse.getTileCount(0);
+    m_minResidentMip.assign(tiles.value.x * tiles.value.y, m_sparse.mipTailFirstLod);
+    m_infoStride = sizeof(InfoHeader) + m_minResidentMip.size() * sizeof(U32);
+    m_infoStride = (m_infoStride + 255) & ~static_cast<Size>(255);
+
+    if (!m_info.init(
+            vkInfo,
+            m_infoStride * INFO_SLOTS,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU,
+            VMA_ALLOCATION_CREATE_MAPPED_BIT,
+            fmt::format("{} Info", name)
+    )) {
+        return false;
+    }
+    m_infoAddress = m_info.getAddress();
+
+    InfoHeader header = {
+        .size = size,
+        .tileWidth = m_sparse.granularity.width,
+        .tileHeight = m_sparse.granularity.height,
+        .mipTailFirstLod = m_sparse.mipTailFirstLod,
+        .mipLevels = mipLevels,
+        .tilesX = tiles.value.x,
+        .tilesY = tiles.value.y,
+        ._pad0 = 0,
+        .feedbackOffsets = {},
+    };
+    std::copy(m_feedbackOffsets.begin(), m_feedbackOffsets.end(), header.feedbackOffsets);
+
+    U8* infoPtr = static_cast<U8*>(m_info.info.pMappedData);
+    for (Size slot = 0; slot < INFO_SLOTS; slot++) {
+        std::memcpy(infoPtr + slot * m_infoStride, &header, sizeof(header));
+    }
+    m_slotVersions.assign(INFO_SLOTS, 0);
+    m_residencyVersion = 1;
+
+    // The tail is bound for good, so it only needs filling now and when invalidated
+    for (U32 mip = m_sparse.mipTailFirstLod; mip < mipLevels; mip++) {
+        m_pendingFills[SparseImage::packTile(0, 0, mip)] = true;
+    }
+    m_sparse.flushPendingBinds();
+
+    spdlog::info(
+            "Virtual texture {}: {}x{}, {} mips, {}x{} tiles, tail from mip {}",
+            name, size, size, mipLevels,
+            header.tileWidth, header.tileHeight, header.mipTailFirstLod);
+
+    return true;
+}
+
+void VirtualTexture::shutdown() {
+    for (ImageView& view : m_mipViews) {
+        view.shutdown();
+    }
+    m_mipViews.clear();
+
+    m_feedback.shutdown();
+    m_info.shutdown();
+    m_sparse.shutdown();
+
+    m_residentTiles.clear();
+    m_pendingEvictions.clear();
+    m_pendingFills.clear();
+}
+
+void VirtualTexture::update(U32 tileBudget) {
+    m_frame++;
+
+    // Unbind evicted tiles once no frame in flight can still be sampling them. The evicting
+    // frame's table already excludes the tile, so the last reader is the frame before it,
+    // which has retired by the time framesInFlight updates have passed
+    std::erase_if(m_pendingEvictions, [&](const Eviction& eviction) {
+        if (eviction.frame + Config::framesInFlight > m_frame) return false;
+        m_sparse.unbindTile(tileX(eviction.key), tileY(eviction.key), tileMip(eviction.key));
+        return true;
+    });
+
+    // Gather what was sampled, the readback lags a few frames which is fine for streaming
+    vmaInvalidateAllocation(m_vkInfo->allocator, m_feedback.allocation, 0, VK_WHOLE_SIZE);
+    U32* feedback = static_cast<U32*>(m_feedback.info.pMappedData);
+
+    std::vector<U64> requests;
+    for (U32 mip = 0; mip < m_sparse.mipTailFirstLod; mip++) {
+        Vector<U32, 2> tiles = m_sparse.getTileCount(mip);
+        U32* mipFeedback = feedback + m_feedbackOffsets[mip];
+
+        for (U32 y = 0; y < tiles.value.y; y++) {
+            for (U32 x = 0; x < tiles.value.x; x++) {
+                U32& requested = mipFeedback[y * tiles.value.x + x];
+                if (requested == 0) continue;
+
+                requested = 0;
+                request(x, y, mip, requests);
+            }
+        }
+    }
+
+    vmaFlushAllocation(m_vkInfo->allocator, m_feedback.allocation, 0, VK_WHOLE_SIZE);
+
+    // Coarse first, so every finer tile always has a resident parent to fall back to
+    std::sort(requests.begin(), requests.end());
+    requests.erase(std::unique(requests.begin(), requests.end()), requests.end());
+    std::stable_sort(requests.begin(), requests.end(), [](U64 a, U64 b) {
+        return tileMip(a) > tileMip(b);
+    });
+
+    U32 streamed = 0;
+    for (U64 key : requests) {
+        if (m_residentTiles.contains(key)) continue;
+
+        // Still bound and untouched, so it comes back for free
+        auto pending = std::find_if(m_pendingEvictions.begin(), m_pendingEvictions.end(),
+                [key](const Eviction& eviction) { return eviction.key == key; });
+        if (pending != m_pendingEvictions.end()) {
+            m_pendingEvictions.erase(pending);
+            m_residentTiles[key] = m_frame;
+            m_residencyVersion++;
+
+            // Any refill it was waiting on was dropped when it was evicted
+            queueFill(tileX(key), tileY(key), tileMip(key));
+            continue;
+        }
+
+        if (streamed >= tileBudget) continue;
+        if (m_residentTiles.size() >= m_maxResidentTiles && !evictLeastRecentlyUsed()) break;
+
+        U32 x = tileX(key), y = tileY(key), mip = tileMip(key);
+        m_sparse.bindTile(x, y, mip);
+        if (!m_sparse.isTileResident(x, y, mip)) break;
+
+        m_residentTiles[key] = m_frame;
+        m_pendingFills[key] = true;
+        m_residencyVersion++;
+        streamed++;
+    }
+
+    m_sparse.flushPendingBinds();
+
+    updateResidency();
+}
+
+bool VirtualTexture::isTileFilled(U32 tileX, U32 tileY, U32 mipLevel) const {
+    U64 key = SparseImage::packTile(tileX, tileY, mipLevel);
+    return m_residentTiles.contains(key) && !m_pendingFills.contains(key);
+}
+
+void VirtualTexture::request(U32 x, U32 y, U32 mipLevel, std::vector<U64>& requests) {
+    // Walk up to the tail so parents stay resident while their children are in use
+    for (U32 mip = mipLevel; mip < m_sparse.mipTailFirstLod; mip++) {
+        U64 key = SparseImage::packTile(x, y, mip);
+
+        auto it = m_residentTiles.find(key);
+        if (it != m_residentTiles.end()) {
+            it->second = m_frame;
+        } else {
+            requests.push_back(key);
+        }
+
+        x >>= 1;
+        y >>= 1;
+    }
+}
+
+bool VirtualTexture::evictLeastRecentlyUsed() {
+    auto oldest = m_residentTiles.end();
+    for (auto it = m_residentTiles.begin(); it != m_residentTiles.end(); ++it) {
+        if (it->second >= m_frame) continue;    // Wanted this frame
+        if (oldest == m_residentTiles.end() || it->second < oldest->second ||
+                (it->second == oldest->second && tileMip(it->first) < tileMip(oldest->first))) {
+            oldest = it;
+        }
+    }
+
+    if (oldest == m_residentTiles.end()) return false;
+
+    m_pendingEvictions.push_back({oldest->first, m_frame});
+    m_residentTiles.erase(oldest);
+    m_residencyVersion++;
+
+    return true;
+}
+
+void VirtualTexture::invalidate() {
+    for (U32 mip = m_sparse.mipTailFirstLod; mip < m_sparse.mipLevels; mip++) {
+        queueTailFill(mip);
+    }
+
+    for (const auto& [key, lastUsed] : m_residentTiles) {
+        queueFill(tileX(key), tileY(key), tileMip(key));
+    }
+}
+
+void VirtualTexture::invalidateRegion(VkRect2D region) {
+    if (region.extent.width == 0 || region.extent.height == 0) return;
+
+    U32 firstX = static_cast<U32>(region.offset.x);
+    U32 firstY = static_cast<U32>(region.offset.y);
+    U32 lastX = firstX + region.extent.width - 1;
+    U32 lastY = firstY + region.extent.height - 1;
+
+    // Only resident tiles, the rest are filled from scratch when they get bound
+    for (U32 mip = 0; mip < m_sparse.mipTailFirstLod; mip++) {
+        Vector<U32, 2> tiles = m_sparse.getTileCount(mip);
+        U32 tileFirstX = (firstX >> mip) / m_sparse.granularity.width;
+        U32 tileFirstY = (firstY >> mip) / m_sparse.granularity.height;
+        U32 tileLastX = std::min((lastX >> mip) / m_sparse.granularity.width, tiles.value.x - 1);
+        U32 tileLastY = std::min((lastY >> mip) / m_sparse.granularity.height, tiles.value.y - 1);
+
+        for (U32 y = tileFirstY; y <= tileLastY; y++) {
+            for (U32 x = tileFirstX; x <= tileLastX; x++) {
+                if (m_residentTiles.contains(SparseImage::packTile(x, y, mip))) queueFill(x, y, mip);
+            }
+        }
+    }
+
+    for (U32 mip = m_sparse.mipTailFirstLod; mip < m_sparse.mipLevels; mip++) {
+        queueTailFill(mip);
+    }
+}
+
+std::vector<VirtualTile> VirtualTexture::takeFillRequests(U32 refillBudget, VkOffset2D focus) {
+    struct Refill {
+        U64 key;
+        bool visible;
+        U32 mip;
+        U32 distance;   // Mip 0 texels
+    };
+
+    std::vector<VirtualTile> fills;
+    std::vector<Refill> refills;
+
+    U32 size = m_sparse.size.value.x;
+    U32 focusX = static_cast<U32>(focus.x) % size;
+    U32 focusY = static_cast<U32>(focus.y) % size;
+
+    for (auto it = m_pendingFills.begin(); it != m_pendingFills.end();) {
+        auto [key, fresh] = *it;
+        U32 mip = tileMip(key);
+        bool tail = mip >= m_sparse.mipTailFirstLod;
+
+        // Evicted while waiting, it gets a fresh fill if it is ever bound again
+        auto resident = m_residentTiles.find(key);
+        if (!tail && resident == m_residentTiles.end()) {
+            it = m_pendingFills.erase(it);
+            continue;
+        }
+
+        if (fresh) {
+            fills.push_back(getFillTile(key));
+            it = m_pendingFills.erase(it);
+            continue;
+        }
+
+        VirtualTile tile = getFillTile(key);
+        U32 centerX = (static_cast<U32>(tile.region.offset.x) + tile.region.extent.width / 2) << mip;
+        U32 centerY = (static_cast<U32>(tile.region.offset.y) + tile.region.extent.height / 2) << mip;
+
+        refills.push_back({
+            .key = key,
+            .visible = tail || resident->second + VISIBLE_FRAMES >= m_frame,
+            .mip = mip,
+            .distance = std::max(
+                    wrappedDistance(centerX, focusX, size),
+                    wrappedDistance(centerY, focusY, size)),
+        });
+        ++it;
+    }
+
+    U32 count = std::min(refillBudget, static_cast<U32>(refills.size()));
+    std::partial_sort(refills.begin(), refills.begin() + count, refills.end(), [](const Refill& a, const Refill& b) {
+        if (a.visible != b.visible) return a.visible;
+        if (a.mip != b.mip) return a.mip > b.mip;
+        return a.distance < b.distance;
+    });
+
+    for (U32 i = 0; i < count; i++) {
+        fills.push_back(getFillTile(refills[i].key));
+        m_pendingFills.erase(refills[i].key);
+    }
+
+    return fills;
+}
+
+VkDeviceAddress VirtualTexture::getInfoAddress() const {
+    return m_infoAddress + (m_frame % INFO_SLOTS) * m_infoStride;
+}
+
+void VirtualTexture::queueFill(U32 x, U32 y, U32 mipLevel) {
+    // A pending fresh fill already covers it
+    m_pendingFills.try_emplace(SparseImage::packTile(x, y, mipLevel), false);
+}
+
+void VirtualTexture::queueTailFill(U32 mipLevel) {
+    m_pendingFills.try_emplace(SparseImage::packTile(0, 0, mipLevel), false);
+}
+
+VirtualTile VirtualTexture::getFillTile(U64 key) const {
+    U32 x = tileX(key), y = tileY(key), mipLevel = tileMip(key);
+    Vector<U32, 2> mipSize = m_sparse.getMipSize(mipLevel);
+
+    // Tail levels are small, so they are always filled whole
+    if (mipLevel >= m_sparse.mipTailFirstLod) {
+        return {
+            .x = 0,
+            .y = 0,
+            .mipLevel = mipLevel,
+            .region = {.offset = {0, 0}, .extent = {mipSize.value.x, mipSize.value.y}},
+        };
+    }
+
+    U32 offsetX = x * m_sparse.granularity.width;
+    U32 offsetY = y * m_sparse.granularity.height;
+
+    return {
+        .x = x,
+        .y = y,
+        .mipLevel = mipLevel,
+        .region = {
+            .offset = {static_cast<I32>(offsetX), static_cast<I32>(offsetY)},
+            .extent = {
+                std::min(m_sparse.granularity.width, mipSize.value.x - offsetX),
+                std::min(m_sparse.granularity.height, mipSize.value.y - offsetY),
+            },
+        },
+    };
+}
+
+void VirtualTexture::updateResidency() {
+    Size slot = m_frame % INFO_SLOTS;
+    if (m_slotVersions[slot] == m_residencyVersion) return;
+
+    Vector<U32, 2> tiles = m_sparse.getTileCount(0);
+    U32 tailFirstLod = m_sparse.mipTailFirstLod;
+
+    // Finest mip with an unbroken resident chain up to the tail
+    for (U32 y = 0; y < tiles.value.y; y++) {
+        for (U32 x = 0; x < tiles.value.x; x++) {
+            U32 minMip = tailFirstLod;
+            while (minMip > 0) {
+                U32 mip = minMip - 1;
+                if (!m_residentTiles.contains(SparseImage::packTile(x >> mip, y >> mip, mip))) break;
+                minMip = mip;
+            }
+            m_minResidentMip[y * tiles.value.x + x] = minMip;
+        }
+    }
+
+    U8* slotPtr = static_cast<U8*>(m_info.info.pMappedData) + slot * m_infoStride;
+    std::memcpy(slotPtr + sizeof(InfoHeader), m_minResidentMip.data(), m_minResidentMip.size() * sizeof(U32));
+    m_slotVersions[slot] = m_residencyVersion;
+}
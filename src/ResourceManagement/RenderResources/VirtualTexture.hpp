@@ -0,0 +1,132 @@
+// src/ResourceManagement/RenderResources/VirtualTexture.hpp
+
+#pragma once
+
+#include "Buffer.hpp"
+#include "Core/Types.hpp"
+#include "Image.hpp"
+#include "ImageView.hpp"
+#include "RenderEngine/VulkanInfo.hpp"
+#include "SparseImage.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A tile (or a whole mip tail level) that was just made resident and needs its contents written
+struct VirtualTile {
+    U32 x;
+    U32 y;
+    U32 mipLevel;
+    VkRect2D region;    // Texels within the mip level
+};
+
+// Sparse, mipped texture whose residency follows what shaders actually sample.
+//
+// Shaders mark the tiles they want in a feedback buffer, update() reads it back,
+// binds missing tiles coarse to fine within a budget and evicts the least recently
+// used ones. Shaders clamp their lod to the per-tile minimum resident mip from the
+// info buffer, so a coarser mip is sampled until a tile has been filled.
+//
+// Newly bound tiles are always filled the frame they are bound. Refills of tiles that
+// already hold data are spread over frames, the old contents stay visible until then.
+class VirtualTexture {
+public:
+    static constexpr U32 MAX_MIP_LEVELS = 16;
+
+    // Mirrors VirtualTextureInfo in virtualTexture.glsl, followed by a U32 per mip 0 tile
+    struct InfoHeader {
+        U32 size;
+        U32 tileWidth;
+        U32 tileHeight;
+        U32 mipTailFirstLod;
+        U32 mipLevels;
+        U32 tilesX;
+        U32 tilesY;
+        U32 _pad0;
+        U32 feedbackOffsets[MAX_MIP_LEVELS];
+    };
+
+    bool init(
+            VulkanInfo* vkInfo,
+            U32 size,
+            VkFormat format,
+            VkImageUsageFlags usage,
+            U32 maxResidentTiles,
+            std::string name
+    );
+    void shutdown();
+
+    // Once per frame, before the fill requests are recorded
+    void update(U32 tileBudget);
+
+    // Refill every resident tile, e.g. when the generator parameters change
+    void invalidate();
+    // Refill whatever covers a mip 0 texel region at every level
+    void invalidateRegion(VkRect2D region);
+
+    // Every newly bound tile, then up to refillBudget refills: the mip tail, recently
+    // sampled tiles, coarse mips and tiles nearest focus (mip 0 texels, wrapped) first
+    std::vector<VirtualTile> takeFillRequests(U32 refillBudget, VkOffset2D focus);
+
+    // Non-owning handle for layout transitions, descriptor writes and texture targets
+    Image* getImage() { return &m_image; }
+    ImageView getMipView(U32 mipLevel) const { return m_mipViews[mipLevel]; }
+
+    VkDeviceAddress getInfoAddress() const;
+    VkDeviceAddress getFeedbackAddress() const { return m_feedbackAddress; }
+
+    U32 getMipLevels() const { return m_sparse.mipLevels; }
+    U32 getMipTailFirstLod() const { return m_sparse.mipTailFirstLod; }
+    VkExtent2D getTileExtent() const { return {m_sparse.granularity.width, m_sparse.granularity.height}; }
+    Size getResidentTiles() const { return m_residentTiles.size(); }
+    Size getPendingFills() const { return m_pendingFills.size(); }
+
+    // Resident with current contents, tiles still waiting on a fill or refill are not
+    bool isTileFilled(U32 tileX, U32 tileY, U32 mipLevel) const;
+
+private:
+    struct Eviction {
+        U64 key;
+        U64 frame;
+    };
+
+    void request(U32 tileX, U32 tileY, U32 mipLevel, std::vector<U64>& requests);
+    bool evictLeastRecentlyUsed();
+    void queueFill(U32 tileX, U32 tileY, U32 mipLevel);
+    void queueTailFill(U32 mipLevel);
+    VirtualTile getFillTile(U64 key) const;
+    void updateResidency();
+
+    VulkanInfo* m_vkInfo = nullptr;
+
+    SparseImage m_sparse;
+    Image m_image;
+    std::vector<ImageView> m_mipViews;
+
+    // Readback of requested tiles, one U32 per tile for every non tail mip
+    Buffer m_feedback;
+    VkDeviceAddress m_feedbackAddress = 0;
+    std::vector<U32> m_feedbackOffsets;
+    U32 m_feedbackCount = 0;
+
+    // One header + min resident mip table per frame in flight, plus one being written
+    Buffer m_info;
+    VkDeviceAddress m_infoAddress = 0;
+    Size m_infoStride = 0;
+    std::vector<U32> m_minResidentMip;
+    std::vector<U64> m_slotVersions;
+    U64 m_residencyVersion = 1;
+
+    // Resident tile -> last frame it was requested
+    std::unordered_map<U64, U64> m_residentTiles;
+    std::vector<Eviction> m_pendingEvictions;
+    U32 m_maxResidentTiles = 0;
+
+    // Tile -> freshly bound, so its contents are undefined rather than stale
+    std::unordered_map<U64, bool> m_pendingFills;
+    U64 m_frame = 0;
+
+};
@@ -19,11 +19,23 @@ bool ResourceManager::initialize(VulkanInfo* vkInfo, std::shared_ptr<CommandSubm
     if (!m_materialManager.initialize(vkInfo))
         return false;
 
+    if (!m_geometryPool.init(vkInfo, GeometryPool::DEFAULT_VERTEX_CAPACITY, GeometryPool::DEFAULT_INDEX_CAPACITY))
+        return false;
+
     return true;
 }
 
+void ResourceManager::update() {
+    m_materialManager.update();
+
+    // Bounded so compaction never stalls a frame
+    constexpr Size GEOMETRY_MOVE_BUDGET = 4 * 1024 * 1024;
+    m_geometryPool.update(GEOMETRY_MOVE_BUDGET);
+}
+
 void ResourceManager::shutdown() {
     m_materialManager.shutdown();
+    m_geometryPool.shutdown();
 
     // Clear all images
     for (auto& pair : m_images) {
@@ -275,6 +287,26 @@ void ResourceManager::copyToBuffer(const Buffer& src, const Buffer& dst, Size si
     });
 }
 
+std::expected<ObjectBuffer, U32> ResourceManager::createObjectBuffer(
+        Size stride, U32 capacity, std::string name
+) {
+    ObjectBuffer objects;
+    if (!objects.init(m_vkInfo, stride, capacity, name)) {
+        return std::unexpected(2);
+    }
+    return objects;
+}
+
+std::expected<VirtualTexture, U32> ResourceManager::createVirtualTexture(
+        U32 size, VkFormat format, VkImageUsageFlags usage, U32 maxResidentTiles, std::string name
+) {
+    VirtualTexture texture;
+    if (!texture.init(m_vkInfo, size, format, usage, maxResidentTiles, name)) {
+        return std::unexpected(2);
+    }
+    return texture;
+}
+
 std::expected<DescriptorPool, U32> ResourceManager::createDescriptorPool(
         U32 setCount, std::span<DescriptorPool::PoolSizeRatio> poolRatios
 ) {
@@ -7,9 +7,12 @@
 
 #include "RenderResources/Buffer.hpp"
 #include "RenderResources/Image.hpp"
+#include "ResourceManagement/GeometryPool.hpp"
 #include "ResourceManagement/MaterialManager.hpp"
 #include "ResourceManagement/RenderResources/DescriptorPool.hpp"
+#include "ResourceManagement/RenderResources/ObjectBuffer.hpp"
 #include "ResourceManagement/RenderResources/Sampler.hpp"
+#include "ResourceManagement/RenderResources/VirtualTexture.hpp"
 
 #include <memory>
 #include <unordered_map>
@@ -34,6 +37,9 @@ public:
     bool initialize(VulkanInfo* vkInfo, std::shared_ptr<CommandSubmitter> submitter);
     void shutdown();
 
+    // Once per frame before it is submitted
+    void update();
+
     VulkanInfo* getVkInfo();
 
     // Images
@@ -65,11 +71,18 @@ public:
 
     void copyToBuffer(const Buffer& src, const Buffer& dst, Size size);
 
+    std::expected<ObjectBuffer, U32> createObjectBuffer(Size stride, U32 capacity, std::string name);
+
+    std::expected<VirtualTexture, U32> createVirtualTexture(
+            U32 size, VkFormat format, VkImageUsageFlags usage, U32 maxResidentTiles, std::string name
+    );
+
     std::expected<DescriptorPool, U32> createDescriptorPool(
             U32 setCount, std::span<DescriptorPool::PoolSizeRatio> poolRatios
     );
 
     MaterialManager* getMaterialManager() { return &m_materialManager; };
+    GeometryPool* getGeometryPool() { return &m_geometryPool; };
     SamplerBuilder getSamplerBuilder() { return SamplerBuilder(m_vkInfo); };
 
 private:
@@ -82,6 +95,7 @@ private:
     VulkanInfo* m_vkInfo;
     std::shared_ptr<CommandSubmitter> m_submitter;
     MaterialManager m_materialManager;
+    GeometryPool m_geometryPool;
 
     fs::path resourceBasePath = "assets";
 
@@ -0,0 +1,137 @@
+// src/ResourceManagement/TileCache.cpp
+
+#include "TileCache.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <string_view>
+
+namespace {
+    constexpr char MAGIC[8] = {'W', 'S', 'T', 'I', 'L', 'E', 'S', '\0'};
+    constexpr U32 VERSION = 1;
+    constexpr Size DATA_ALIGNMENT = 4096;
+
+    Size alignUp(Size value, Size alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+bool TileCache::init(const std::filesystem::path& path, Size tileBytes, U32 capacity) {
+    m_path = path;
+    m_tileBytes = tileBytes;
+    m_capacity = capacity;
+    m_dataOffset = alignUp(sizeof(Header) + sizeof(IndexEntry) * capacity, DATA_ALIGNMENT);
+    m_mappingSize = m_dataOffset + tileBytes * capacity;
+
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    m_file = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_file < 0) {
+        spdlog::error("Failed to open tile cache {}: {}", path.string(), std::strerror(errno));
+        return false;
+    }
+
+    off_t fileSize = lseek(m_file, 0, SEEK_END);
+
+    // Sparse on disk, slots only take space once written
+    if (static_cast<Size>(fileSize) != m_mappingSize && ftruncate(m_file, static_cast<off_t>(m_mappingSize)) != 0) {
+        spdlog::error("Failed to size tile cache {}: {}", path.string(), std::strerror(errno));
+        shutdown();
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, m_mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+    if (mapping == MAP_FAILED) {
+        spdlog::error("Failed to map tile cache {}: {}", path.string(), std::strerror(errno));
+        shutdown();
+        return false;
+    }
+    m_mapping = static_cast<U8*>(mapping);
+
+    // Anything written with another layout is dropped
+    Header* header = reinterpret_cast<Header*>(m_mapping);
+    bool valid = std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 &&
+            header->version == VERSION &&
+            header->tileBytes == tileBytes &&
+            header->capacity == capacity;
+
+    if (!valid) {
+        if (fileSize > 0) spdlog::info("Tile cache {} is stale, starting over", path.string());
+
+        std::memset(m_mapping, 0, m_dataOffset);
+        std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+        header->version = VERSION;
+        header->tileBytes = static_cast<U32>(tileBytes);
+        header->capacity = capacity;
+        header->nextSlot = 0;
+    }
+
+    IndexEntry* entries = index();
+    for (U32 slot = 0; slot < capacity; slot++) {
+        if (entries[slot].used) m_slots[entries[slot].key] = slot;
+    }
+
+    spdlog::info("Tile cache {}: {} / {} tiles", path.string(), m_slots.size(), capacity);
+
+    return true;
+}
+
+void TileCache::shutdown() {
+    if (m_mapping != nullptr) {
+        msync(m_mapping, m_mappingSize, MS_ASYNC);
+        munmap(m_mapping, m_mappingSize);
+        m_mapping = nullptr;
+    }
+
+    if (m_file >= 0) {
+        close(m_file);
+        m_file = -1;
+    }
+
+    m_slots.clear();
+}
+
+const U8* TileCache::find(const TileKey& key) const {
+    auto it = m_slots.find(key);
+    if (it == m_slots.end()) return nullptr;
+    return slotData(it->second);
+}
+
+void TileCache::insert(const TileKey& key, const void* data) {
+    if (m_mapping == nullptr || m_slots.contains(key)) return;
+
+    Header* header = reinterpret_cast<Header*>(m_mapping);
+    U32 slot = header->nextSlot;
+    header->nextSlot = (slot + 1) % m_capacity;
+
+    // Unlisted while the data is rewritten, so a crash never pairs a key with torn texels
+    IndexEntry& entry = index()[slot];
+    if (entry.used) m_slots.erase(entry.key);
+    entry.used = 0;
+
+    std::memcpy(slotData(slot), data, m_tileBytes);
+
+    entry.key = key;
+    entry.used = 1;
+    m_slots[key] = slot;
+}
+
+Size TileCache::KeyHash::operator()(const TileKey& key) const {
+    return std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(&key), sizeof(TileKey)));
+}
+
+TileCache::IndexEntry* TileCache::index() const {
+    return reinterpret_cast<IndexEntry*>(m_mapping + sizeof(Header));
+}
+
+U8* TileCache::slotData(U32 slot) const {
+    return m_mapping + m_dataOffset + static_cast<Size>(slot) * m_tileBytes;
+}
@@ -0,0 +1,75 @@
+// src/ResourceManagement/TileCache.hpp
+
+#pragma once
+
+#include "Core/Types.hpp"
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+
+// Everything a generated tile's texels depend on
+struct TileKey {
+    F32 seed;
+    F32 scale;
+    I32 octaves;
+    U32 resolution;     // Texels per chunk at mip 0
+    I32 x;              // World texels at mip 0
+    I32 y;
+    U32 mipLevel;
+    U32 format;         // VkFormat, tiles of another texel layout never match
+
+    bool operator==(const TileKey& other) const = default;
+};
+
+// Fixed size tiles in one memory mapped archive file, kept across runs.
+//
+// The file is a header, an index of every slot's key and the slots themselves.
+// Lookups return pointers straight into the mapping, so uploads copy from the
+// page cache. Once full, the oldest slot is overwritten.
+class TileCache {
+public:
+    bool init(const std::filesystem::path& path, Size tileBytes, U32 capacity);
+    void shutdown();
+
+    // Valid until the slot is overwritten by a later insert
+    const U8* find(const TileKey& key) const;
+    void insert(const TileKey& key, const void* data);
+
+    Size getTileBytes() const { return m_tileBytes; }
+    Size getCachedTiles() const { return m_slots.size(); }
+
+private:
+    struct Header {
+        char magic[8];
+        U32 version;
+        U32 tileBytes;
+        U32 capacity;
+        U32 nextSlot;
+    };
+
+    struct IndexEntry {
+        TileKey key;
+        U32 used;
+        U32 _pad0;
+    };
+
+    struct KeyHash {
+        Size operator()(const TileKey& key) const;
+    };
+
+    IndexEntry* index() const;
+    U8* slotData(U32 slot) const;
+
+    std::filesystem::path m_path;
+    int m_file = -1;
+    U8* m_mapping = nullptr;
+    Size m_mappingSize = 0;
+    Size m_dataOffset = 0;
+
+    Size m_tileBytes = 0;
+    U32 m_capacity = 0;
+
+    std::unordered_map<TileKey, U32, KeyHash> m_slots;
+
+};
@@ -0,0 +1,689 @@
+// tests/TerrainGeneratorParityTest.cpp
+
+#include "AssetManagement/Terrain/TerrainNoise.hpp"
+#include "RenderEngine/VkUtils.hpp"
+#include "RenderEngine/VulkanInfo.hpp"
+#include "ResourceManagement/MaterialManagerUtils/ShaderLoading.hpp"
+
+#include <spdlog/spdlog.h>
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+// Generates heightmap tiles with the terrainGenerator compute shader on a headless device and
+// checks every texel against TerrainNoise::heightGrid. Skipped when there is no usable device.
+namespace {
+    constexpr int SKIPPED = 77;                     // SKIP_RETURN_CODE in tests/CMakeLists.txt
+
+    constexpr const char* SHADER_PATH = "assets/materials/terrainGenerator/shader.comp";
+    constexpr VkFormat HEIGHT_FORMAT = VK_FORMAT_R16_UNORM;
+    constexpr U32 MIP_BINDINGS = 16;                // heightmapMips[16] in shader.comp
+    constexpr U32 GROUP_SIZE = 8;
+    constexpr F32 HEIGHT_RANGE = 2.0f;
+
+    // One tile of two by two chunks, at TerrainManager::RESOLUTION texels per chunk
+    constexpr U32 RESOLUTION = 128;
+    constexpr U32 TILE_SIZE = 256;
+    constexpr Size TILE_BYTES = Size(TILE_SIZE) * TILE_SIZE * sizeof(U16);
+
+    // Mirror TerrainManager::PerlinGeneratorPushConstants and GeneratorTile
+    struct PushConstants {
+        F32 scale;
+        F32 seed;
+        F32 originX, originY;
+        F32 worldChunks;
+        U32 octaves;
+        VkDeviceAddress tiles;
+    };
+
+    struct GeneratorTile {
+        U32 mipLevel;
+        U32 _pad0;
+        I32 offsetX, offsetY;
+        U32 width, height;
+        U32 mipWidth, mipHeight;
+    };
+
+    struct Case {
+        TerrainNoise::Settings settings;
+        I32 fixedOctaves;                           // FIXED_OCTAVES, 0 loops over the push constant
+        F32 originX, originY;                       // Chunks, a multiple of the tile's chunks so the window doesn't wrap
+    };
+
+    const std::array<Case, 5> CASES = {{
+        {.settings = {.scale = 1.0f, .seed = 0.0f, .octaves = 4}, .fixedOctaves = 0, .originX = -4.0f, .originY = 6.0f},
+        {.settings = {.scale = 1.0f, .seed = 0.0f, .octaves = 4}, .fixedOctaves = 4, .originX = -4.0f, .originY = 6.0f},
+        {.settings = {.scale = 0.37f, .seed = 123.4f, .octaves = 1}, .fixedOctaves = 0, .originX = 1000.0f, .originY = -2000.0f},
+        {.settings = {.scale = 20.0f, .seed = 999.9f, .octaves = 10}, .fixedOctaves = 0, .originX = -62.0f, .originY = -8.0f},
+        {.settings = {.scale = 3.0f, .seed = 42.0f, .octaves = 7}, .fixedOctaves = 7, .originX = 128.0f, .originY = 256.0f},
+    }};
+
+    struct Context {
+        VulkanInfo vkInfo{};
+        U32 queueFamily = 0;
+        VkQueue queue = VK_NULL_HANDLE;
+
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkDeviceMemory imageMemory = VK_NULL_HANDLE;
+
+        VkBuffer tileBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory tileMemory = VK_NULL_HANDLE;
+        VkDeviceAddress tileAddress = 0;
+
+        VkBuffer readbackBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory readbackMemory = VK_NULL_HANDLE;
+        void* readback = nullptr;
+
+        VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+        VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+        VkShaderModule shader = VK_NULL_HANDLE;
+
+        VkCommandPool commandPool = VK_NULL_HANDLE;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+
+        ~Context() {
+            VkDevice device = vkInfo.device;
+            if (device != VK_NULL_HANDLE) {
+                vkDeviceWaitIdle(device);
+                vkDestroyFence(device, fence, nullptr);
+                vkDestroyCommandPool(device, commandPool, nullptr);
+                vkDestroyShaderModule(device, shader, nullptr);
+                vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+                vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+                vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+                vkDestroyBuffer(device, readbackBuffer, nullptr);
+                vkFreeMemory(device, readbackMemory, nullptr);
+                vkDestroyBuffer(device, tileBuffer, nullptr);
+                vkFreeMemory(device, tileMemory, nullptr);
+                vkDestroyImageView(device, view, nullptr);
+                vkDestroyImage(device, image, nullptr);
+                vkFreeMemory(device, imageMemory, nullptr);
+                vkDestroyDevice(device, nullptr);
+            }
+            if (vkInfo.instance != VK_NULL_HANDLE) {
+                vkDestroyInstance(vkInfo.instance, nullptr);
+            }
+        }
+    };
+
+    // Everything shader.comp needs: buffer device addresses, r16 storage images and a mip array indexed per tile
+    bool supportsGenerator(VkPhysicalDevice physicalDevice) {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        if (properties.apiVersion < VK_API_VERSION_1_3) return false;
+
+        VkPhysicalDeviceVulkan13Features features13 = {.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES};
+        VkPhysicalDeviceVulkan12Features features12 = {.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES, .pNext = &features13};
+        VkPhysicalDeviceFeatures2 features = {.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, .pNext = &features12};
+        vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(physicalDevice, HEIGHT_FORMAT, &formatProperties);
+
+        return features12.bufferDeviceAddress && features13.synchronization2 &&
+               features.features.shaderStorageImageExtendedFormats &&
+               features.features.shaderStorageImageArrayDynamicIndexing &&
+               (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+    }
+
+    // No window and no surface, any device with a compute queue will do. False means skip.
+    bool createDevice(Context& context) {
+        VkApplicationInfo appInfo = {
+            .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+            .pNext = nullptr,
+            .pApplicationName = "Terrain Generator Parity Test",
+            .applicationVersion = VK_MAKE_VERSION(1, 0, 0),
+            .pEngineName = "Custom Engine",
+            .engineVersion = VK_MAKE_VERSION(1, 0, 0),
+            .apiVersion = VK_API_VERSION_1_3,
+        };
+
+        VkInstanceCreateInfo instanceInfo = {
+            .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .pApplicationInfo = &appInfo,
+            .enabledLayerCount = 0,
+            .ppEnabledLayerNames = nullptr,
+            .enabledExtensionCount = 0,
+            .ppEnabledExtensionNames = nullptr,
+        };
+
+        if (vkCreateInstance(&instanceInfo, nullptr, &context.vkInfo.instance) != VK_SUCCESS) {
+            context.vkInfo.instance = VK_NULL_HANDLE;
+            spdlog::warn("No Vulkan instance");
+            return false;
+        }
+
+        U32 deviceCount = 0;
+        vkEnumeratePhysicalDevices(context.vkInfo.instance, &deviceCount, nullptr);
+        std::vector<VkPhysicalDevice> devices(deviceCount);
+        vkEnumeratePhysicalDevices(context.vkInfo.instance, &deviceCount, devices.data());
+
+        for (VkPhysicalDevice device : devices) {
+            if (!supportsGenerator(device)) continue;
+
+            U32 familyCount = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, nullptr);
+            std::vector<VkQueueFamilyProperties> families(familyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, families.data());
+
+            for (U32 i = 0; i < familyCount; i++) {
+                if (families[i].queueFlags & VK_QUEUE_COMPUTE_BIT) {
+                    context.vkInfo.physicalDevice = device;
+                    context.queueFamily = i;
+                    break;
+                }
+            }
+            if (context.vkInfo.physicalDevice != VK_NULL_HANDLE) break;
+        }
+
+        if (context.vkInfo.physicalDevice == VK_NULL_HANDLE) {
+            spdlog::warn("No device can run the terrain generator");
+            return false;
+        }
+
+        F32 priority = 1.0f;
+        VkDeviceQueueCreateInfo queueInfo = {
+            .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .queueFamilyIndex = context.queueFamily,
+            .queueCount = 1,
+            .pQueuePriorities = &priority,
+        };
+
+        VkPhysicalDeviceVulkan13Features features13 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+            .synchronization2 = VK_TRUE,
+        };
+        VkPhysicalDeviceVulkan12Features features12 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+            .pNext = &features13,
+            .bufferDeviceAddress = VK_TRUE,
+        };
+        VkPhysicalDeviceFeatures2 features = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &features12,
+            .features = {
+                .shaderStorageImageExtendedFormats = VK_TRUE,
+                .shaderStorageImageArrayDynamicIndexing = VK_TRUE,
+            },
+        };
+
+        VkDeviceCreateInfo deviceInfo = {
+            .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+            .pNext = &features,
+            .flags = 0,
+            .queueCreateInfoCount = 1,
+            .pQueueCreateInfos = &queueInfo,
+            .enabledLayerCount = 0,
+            .ppEnabledLayerNames = nullptr,
+            .enabledExtensionCount = 0,
+            .ppEnabledExtensionNames = nullptr,
+            .pEnabledFeatures = nullptr,
+        };
+
+        VkResult result = vkCreateDevice(context.vkInfo.physicalDevice, &deviceInfo, nullptr, &context.vkInfo.device);
+        if (result != VK_SUCCESS) {
+            context.vkInfo.device = VK_NULL_HANDLE;
+            VkUtils::checkVkResult(result, "Failed to create the test device");
+            return false;
+        }
+
+        vkGetDeviceQueue(context.vkInfo.device, context.queueFamily, 0, &context.queue);
+        return true;
+    }
+
+    bool allocate(Context& context, VkMemoryRequirements requirements, VkMemoryPropertyFlags properties,
+                  bool deviceAddress, VkDeviceMemory* memory) {
+        VkMemoryAllocateFlagsInfo flagsInfo = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+            .pNext = nullptr,
+            .flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
+            .deviceMask = 0,
+        };
+
+        U32 memoryType = VkUtils::findMemoryType(&context.vkInfo, requirements.memoryTypeBits, properties);
+        if (memoryType == U32(-1)) return false;
+
+        VkMemoryAllocateInfo allocateInfo = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .pNext = deviceAddress ? &flagsInfo : nullptr,
+            .allocationSize = requirements.size,
+            .memoryTypeIndex = memoryType,
+        };
+        return VkUtils::checkVkResult(vkAllocateMemory(context.vkInfo.device, &allocateInfo, nullptr, memory),
+                                      "Failed to allocate test memory");
+    }
+
+    bool createHostBuffer(Context& context, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer* buffer,
+                          VkDeviceMemory* memory, void** mapped) {
+        VkDevice device = context.vkInfo.device;
+        VkBufferCreateInfo bufferInfo = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .size = size,
+            .usage = usage,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = 0,
+            .pQueueFamilyIndices = nullptr,
+        };
+        if (!VkUtils::checkVkResult(vkCreateBuffer(device, &bufferInfo, nullptr, buffer), "Failed to create test buffer")) {
+            return false;
+        }
+
+        VkMemoryRequirements requirements;
+        vkGetBufferMemoryRequirements(device, *buffer, &requirements);
+        bool deviceAddress = usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+        if (!allocate(context, requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                      deviceAddress, memory)) {
+            return false;
+        }
+
+        return VkUtils::checkVkResult(vkBindBufferMemory(device, *buffer, *memory, 0), "Failed to bind test buffer") &&
+               VkUtils::checkVkResult(vkMapMemory(device, *memory, 0, VK_WHOLE_SIZE, 0, mapped), "Failed to map test buffer");
+    }
+
+    // One r16 tile as mip 0, the tile list, a readback buffer and the generator's layout
+    bool createResources(Context& context) {
+        VkDevice device = context.vkInfo.device;
+
+        VkImageCreateInfo imageInfo = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .imageType = VK_IMAGE_TYPE_2D,
+            .format = HEIGHT_FORMAT,
+            .extent = {TILE_SIZE, TILE_SIZE, 1},
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = 0,
+            .pQueueFamilyIndices = nullptr,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        };
+        if (!VkUtils::checkVkResult(vkCreateImage(device, &imageInfo, nullptr, &context.image), "Failed to create test image")) {
+            return false;
+        }
+
+        VkMemoryRequirements imageRequirements;
+        vkGetImageMemoryRequirements(device, context.image, &imageRequirements);
+        if (!allocate(context, imageRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false, &context.imageMemory) ||
+            !VkUtils::checkVkResult(vkBindImageMemory(device, context.image, context.imageMemory, 0), "Failed to bind test image")) {
+            return false;
+        }
+
+        VkImageViewCreateInfo viewInfo = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .image = context.image,
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = HEIGHT_FORMAT,
+            .components = {},
+            .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+        };
+        if (!VkUtils::checkVkResult(vkCreateImageView(device, &viewInfo, nullptr, &context.view), "Failed to create test view")) {
+            return false;
+        }
+
+        void* tiles = nullptr;
+        if (!createHostBuffer(context, sizeof(GeneratorTile),
+                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                              &context.tileBuffer, &context.tileMemory, &tiles) ||
+            !createHostBuffer(context, TILE_BYTES, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                              &context.readbackBuffer, &context.readbackMemory, &context.readback)) {
+            return false;
+        }
+
+        GeneratorTile tile = {
+            .mipLevel = 0,
+            ._pad0 = 0,
+            .offsetX = 0,
+            .offsetY = 0,
+            .width = TILE_SIZE,
+            .height = TILE_SIZE,
+            .mipWidth = TILE_SIZE,
+            .mipHeight = TILE_SIZE,
+        };
+        std::memcpy(tiles, &tile, sizeof(tile));
+
+        VkBufferDeviceAddressInfo addressInfo = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+            .pNext = nullptr,
+            .buffer = context.tileBuffer,
+        };
+        context.tileAddress = vkGetBufferDeviceAddress(device, &addressInfo);
+
+        // Every element of heightmapMips gets the one level, only mip 0 is written
+        VkDescriptorSetLayoutBinding binding = {
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .descriptorCount = MIP_BINDINGS,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .pImmutableSamplers = nullptr,
+        };
+        VkDescriptorSetLayoutCreateInfo setLayoutInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .bindingCount = 1,
+            .pBindings = &binding,
+        };
+        if (!VkUtils::checkVkResult(vkCreateDescriptorSetLayout(device, &setLayoutInfo, nullptr, &context.setLayout),
+                                    "Failed to create test set layout")) {
+            return false;
+        }
+
+        VkDescriptorPoolSize poolSize = {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, MIP_BINDINGS};
+        VkDescriptorPoolCreateInfo poolInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .maxSets = 1,
+            .poolSizeCount = 1,
+            .pPoolSizes = &poolSize,
+        };
+        if (!VkUtils::checkVkResult(vkCreateDescriptorPool(device, &poolInfo, nullptr, &context.descriptorPool),
+                                    "Failed to create test descriptor pool")) {
+            return false;
+        }
+
+        VkDescriptorSetAllocateInfo setInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .descriptorPool = context.descriptorPool,
+            .descriptorSetCount = 1,
+            .pSetLayouts = &context.setLayout,
+        };
+        if (!VkUtils::checkVkResult(vkAllocateDescriptorSets(device, &setInfo, &context.descriptorSet),
+                                    "Failed to allocate test descriptor set")) {
+            return false;
+        }
+
+        std::array<VkDescriptorImageInfo, MIP_BINDINGS> mips;
+        mips.fill({.sampler = VK_NULL_HANDLE, .imageView = context.view, .imageLayout = VK_IMAGE_LAYOUT_GENERAL});
+        VkWriteDescriptorSet write = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = nullptr,
+            .dstSet = context.descriptorSet,
+            .dstBinding = 0,
+            .dstArrayElement = 0,
+            .descriptorCount = MIP_BINDINGS,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .pImageInfo = mips.data(),
+            .pBufferInfo = nullptr,
+            .pTexelBufferView = nullptr,
+        };
+        vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+
+        VkPushConstantRange pushRange = {VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants)};
+        VkPipelineLayoutCreateInfo layoutInfo = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .setLayoutCount = 1,
+            .pSetLayouts = &context.setLayout,
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges = &pushRange,
+        };
+        if (!VkUtils::checkVkResult(vkCreatePipelineLayout(device, &layoutInfo, nullptr, &context.pipelineLayout),
+                                    "Failed to create test pipeline layout")) {
+            return false;
+        }
+
+        std::vector<U32> spirv = CompileShaderToSPIRV(SHADER_PATH, VK_SHADER_STAGE_COMPUTE_BIT);
+        if (spirv.empty()) return false;
+        context.shader = CreateShaderModule(device, spirv);
+        if (context.shader == VK_NULL_HANDLE) return false;
+
+        VkCommandPoolCreateInfo commandPoolInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+            .queueFamilyIndex = context.queueFamily,
+        };
+        VkCommandBufferAllocateInfo commandBufferInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .commandPool = VK_NULL_HANDLE,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+        VkFenceCreateInfo fenceInfo = {.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, .pNext = nullptr, .flags = 0};
+
+        if (!VkUtils::checkVkResult(vkCreateCommandPool(device, &commandPoolInfo, nullptr, &context.commandPool),
+                                    "Failed to create test command pool")) {
+            return false;
+        }
+        commandBufferInfo.commandPool = context.commandPool;
+        return VkUtils::checkVkResult(vkAllocateCommandBuffers(device, &commandBufferInfo, &context.commandBuffer),
+                                      "Failed to allocate test command buffer") &&
+               VkUtils::checkVkResult(vkCreateFence(device, &fenceInfo, nullptr, &context.fence), "Failed to create test fence");
+    }
+
+    VkPipeline createPipeline(Context& context, I32 fixedOctaves) {
+        VkSpecializationMapEntry entry = {.constantID = 0, .offset = 0, .size = sizeof(I32)};
+        VkSpecializationInfo specialization = {
+            .mapEntryCount = 1,
+            .pMapEntries = &entry,
+            .dataSize = sizeof(I32),
+            .pData = &fixedOctaves,
+        };
+
+        VkComputePipelineCreateInfo pipelineInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .stage = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = context.shader,
+                .pName = "main",
+                .pSpecializationInfo = &specialization,
+            },
+            .layout = context.pipelineLayout,
+            .basePipelineHandle = VK_NULL_HANDLE,
+            .basePipelineIndex = -1,
+        };
+
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkResult result = vkCreateComputePipelines(context.vkInfo.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+        if (!VkUtils::checkVkResult(result, "Failed to create the terrain generator pipeline")) {
+            return VK_NULL_HANDLE;
+        }
+        return pipeline;
+    }
+
+    void imageBarrier(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout oldLayout,
+                      VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess,
+                      VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess) {
+        VkImageMemoryBarrier2 barrier = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .pNext = nullptr,
+            .srcStageMask = srcStage,
+            .srcAccessMask = srcAccess,
+            .dstStageMask = dstStage,
+            .dstAccessMask = dstAccess,
+            .oldLayout = oldLayout,
+            .newLayout = VK_IMAGE_LAYOUT_GENERAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = image,
+            .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+        };
+        VkDependencyInfo dependency = {
+            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .pNext = nullptr,
+            .dependencyFlags = 0,
+            .memoryBarrierCount = 0,
+            .pMemoryBarriers = nullptr,
+            .bufferMemoryBarrierCount = 0,
+            .pBufferMemoryBarriers = nullptr,
+            .imageMemoryBarrierCount = 1,
+            .pImageMemoryBarriers = &barrier,
+        };
+        vkCmdPipelineBarrier2(commandBuffer, &dependency);
+    }
+
+    // Fills the tile once and reads it back, empty on failure
+    std::vector<U16> generate(Context& context, const Case& testCase) {
+        VkDevice device = context.vkInfo.device;
+        VkPipeline pipeline = createPipeline(context, testCase.fixedOctaves);
+        if (pipeline == VK_NULL_HANDLE) return {};
+
+        PushConstants pushConstants = {
+            .scale = testCase.settings.scale,
+            .seed = testCase.settings.seed,
+            .originX = testCase.originX,
+            .originY = testCase.originY,
+            .worldChunks = F32(TILE_SIZE / RESOLUTION),
+            .octaves = static_cast<U32>(testCase.settings.octaves),
+            .tiles = context.tileAddress,
+        };
+
+        VkCommandBuffer commandBuffer = context.commandBuffer;
+        VkCommandBufferBeginInfo beginInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+            .pInheritanceInfo = nullptr,
+        };
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+        imageBarrier(commandBuffer, context.image, VK_IMAGE_LAYOUT_UNDEFINED,
+                     VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, VK_ACCESS_2_NONE,
+                     VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, context.pipelineLayout, 0, 1,
+                                &context.descriptorSet, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, context.pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                           sizeof(PushConstants), &pushConstants);
+        vkCmdDispatch(commandBuffer, TILE_SIZE / GROUP_SIZE, TILE_SIZE / GROUP_SIZE, 1);
+
+        imageBarrier(commandBuffer, context.image, VK_IMAGE_LAYOUT_GENERAL,
+                     VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                     VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_READ_BIT);
+
+        VkBufferImageCopy region = {
+            .bufferOffset = 0,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+            .imageOffset = {0, 0, 0},
+            .imageExtent = {TILE_SIZE, TILE_SIZE, 1},
+        };
+        vkCmdCopyImageToBuffer(commandBuffer, context.image, VK_IMAGE_LAYOUT_GENERAL, context.readbackBuffer, 1, &region);
+
+        vkEndCommandBuffer(commandBuffer);
+
+        VkSubmitInfo submitInfo = {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .pNext = nullptr,
+            .waitSemaphoreCount = 0,
+            .pWaitSemaphores = nullptr,
+            .pWaitDstStageMask = nullptr,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &commandBuffer,
+            .signalSemaphoreCount = 0,
+            .pSignalSemaphores = nullptr,
+        };
+
+        // The fence makes the copy visible to the mapped, coherent readback memory
+        std::vector<U16> texels;
+        if (VkUtils::checkVkResult(vkQueueSubmit(context.queue, 1, &submitInfo, context.fence), "Failed to submit the generator") &&
+            VkUtils::checkVkResult(vkWaitForFences(device, 1, &context.fence, VK_TRUE, UINT64_MAX), "Failed to wait on the generator")) {
+            texels.resize(Size(TILE_SIZE) * TILE_SIZE);
+            std::memcpy(texels.data(), context.readback, TILE_BYTES);
+        }
+
+        vkResetFences(device, 1, &context.fence);
+        vkResetCommandBuffer(commandBuffer, 0);
+        vkDestroyPipeline(device, pipeline, nullptr);
+        return texels;
+    }
+
+    // Texel i holds the noise at the centre of its cell, like TerrainManager's height queries
+    bool matchesHeightGrid(const std::vector<U16>& texels, const Case& testCase) {
+        TerrainNoise::Grid grid = {
+            .originX = testCase.originX + 0.5f / F32(RESOLUTION),
+            .originY = testCase.originY + 0.5f / F32(RESOLUTION),
+            .step = 1.0f / F32(RESOLUTION),
+            .width = TILE_SIZE,
+            .height = TILE_SIZE,
+        };
+        std::vector<F32> heights(texels.size());
+        TerrainNoise::heightGrid(grid, testCase.settings, heights);
+
+        F32 maxError = 0.0f;
+        Size worst = 0;
+        for (Size i = 0; i < texels.size(); i++) {
+            F32 texel = F32(texels[i]) / 65535.0f * HEIGHT_RANGE;
+            F32 error = std::abs(texel - heights[i]);
+            if (error > maxError) {
+                maxError = error;
+                worst = i;
+            }
+        }
+
+        spdlog::info(
+                "Scale {}, seed {}, {} octaves (fixed {}): largest texel error {:.2e}",
+                testCase.settings.scale, testCase.settings.seed, testCase.settings.octaves, testCase.fixedOctaves, maxError
+        );
+        if (maxError > TerrainNoise::GPU_TOLERANCE) {
+            spdlog::error(
+                    "Texel ({}, {}) is {} on the GPU but {} from heightGrid, above the {:.0e} tolerance",
+                    worst % TILE_SIZE, worst / TILE_SIZE, F32(texels[worst]) / 65535.0f * HEIGHT_RANGE, heights[worst],
+                    TerrainNoise::GPU_TOLERANCE
+            );
+            return false;
+        }
+        return true;
+    }
+}
+
+int main() {
+    Context context;
+    if (!createDevice(context)) {
+        spdlog::warn("Skipping the terrain generator parity test");
+        return SKIPPED;
+    }
+
+    if (!createResources(context)) {
+        spdlog::error("Terrain generator parity test setup failed");
+        return 1;
+    }
+
+    bool passed = true;
+    for (const Case& testCase : CASES) {
+        std::vector<U16> texels = generate(context, testCase);
+        if (texels.empty()) {
+            passed = false;
+            continue;
+        }
+        passed &= matchesHeightGrid(texels, testCase);
+    }
+
+    if (!passed) {
+        spdlog::error("Terrain generator parity test failed");
+        return 1;
+    }
+    spdlog::info("Terrain generator matches TerrainNoise");
+    return 0;
+}
@@ -0,0 +1,219 @@
+// tests/TerrainNoiseTest.cpp
+
+#include "AssetManagement/Terrain/TerrainNoise.hpp"
+#include "Game/Input/Duration.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+
+namespace {
+    // Against a double precision libm port, what is left is float rounding in the fbm sum
+    constexpr F32 REFERENCE_TOLERANCE = 1e-5f;
+
+    constexpr U32 BENCHMARK_SIZE = 1024;
+    constexpr I32 BENCHMARK_OCTAVES = 4;
+    // Per thread floor for optimized AVX2 builds, about 60% of a 2 GHz core
+    constexpr F64 BENCHMARK_FLOOR = 20e6;
+
+    // Same constants and lattice as noiseFunctions.glsl, everything past the hash in double
+    U32 pcgHash(U32 v) {
+        U32 state = v * 747796405u + 2891336453u;
+        U32 word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+        return (word >> 22u) ^ word;
+    }
+
+    F64 referencePerlin(F32 x, F32 y, F32 seed) {
+        F32 cellX = std::floor(x);
+        F32 cellY = std::floor(y);
+        F64 fx = F64(x) - cellX;
+        F64 fy = F64(y) - cellY;
+        U32 seedHash = pcgHash(std::bit_cast<U32>(seed));
+
+        auto corner = [&](I32 offsetX, I32 offsetY) {
+            U32 cx = static_cast<U32>(static_cast<I32>(cellX) + offsetX);
+            U32 cy = static_cast<U32>(static_cast<I32>(cellY) + offsetY);
+            U32 hash = pcgHash(cx ^ pcgHash(cy ^ seedHash));
+            F64 angle = F64(hash >> 28u) / 16.0 * 2.0 * std::numbers::pi;
+            return std::cos(angle) * (fx - offsetX) + std::sin(angle) * (fy - offsetY);
+        };
+
+        auto fade = [](F64 t) { return t * t * t * (t * (t * 6.0 - 15.0) + 10.0); };
+        auto mix = [](F64 a, F64 b, F64 t) { return a + (b - a) * t; };
+
+        F64 i1 = mix(corner(0, 0), corner(1, 0), fade(fx));
+        F64 i2 = mix(corner(0, 1), corner(1, 1), fade(fx));
+        return 0.5 * mix(i1, i2, fade(fy)) + 0.5;
+    }
+
+    // Positions are scaled in float like the shader, so both sides floor the same lattice cell
+    F64 referenceHeight(F32 cellX, F32 cellY, const TerrainNoise::Settings& settings) {
+        F32 x = cellX * settings.scale;
+        F32 y = cellY * settings.scale;
+
+        F64 total = 0.0;
+        F64 amplitude = 1.0;
+        F32 frequency = 1.0f;
+        for (I32 octave = 0; octave < settings.octaves; octave++) {
+            total += amplitude * referencePerlin(x * frequency, y * frequency, settings.seed + F32(octave) * 237.0f);
+            amplitude *= 0.5;
+            frequency *= 2.0f;
+        }
+        return total;
+    }
+
+    const std::array<TerrainNoise::Settings, 5> SETTINGS = {{
+        {.scale = 1.0f, .seed = 0.0f, .octaves = 4},
+        {.scale = 0.37f, .seed = 123.4f, .octaves = 1},
+        {.scale = 20.0f, .seed = 999.9f, .octaves = 10},
+        {.scale = 3.0f, .seed = 42.0f, .octaves = 7},
+        {.scale = 1.0f, .seed = 5.0f, .octaves = 0},
+    }};
+
+    struct Points {
+        std::vector<F32> x;
+        std::vector<F32> y;
+    };
+
+    // Both signs and far from the origin, where floor and the integer lattice are easiest to get wrong
+    Points randomPoints(Size count, U32 seed) {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<F32> coordinate(-5000.0f, 5000.0f);
+
+        Points points;
+        for (Size i = 0; i < count; i++) {
+            points.x.push_back(coordinate(random));
+            points.y.push_back(coordinate(random));
+        }
+        return points;
+    }
+
+    // The vector path must give exactly the scalar results, tails included
+    bool batchMatchesScalar() {
+        Points points = randomPoints(10007, 1);
+
+        for (const TerrainNoise::Settings& settings : SETTINGS) {
+            for (Size count : {Size(1), Size(7), Size(8), Size(9), Size(37), points.x.size()}) {
+                std::vector<F32> batch(count);
+                TerrainNoise::heightBatch(points.x.data(), points.y.data(), batch.data(), count, settings);
+
+                for (Size i = 0; i < count; i++) {
+                    F32 scalar = TerrainNoise::height(points.x[i], points.y[i], settings);
+                    if (std::bit_cast<U32>(scalar) != std::bit_cast<U32>(batch[i])) {
+                        spdlog::error(
+                                "heightBatch differs from height at ({}, {}), octaves {}: {} vs {}",
+                                points.x[i], points.y[i], settings.octaves, batch[i], scalar
+                        );
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // Row bands across threads must not change a single sample
+    bool gridMatchesBatch() {
+        TerrainNoise::Grid grid = {.originX = -37.25f, .originY = 12.5f, .step = 1.0f / 128.0f, .width = 301, .height = 70};
+
+        for (const TerrainNoise::Settings& settings : SETTINGS) {
+            std::vector<F32> heights(static_cast<Size>(grid.width) * grid.height);
+            TerrainNoise::heightGrid(grid, settings, heights);
+
+            std::vector<F32> xs(grid.width), ys(grid.width), row(grid.width);
+            for (U32 y = 0; y < grid.height; y++) {
+                for (U32 x = 0; x < grid.width; x++) {
+                    xs[x] = grid.originX + F32(x) * grid.step;
+                    ys[x] = grid.originY + F32(y) * grid.step;
+                }
+                TerrainNoise::heightBatch(xs.data(), ys.data(), row.data(), grid.width, settings);
+
+                if (!std::equal(row.begin(), row.end(), heights.begin() + static_cast<Size>(y) * grid.width)) {
+                    spdlog::error("heightGrid row {} differs from heightBatch, octaves {}", y, settings.octaves);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool matchesReference() {
+        Points points = randomPoints(20000, 2);
+
+        F64 maxError = 0.0;
+        for (const TerrainNoise::Settings& settings : SETTINGS) {
+            std::vector<F32> heights(points.x.size());
+            TerrainNoise::heightBatch(points.x.data(), points.y.data(), heights.data(), heights.size(), settings);
+
+            for (Size i = 0; i < heights.size(); i++) {
+                maxError = std::max(maxError, std::abs(heights[i] - referenceHeight(points.x[i], points.y[i], settings)));
+            }
+        }
+
+        spdlog::info("Largest error against the double precision reference: {:.2e}", maxError);
+        if (maxError > REFERENCE_TOLERANCE) {
+            spdlog::error("Reference error {:.2e} is above the {:.0e} tolerance", maxError, REFERENCE_TOLERANCE);
+            return false;
+        }
+        return true;
+    }
+
+    // Debug and scalar builds only report, see the throughput note in TerrainNoise.hpp
+    bool benchmark() {
+        TerrainNoise::Settings settings = {.scale = 1.0f, .seed = 0.0f, .octaves = BENCHMARK_OCTAVES};
+        TerrainNoise::Grid grid = {.originX = 0.0f, .originY = 0.0f, .step = 1.0f / 128.0f, .width = BENCHMARK_SIZE, .height = BENCHMARK_SIZE};
+        F64 samples = F64(grid.width) * grid.height;
+
+        std::vector<F32> xs(grid.width), ys(grid.width);
+        std::vector<F32> heights(static_cast<Size>(grid.width) * grid.height);
+        for (U32 x = 0; x < grid.width; x++) {
+            xs[x] = grid.originX + F32(x) * grid.step;
+        }
+
+        Duration::TimePoint start = Duration::now();
+        for (U32 y = 0; y < grid.height; y++) {
+            std::fill(ys.begin(), ys.end(), grid.originY + F32(y) * grid.step);
+            TerrainNoise::heightBatch(xs.data(), ys.data(), heights.data() + static_cast<Size>(y) * grid.width, grid.width, settings);
+        }
+        F64 singleSeconds = Duration::since(start).asSeconds();
+
+        start = Duration::now();
+        TerrainNoise::heightGrid(grid, settings, heights);
+        F64 gridSeconds = Duration::since(start).asSeconds();
+
+        spdlog::info(
+                "{}x{} grid at {} octaves ({}): {:.1f}M samples/s on one thread, {:.1f}M samples/s through heightGrid",
+                grid.width, grid.height, settings.octaves, TerrainNoise::usesAvx2() ? "AVX2" : "scalar",
+                samples / singleSeconds / 1e6, samples / gridSeconds / 1e6
+        );
+
+#ifdef NDEBUG
+        if (TerrainNoise::usesAvx2() && samples / singleSeconds < BENCHMARK_FLOOR) {
+            spdlog::error("Single thread throughput is below the {:.0f}M samples/s floor", BENCHMARK_FLOOR / 1e6);
+            return false;
+        }
+#endif
+        return true;
+    }
+}
+
+int main() {
+    bool passed = true;
+    passed &= batchMatchesScalar();
+    passed &= gridMatchesBatch();
+    passed &= matchesReference();
+    passed &= benchmark();
+
+    if (!passed) {
+        spdlog::error("Terrain noise tests failed");
+        return 1;
+    }
+    spdlog::info("Terrain noise tests passed");
+    return 0;
+}